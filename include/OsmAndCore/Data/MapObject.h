@@ -133,6 +133,11 @@ namespace OsmAnd
         QVector< PointI > points31;
         QList< QVector< PointI > > innerPolygonsPoints31;
         AreaI bbox31;
+        // Doubled area and average of points31, valid only if geometry summary was computed. It's computed for
+        // objects decoded from map sections, so their bbox31 is set too
+        int64_t doubledArea31;
+        PointI center31;
+        bool isGeometrySummaryComputed;
 
         mutable volatile int vapIndex;
         mutable VisibleAreaPoints* vapItems[2];
@@ -141,6 +146,7 @@ namespace OsmAnd
 
         virtual bool isClosedFigure(bool checkInner = false) const;
         virtual void computeBBox31();
+        virtual void computeGeometrySummary31();
         virtual bool intersectedOrContainedBy(const AreaI& area,
             const AreaI& nextArea, int64_t nextAreaTime, QVector<PointI>* path31 = nullptr) const;
         virtual bool intersectedOrContainedBy(const QVector<PointI>& points, const AreaI& area,
@@ -7,6 +7,7 @@
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
 #include <QSet>
+#include <QMutex>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -19,6 +20,7 @@ namespace OsmAnd
     class ObfRoutingSectionInfo;
     class ObfRoutingSectionLevelTreeNode;
     class Road;
+    class RoutingGraphSnapshot;
     class IQueryController;
     namespace ObfRoutingSectionReader_Metrics
     {
@@ -36,6 +38,8 @@ namespace OsmAnd
         {
             Q_DISABLE_COPY_AND_MOVE(DataBlock);
         private:
+            mutable QMutex _graphMutex;
+            mutable std::shared_ptr<const RoutingGraphSnapshot> _graph;
         protected:
             DataBlock(
                 const DataBlockId id,
@@ -50,6 +54,9 @@ namespace OsmAnd
             const AreaI area31;
             const QList< std::shared_ptr<const OsmAnd::Road> > roads;
 
+            // Flat graph of roads in this block, built on first request
+            std::shared_ptr<const RoutingGraphSnapshot> getGraph() const;
+
         friend class OsmAnd::ObfRoutingSectionReader;
         friend class OsmAnd::ObfRoutingSectionReader_P;
         };
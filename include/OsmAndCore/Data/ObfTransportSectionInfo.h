@@ -8,6 +8,7 @@
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PrivateImplementation.h>
 #include <OsmAndCore/Data/ObfSectionInfo.h>
 #include <OsmAndCore/CachedOsmandIndexes.h>
 
@@ -16,6 +17,7 @@ namespace OsmAnd {
     class ObfTransportSectionReader_P;
     class ObfReader_P;
 
+    class ObfTransportSectionInfo_P;
     class OSMAND_CORE_API ObfTransportSectionInfo : public ObfSectionInfo
     {
         Q_DISABLE_COPY_AND_MOVE(ObfTransportSectionInfo)
@@ -27,6 +29,7 @@ namespace OsmAnd {
         };
         
     private:
+        PrivateImplementation<ObfTransportSectionInfo_P> _p;
     protected:
         ObfTransportSectionInfo(const std::shared_ptr<const ObfInfo>& container);
 
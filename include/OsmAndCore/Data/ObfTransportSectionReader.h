@@ -50,7 +50,16 @@ namespace OsmAnd {
             const uint32_t routeOffset,
             ObfSectionInfo::StringTable* const stringTable,
             bool onlyDescription);
-        
+
+        // Returns route with names resolved. Route is decoded once and then kept by section.
+        static std::shared_ptr<const TransportRoute> obtainTransportRoute(
+            const std::shared_ptr<const ObfReader>& reader,
+            const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            const uint32_t routeOffset);
+
+        // Stops are served from in-memory index of section. First search in section builds that index:
+        // it reads all stops of section and whole string table regardless of bbox31, later searches don't read file.
+        // Names of stops are always resolved, stringTable (if any) receives strings of names of found stops.
         static void searchTransportStops(
             const std::shared_ptr<const ObfReader>& reader,
             const std::shared_ptr<const ObfTransportSectionInfo>& section,
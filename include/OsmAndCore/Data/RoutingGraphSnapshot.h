@@ -0,0 +1,110 @@
+#ifndef _OSMAND_CORE_ROUTING_GRAPH_SNAPSHOT_H_
+#define _OSMAND_CORE_ROUTING_GRAPH_SNAPSHOT_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+class QIODevice;
+
+namespace OsmAnd
+{
+    class Road;
+
+    // Flat representation of roads from single routing data block, suitable for graph search:
+    // road points are graph nodes, road segments are edges stored in CSR (compressed sparse row) form.
+    class OSMAND_CORE_API RoutingGraphSnapshot Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(RoutingGraphSnapshot);
+    public:
+        enum RoadFlag : uint8_t
+        {
+            OneWayForward = 1u << 0,
+            OneWayReverse = 1u << 1,
+            Roundabout = 1u << 2,
+            HasPointTypes = 1u << 3,
+        };
+
+        // Decoded road, as far as graph is concerned
+        struct OSMAND_CORE_API RoadInfo Q_DECL_FINAL
+        {
+            RoadInfo();
+            ~RoadInfo();
+
+            quint64 id;
+            QVector<PointI> points31;
+            QVector<uint32_t> attributeIds;
+            uint8_t flags;
+            float maxSpeed;
+        };
+
+    private:
+    protected:
+    public:
+        RoutingGraphSnapshot();
+        ~RoutingGraphSnapshot();
+
+        // Nodes: x31 and y31 of i-th node are stored at [2*i] and [2*i+1]
+        QVector<int32_t> nodesCoordinates31;
+
+        // Outgoing edges of i-th node are [edgesOffsets[i], edgesOffsets[i+1])
+        QVector<uint32_t> edgesOffsets;
+        QVector<uint32_t> edgesTargets;
+        QVector<float> edgesLengths;
+        QVector<uint32_t> edgesRoads;
+
+        // Roads: types of i-th road are [roadsTypesOffsets[i], roadsTypesOffsets[i+1]) in roadsTypes,
+        // each being an index in types
+        QVector<quint64> roadsIds;
+        QVector<uint8_t> roadsFlags;
+        QVector<float> roadsMaxSpeeds;
+        QVector<uint32_t> roadsTypesOffsets;
+        QVector<uint16_t> roadsTypes;
+
+        // Interned attribute identifiers of routing section
+        QVector<uint32_t> types;
+
+        inline unsigned int getNodesCount() const
+        {
+            return static_cast<unsigned int>(nodesCoordinates31.size() / 2);
+        }
+
+        inline unsigned int getEdgesCount() const
+        {
+            return static_cast<unsigned int>(edgesTargets.size());
+        }
+
+        inline unsigned int getRoadsCount() const
+        {
+            return static_cast<unsigned int>(roadsIds.size());
+        }
+
+        inline PointI getNode(const unsigned int nodeIndex) const
+        {
+            return PointI(nodesCoordinates31[2 * nodeIndex], nodesCoordinates31[2 * nodeIndex + 1]);
+        }
+
+        int findNode(const PointI& point31) const;
+        bool roadHasType(const unsigned int roadIndex, const uint32_t attributeId) const;
+
+        bool saveTo(QIODevice& output) const;
+        bool saveTo(const QString& fileName) const;
+
+        static std::shared_ptr<const RoutingGraphSnapshot> build(
+            const QList< std::shared_ptr<const Road> >& roads);
+        static std::shared_ptr<const RoutingGraphSnapshot> build(
+            const QList<RoadInfo>& roads);
+        static std::shared_ptr<const RoutingGraphSnapshot> loadFrom(QIODevice& input);
+        static std::shared_ptr<const RoutingGraphSnapshot> loadFrom(const QString& fileName);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ROUTING_GRAPH_SNAPSHOT_H_)
@@ -0,0 +1,79 @@
+#ifndef _OSMAND_CORE_ISOCHRONE_BUILDER_H_
+#define _OSMAND_CORE_ISOCHRONE_BUILDER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QList>
+#include <QVector>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PrivateImplementation.h>
+#include <OsmAndCore/Callable.h>
+#include <OsmAndCore/Color.h>
+#include <OsmAndCore/Data/ObfRoutingSectionReader.h>
+
+namespace OsmAnd
+{
+    class IObfsCollection;
+    class IQueryController;
+    class Road;
+    class Polygon;
+    class PolygonsCollection;
+
+    class IsochroneBuilder_P;
+    class OSMAND_CORE_API IsochroneBuilder
+    {
+        Q_DISABLE_COPY_AND_MOVE(IsochroneBuilder);
+    public:
+        // Returns speed in km/h along given road, non-positive value means road is not passable.
+        // For nullptr road maximal possible speed has to be returned.
+        OSMAND_CALLABLE(SpeedFunction, float, const std::shared_ptr<const Road>& road);
+
+        struct OSMAND_CORE_API Isochrone Q_DECL_FINAL
+        {
+            Isochrone();
+            ~Isochrone();
+
+            float timeLimit;
+            unsigned int reachedPointsCount;
+            QVector<PointI> polygon31;
+        };
+
+    private:
+        PrivateImplementation<IsochroneBuilder_P> _p;
+    protected:
+    public:
+        IsochroneBuilder(
+            const std::shared_ptr<const IObfsCollection>& obfsCollection,
+            const std::shared_ptr<ObfRoutingSectionReader::DataBlocksCache>& cache = nullptr);
+        virtual ~IsochroneBuilder();
+
+        const std::shared_ptr<const IObfsCollection> obfsCollection;
+        const std::shared_ptr<ObfRoutingSectionReader::DataBlocksCache> cache;
+
+        // Time limits are in seconds. Result contains one isochrone per time limit, in same order.
+        QList<Isochrone> buildIsochrones(
+            const PointI origin31,
+            const QList<float>& timeLimits,
+            const SpeedFunction speedFunction = nullptr,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr) const;
+
+        // Each isochrone becomes a polygon with id (basePolygonId + index) and fill color from fillColors[index].
+        // Smaller time limits are placed above larger ones.
+        QList< std::shared_ptr<Polygon> > buildPolygons(
+            const PointI origin31,
+            const QList<float>& timeLimits,
+            const QList<FColorARGB>& fillColors,
+            const std::shared_ptr<PolygonsCollection>& collection,
+            const int basePolygonId,
+            const int baseOrder,
+            const SpeedFunction speedFunction = nullptr,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr) const;
+
+        static float getDefaultSpeed(const std::shared_ptr<const Road>& road);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ISOCHRONE_BUILDER_H_)
@@ -22,11 +22,16 @@
 #include <OsmAndCore/Map/IMapStyle.h>
 #include <OsmAndCore/Icons.h>
 
+class SkPathEffect;
+class SkShader;
+
 namespace OsmAnd
 {
     class MapStyleEvaluator;
     class MapStyleValueDefinition;
     class MapStyleBuiltinValueDefinitions;
+    class MapStyleEvaluationResultsCache;
+    class MapStyleEvaluatorsContext;
     struct MapStyleConstantValue;
     class ObfMapSectionInfo;
 
@@ -88,6 +93,8 @@ namespace OsmAnd
         const float symbolsScaleFactor;
         const std::shared_ptr<const ICoreResourcesProvider> externalResourcesProvider;
         const QSet<QString> disabledAttributes;
+        // Unique among all environments created by process, unlike address of environment that may be reused
+        const unsigned int uniqueId;
 
         QString getLocaleLanguageId() const;
         void setLocaleLanguageId(const QString& localeLanguageId);
@@ -100,6 +107,14 @@ namespace OsmAnd
         void setSettings(const QHash< QString, QString >& newSettings);
 
         void applyTo(MapStyleEvaluator& evaluator) const;
+#if !defined(SWIG)
+        // Shared by evaluators that have settings of this environment applied, replaced on settings change
+        std::shared_ptr<MapStyleEvaluationResultsCache> getEvaluationResultsCache() const;
+        // Evaluators with settings of this environment and given zoom applied, exclusively owned until released
+        std::shared_ptr<MapStyleEvaluatorsContext> obtainEvaluatorsContext(
+            const ZoomLevel zoom,
+            const ZoomLevel detailedZoom) const;
+#endif // !defined(SWIG)
 
         std::shared_ptr<const LayeredIconData> getLayeredIconData(
             const QString& tag,
@@ -119,6 +134,11 @@ namespace OsmAnd
         bool obtainIcon(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
         bool obtainMapIcon(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
         bool obtainShaderOrShield(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
+#if !defined(SWIG)
+        // Path effects and shaders referenced by style are built once, so these don't lock for them
+        bool obtainPathEffect(const QString& encodedPathEffect, sk_sp<SkPathEffect>& outPathEffect) const;
+        bool obtainImageShader(const QString& name, sk_sp<SkShader>& outShader) const;
+#endif // !defined(SWIG)
 
         ColorARGB getDefaultBackgroundColor(const ZoomLevel zoom) const;
         void obtainShadowOptions(const ZoomLevel zoom, ShadowMode& mode, ColorARGB& color) const;
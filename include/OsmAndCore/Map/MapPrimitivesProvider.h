@@ -78,6 +78,12 @@ namespace OsmAnd
             const Request& request,
             std::shared_ptr<Data>& outTiledPrimitives,
             MapPrimitivesProvider_Metrics::Metric_obtainData* metric = nullptr);
+        // Primitivises objects of metatileSize x metatileSize tiles that start at request.tileId as single area with surface
+        virtual bool obtainMetatilePrimitives(
+            const Request& request,
+            const unsigned int metatileSize,
+            std::shared_ptr<Data>& outMetatilePrimitives,
+            MapPrimitivesProvider_Metrics::Metric_obtainData* metric = nullptr);
 
         virtual bool supportsNaturalObtainData() const Q_DECL_OVERRIDE;
         virtual bool obtainData(
@@ -24,6 +24,21 @@ namespace OsmAnd
         /* Time spent on waiting for future shared primitives groups (for all) */                   \
         FIELD_ACTION(float, elapsedTimeForFutureSharedPrimitivesGroups, "s");                       \
                                                                                                     \
+        /* Time spent blocked on shared groups that were still produced by other threads */         \
+        FIELD_ACTION(float, elapsedTimeBlockedOnSharedGroups, "s");                                 \
+                                                                                                    \
+        /* Number of shared primitives groups not yet available once tile objects were done */      \
+        FIELD_ACTION(unsigned int, lateSharedPrimitivesGroups, "");                                 \
+                                                                                                    \
+        /* Number of shared symbols groups not yet available once tile groups were done */          \
+        FIELD_ACTION(unsigned int, lateSharedSymbolsGroups, "");                                    \
+                                                                                                    \
+        /* Time spent on primitivising chunks of map objects concurrently (wall time) */            \
+        FIELD_ACTION(float, elapsedTimeForConcurrentPrimitivisation, "s");                          \
+                                                                                                    \
+        /* Number of chunks of map objects primitivised concurrently */                             \
+        FIELD_ACTION(unsigned int, concurrentlyPrimitivisedChunks, "");                             \
+                                                                                                    \
         /* Time spent on Order rules evaluation */                                                  \
         FIELD_ACTION(float, elapsedTimeForOrderEvaluation, "s");                                    \
                                                                                                     \
@@ -36,6 +51,15 @@ namespace OsmAnd
         /* Time spent on Order processing */                                                        \
         FIELD_ACTION(float, elapsedTimeForOrderProcessing, "s");                                    \
                                                                                                     \
+        /* Number of style evaluations served from evaluation results cache */                      \
+        FIELD_ACTION(unsigned int, evaluationCacheHits, "");                                        \
+                                                                                                    \
+        /* Number of style evaluations performed and stored in evaluation results cache */          \
+        FIELD_ACTION(unsigned int, evaluationCacheMisses, "");                                      \
+                                                                                                    \
+        /* Number of style evaluations that bypassed evaluation results cache */                    \
+        FIELD_ACTION(unsigned int, evaluationCacheBypasses, "");                                    \
+                                                                                                    \
         /* Time spent on Polygon rules evaluation */                                                \
         FIELD_ACTION(float, elapsedTimeForPolygonEvaluation, "s");                                  \
                                                                                                     \
@@ -25,8 +25,12 @@ namespace OsmAnd
             const std::shared_ptr<MapPrimitivesProvider>& primitivesProvider,
             const bool fillBackground = true,
             const bool forceObtainDataAsync = false,
-            const bool adjustToDetailedZoom = false);
+            const bool adjustToDetailedZoom = false,
+            const unsigned int metatileSize = 1);
         virtual ~MapRasterLayerProvider_Software();
+
+        // Number of tiles along side of metatile that is primitivised and rasterized at once
+        const unsigned int metatileSize;
     };
 }
 
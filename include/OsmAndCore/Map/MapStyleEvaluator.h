@@ -37,6 +37,10 @@ namespace OsmAnd
         void setStringValue(const IMapStyle::ValueDefinitionId valueDefId, const QString& value);
         void setStringIdValue(const IMapStyle::ValueDefinitionId valueDefId, const IMapStyle::StringId value);
 
+        // Compiled program of resolved style is used when available, otherwise rule trees are walked directly
+        bool isProgramEnabled() const;
+        void setProgramEnabled(const bool enabled);
+
         bool evaluate(
             const std::shared_ptr<const MapObject>& mapObject,
             const MapStyleRulesetType rulesetType,
@@ -21,6 +21,7 @@
 namespace OsmAnd
 {
     class ResolvedMapStyle_P;
+    class MapStyleProgram;
     class OSMAND_CORE_API ResolvedMapStyle : public IMapStyle
     {
         Q_DISABLE_COPY_AND_MOVE(ResolvedMapStyle);
@@ -284,6 +285,11 @@ namespace OsmAnd
 
         virtual QString getStringById(const SWIG_CLARIFY(IMapStyle, StringId) id) const Q_DECL_OVERRIDE;
 
+#if !defined(SWIG)
+        // Rule trees compiled for evaluation
+        std::shared_ptr<const MapStyleProgram> getProgram() const;
+#endif // !defined(SWIG)
+
         static std::shared_ptr<const ResolvedMapStyle> resolveMapStylesChain(
             const QList< std::shared_ptr<const UnresolvedMapStyle> >& unresolvedMapStylesChain);
     };
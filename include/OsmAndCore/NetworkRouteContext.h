@@ -237,6 +237,7 @@ namespace OsmAnd
         int64_t getTileId(int32_t x31, int32_t y31, int shiftR) const;
         void loadRouteSegmentIntersectingTile(int32_t x, int32_t y, const NetworkRouteKey * routeKey,
                                   QHash<NetworkRouteKey, QList<std::shared_ptr<NetworkRouteSegment>>> & map);
+        void loadTiles(const QList<int64_t>& tileIds);
         int32_t getXFromTileId(int64_t tileId) const;
         int32_t getYFromTileId(int64_t tileId) const;
         PointI getPointFromLong(int64_t l) const;
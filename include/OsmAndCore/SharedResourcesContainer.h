@@ -2,10 +2,12 @@
 #define _OSMAND_CORE_SHARED_RESOURCES_CONTAINER_H_
 
 #include <OsmAndCore/stdlib_common.h>
+#include <functional>
 #include <proper/future.h>
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QHash>
+#include <QList>
 #include <QReadWriteLock>
 #include <QThread>
 
@@ -28,6 +30,7 @@ namespace OsmAnd
 
     public:
         typedef std::shared_ptr<RESOURCE_TYPE> ResourcePtr;
+        typedef std::function<void ()> PromiseSettledCallback;
     protected:
         mutable QMutex _containerMutex;
 
@@ -77,6 +80,14 @@ namespace OsmAnd
             uintmax_t refCounter;
             proper::promise<ResourcePtr> promise;
             const proper::shared_future<ResourcePtr> sharedFuture;
+            QList<PromiseSettledCallback> settledCallbacks;
+
+            void notifySettled()
+            {
+                for (const auto& callback : settledCallbacks)
+                    callback();
+                settledCallbacks.clear();
+            }
 
         private:
             Q_DISABLE_COPY_AND_MOVE(PromisedResourceEntry);
@@ -294,6 +305,7 @@ namespace OsmAnd
             _promisedResources.erase(itPromisedResourceEntry);
 
             promisedResourceEntry->promise.set_exception(proper::make_exception_ptr(std::runtime_error("Promise was broken")));
+            promisedResourceEntry->notifySettled();
         }
 
         void fulfilPromise(const KEY_TYPE& key, ResourcePtr& resourcePtr)
@@ -335,6 +347,7 @@ namespace OsmAnd
 #endif
             _availableResources.insert(key, qMove(std::shared_ptr<AvailableResourceEntry>(newEntry)));
             promisedResourceEntry->promise.set_value(newEntry->resourcePtr);
+            promisedResourceEntry->notifySettled();
         }
 
 #ifdef Q_COMPILER_RVALUE_REFS
@@ -367,6 +380,7 @@ namespace OsmAnd
             assert(resourcePtr.use_count() == 0);
             _availableResources.insert(key, qMove(std::shared_ptr<AvailableResourceEntry>(newEntry)));
             promisedResourceEntry->promise.set_value(newEntry->resourcePtr);
+            promisedResourceEntry->notifySettled();
         }
 #endif // Q_COMPILER_RVALUE_REFS
 
@@ -402,6 +416,7 @@ namespace OsmAnd
             const auto newEntry = new AvailableResourceEntry(promisedResourceEntry->refCounter + 1, resourcePtr);
             _availableResources.insert(key, qMove(std::shared_ptr<AvailableResourceEntry>(newEntry)));
             promisedResourceEntry->promise.set_value(newEntry->resourcePtr);
+            promisedResourceEntry->notifySettled();
         }
 
         bool obtainFutureReference(const KEY_TYPE& key, proper::shared_future<ResourcePtr>& outFutureResourcePtr)
@@ -478,6 +493,39 @@ namespace OsmAnd
             return true;
         }
 
+        // Subscribes to promise that given future reference was obtained from, not to whatever is promised for key
+        // now. Callback is invoked by thread that fulfils or breaks the promise, while container is locked, so it
+        // should only hand off. Returns false if that promise is already settled, so no callback will follow
+        bool subscribeToPromise(
+            const KEY_TYPE& key,
+            const proper::shared_future<ResourcePtr>& futureResourcePtr,
+            const PromiseSettledCallback& callback)
+        {
+            QMutexLocker scopedLocker(&_containerMutex);
+
+            // Promises are settled and removed only while container is locked, and key has at most one promise
+            // at a time. So if promise of this future isn't settled yet, it's the one promised for key.
+            // Once it's settled, key may already be promised again by other thread
+            if (futureResourcePtr.wait_for(proper::chrono::seconds(0)) == proper::future_status::ready)
+                return false;
+
+            const auto itPromisedResourceEntry = _promisedResources.constFind(key);
+            if (itPromisedResourceEntry == _promisedResources.cend())
+                return false;
+            const auto& promisedResourceEntry = *itPromisedResourceEntry;
+
+#if OSMAND_LOG_SHARED_RESOURCES_CONTAINER_CHANGE
+            LogPrintf(LogSeverityLevel::Debug, "[thread:%p] SharedResourcesContainer(%p)->subscribeToPromise(%s)",
+                QThread::currentThreadId(),
+                this,
+                qPrintable(QString::fromLatin1("%1").arg(key)));
+#endif
+
+            promisedResourceEntry->settledCallbacks.push_back(callback);
+
+            return true;
+        }
+
         bool obtainReferenceOrFutureReferenceOrMakePromise(const KEY_TYPE& key, ResourcePtr& outResourcePtr, proper::shared_future<ResourcePtr>& outFutureResourcePtr, bool withPromise = true)
         {
             QMutexLocker scopedLocker(&_containerMutex);
@@ -199,6 +199,11 @@ namespace OsmAnd
             float* const outLineSpacing = nullptr,
             float* const outFontAscent = nullptr) const;
 
+#if !defined(SWIG)
+        // Counts of rasterized text parts whose shaping was taken from cache or had to be done
+        void getShapingCacheStatistics(unsigned int& outHits, unsigned int& outMisses) const;
+#endif // !defined(SWIG)
+
         static std::shared_ptr<const TextRasterizer> getDefault();
         static std::shared_ptr<const TextRasterizer> getOnlySystemFonts();
     };
@@ -0,0 +1,98 @@
+#ifndef _OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_H_
+#define _OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QList>
+#include <QHash>
+#include <QString>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PrivateImplementation.h>
+
+namespace OsmAnd
+{
+    class IObfsCollection;
+    class IQueryController;
+    class TransportStop;
+    class TransportRoute;
+
+    // Round-based (RAPTOR) public transport planner. Transport sections carry no timetables,
+    // so ride times are estimated from distances between stops and speed of route type,
+    // and each boarding costs fixed waiting time.
+    class TransportRoutePlanner_P;
+    class OSMAND_CORE_API TransportRoutePlanner
+    {
+        Q_DISABLE_COPY_AND_MOVE(TransportRoutePlanner);
+    public:
+        struct OSMAND_CORE_API Settings Q_DECL_FINAL
+        {
+            Settings();
+            ~Settings();
+
+            // Walking speed in m/s
+            float walkSpeed;
+            // Maximal walking distance in meters from origin to first stop and from last stop to destination
+            float maxAccessDistance;
+            // Maximal walking distance in meters between stops of a transfer
+            float maxTransferDistance;
+            unsigned int maxTransfers;
+            // Seconds spent waiting for a vehicle on each boarding
+            float boardingTime;
+            // Seconds vehicle spends at each intermediate stop
+            float stopDwellTime;
+            // Speeds in km/h by route type, e.g. "bus" or "subway"
+            QHash<QString, float> speeds;
+            float defaultSpeed;
+        };
+
+        struct OSMAND_CORE_API Leg Q_DECL_FINAL
+        {
+            Leg();
+            ~Leg();
+
+            // Walking legs have no route
+            std::shared_ptr<const TransportRoute> route;
+            // Stops are absent at origin and destination
+            std::shared_ptr<const TransportStop> fromStop;
+            std::shared_ptr<const TransportStop> toStop;
+            PointI start31;
+            PointI end31;
+            // Seconds since departure from origin
+            float departureTime;
+            float arrivalTime;
+        };
+
+        struct OSMAND_CORE_API Journey Q_DECL_FINAL
+        {
+            Journey();
+            ~Journey();
+
+            float arrivalTime;
+            unsigned int ridesCount;
+            QList<Leg> legs;
+        };
+
+    private:
+        PrivateImplementation<TransportRoutePlanner_P> _p;
+    protected:
+    public:
+        TransportRoutePlanner(
+            const std::shared_ptr<const IObfsCollection>& obfsCollection,
+            const Settings& settings = Settings());
+        virtual ~TransportRoutePlanner();
+
+        const std::shared_ptr<const IObfsCollection> obfsCollection;
+        const Settings settings;
+
+        // Returns Pareto-optimal journeys: each next one has more rides and arrives earlier.
+        QList<Journey> planJourneys(
+            const PointI origin31,
+            const PointI destination31,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr) const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_H_)
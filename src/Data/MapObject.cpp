@@ -46,6 +46,8 @@ OsmAnd::MapObject::MapObject()
     , labelX(0)
     , labelY(0)
     , isCoastline(false)
+    , doubledArea31(0)
+    , isGeometrySummaryComputed(false)
     , vapIndex(0)
 {
     vapItems[0] = nullptr;
@@ -116,6 +118,28 @@ void OsmAnd::MapObject::computeBBox31()
         bbox31.enlargeToInclude(*pPoint31);
 }
 
+void OsmAnd::MapObject::computeGeometrySummary31()
+{
+    doubledArea31 = points31.size() > 2 ? Utilities::doubledPolygonArea(points31) : 0;
+
+    PointI64 center;
+    auto pPoint31 = points31.constData();
+    const auto pointsCount = points31.size();
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint31++)
+    {
+        center.x += pPoint31->x;
+        center.y += pPoint31->y;
+    }
+    if (pointsCount > 0)
+    {
+        center.x /= pointsCount;
+        center.y /= pointsCount;
+    }
+    center31 = Utilities::normalizeCoordinates(center, ZoomLevel31);
+
+    isGeometrySummaryComputed = true;
+}
+
 bool OsmAnd::MapObject::intersectedOrContainedBy(const AreaI& area,
     const AreaI& nextArea, int64_t nextAreaTime, QVector<PointI>* path31 /* = nullptr */) const
 {
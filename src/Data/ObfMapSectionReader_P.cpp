@@ -746,7 +746,13 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     if (metric)
                         metric->rejectedMapObjects++;
                 }
-                else if (mapObject->points31.size() >= MIN_POINTS_TO_USE_SIMPLIFIED)
+                else
+                {
+                    // Object is shared by all tiles and zooms it's visible at, so summarize geometry once
+                    mapObject->computeGeometrySummary31();
+                }
+
+                if (mapObject && mapObject->points31.size() >= MIN_POINTS_TO_USE_SIMPLIFIED)
                 {
                     // Create empty slots only for objects that can use simplified paths.
                     mapObject->vapItems[0] = new VisibleAreaPoints(0, AreaI(), QVector<PointI>());
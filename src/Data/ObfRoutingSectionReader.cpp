@@ -2,6 +2,7 @@
 #include "ObfRoutingSectionReader_P.h"
 
 #include "ObfReader.h"
+#include "RoutingGraphSnapshot.h"
 
 OsmAnd::ObfRoutingSectionReader::ObfRoutingSectionReader()
 {
@@ -68,6 +69,16 @@ OsmAnd::ObfRoutingSectionReader::DataBlock::~DataBlock()
 {
 }
 
+std::shared_ptr<const OsmAnd::RoutingGraphSnapshot> OsmAnd::ObfRoutingSectionReader::DataBlock::getGraph() const
+{
+    QMutexLocker scopedLocker(&_graphMutex);
+
+    if (!_graph)
+        _graph = RoutingGraphSnapshot::build(roads);
+
+    return _graph;
+}
+
 OsmAnd::ObfRoutingSectionReader::DataBlocksCache::DataBlocksCache()
 {
 }
@@ -0,0 +1,242 @@
+#ifndef _OSMAND_CORE_OBF_TRANSPORT_SECTION_INDEX_H_
+#define _OSMAND_CORE_OBF_TRANSPORT_SECTION_INDEX_H_
+
+#include "stdlib_common.h"
+#include <algorithm>
+#include <vector>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtGlobal>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "Common.h"
+#include "CommonTypes.h"
+
+namespace OsmAnd
+{
+    class TransportRoute;
+
+    // Grid of transport stops positions, in TRANSPORT_STOP_ZOOM tile coordinates
+    struct TransportStopsGrid Q_DECL_FINAL
+    {
+        enum : int32_t {
+            // Each grid cell is a zoom 14 tile
+            CellShift = 24 - 14,
+        };
+
+        QVector<PointI> positions;
+
+        // Stops of cell cellsKeys[i] are stopsIndices[cellsOffsets[i], cellsOffsets[i+1])
+        QVector<uint64_t> cellsKeys;
+        QVector<uint32_t> cellsOffsets;
+        QVector<uint32_t> stopsIndices;
+
+        inline static uint64_t getCellKey(const int32_t x, const int32_t y)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(x >> CellShift)) << 32)
+                | static_cast<uint32_t>(y >> CellShift);
+        }
+
+        inline void build(const QVector<PointI>& positions_)
+        {
+            positions = positions_;
+            cellsKeys.clear();
+            cellsOffsets.clear();
+            stopsIndices.clear();
+
+            std::vector< std::pair<uint64_t, uint32_t> > cells;
+            cells.reserve(positions.size());
+            for (auto stopIndex = 0u, count = static_cast<uint32_t>(positions.size()); stopIndex < count; stopIndex++)
+                cells.push_back({ getCellKey(positions[stopIndex].x, positions[stopIndex].y), stopIndex });
+
+            // Stable sort keeps stops of each cell in the order they were given
+            std::stable_sort(cells.begin(), cells.end(),
+                []
+                (const std::pair<uint64_t, uint32_t>& l, const std::pair<uint64_t, uint32_t>& r) -> bool
+                {
+                    return l.first < r.first;
+                });
+            stopsIndices.reserve(static_cast<int>(cells.size()));
+            for (const auto& cell : cells)
+            {
+                if (cellsKeys.isEmpty() || cellsKeys.last() != cell.first)
+                {
+                    cellsKeys.push_back(cell.first);
+                    cellsOffsets.push_back(stopsIndices.size());
+                }
+                stopsIndices.push_back(cell.second);
+            }
+            cellsOffsets.push_back(stopsIndices.size());
+        }
+
+        // Appends indices of stops within bbox (all stops if there's none), in the order they were given
+        inline void query(const AreaI* const bbox, QVector<uint32_t>& outStopsIndices) const
+        {
+            if (!bbox)
+            {
+                outStopsIndices.reserve(outStopsIndices.size() + positions.size());
+                for (auto stopIndex = 0u, count = static_cast<uint32_t>(positions.size()); stopIndex < count; stopIndex++)
+                    outStopsIndices.push_back(stopIndex);
+                return;
+            }
+
+            const auto contains =
+                [bbox]
+                (const PointI& position) -> bool
+                {
+                    return bbox->left() <= position.x && position.x <= bbox->right() &&
+                        bbox->top() <= position.y && position.y <= bbox->bottom();
+                };
+
+            const auto left = qMax(bbox->left(), 0) >> CellShift;
+            const auto right = qMax(bbox->right(), 0) >> CellShift;
+            const auto top = qMax(bbox->top(), 0) >> CellShift;
+            const auto bottom = qMax(bbox->bottom(), 0) >> CellShift;
+            const auto cellsCount = static_cast<int64_t>(right - left + 1) * (bottom - top + 1);
+
+            // When requested area covers more cells than there are occupied, plain scan is cheaper
+            if (cellsCount > cellsKeys.size())
+            {
+                for (auto stopIndex = 0u, count = static_cast<uint32_t>(positions.size()); stopIndex < count; stopIndex++)
+                {
+                    if (contains(positions[stopIndex]))
+                        outStopsIndices.push_back(stopIndex);
+                }
+                return;
+            }
+
+            const auto initialSize = outStopsIndices.size();
+            for (auto x = left; x <= right; x++)
+            {
+                for (auto y = top; y <= bottom; y++)
+                {
+                    const auto cellKey = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+                    const auto itCell = std::lower_bound(cellsKeys.cbegin(), cellsKeys.cend(), cellKey);
+                    if (itCell == cellsKeys.cend() || *itCell != cellKey)
+                        continue;
+
+                    const auto cellIndex = itCell - cellsKeys.cbegin();
+                    for (auto idx = cellsOffsets[cellIndex], end = cellsOffsets[cellIndex + 1]; idx < end; idx++)
+                    {
+                        const auto stopIndex = stopsIndices[idx];
+                        if (contains(positions[stopIndex]))
+                            outStopsIndices.push_back(stopIndex);
+                    }
+                }
+            }
+
+            std::sort(outStopsIndices.begin() + initialSize, outStopsIndices.end());
+        }
+    };
+
+    // Decoded routes by offset, least recently used ones are evicted first. Caller has to serialize access
+    class TransportRoutesCache Q_DECL_FINAL
+    {
+    private:
+        struct CachedRoute
+        {
+            std::shared_ptr<const TransportRoute> route;
+            uint64_t generation;
+        };
+        struct LruEntry
+        {
+            uint32_t routeOffset;
+            uint64_t generation;
+        };
+
+        QHash<uint32_t, CachedRoute> _routes;
+        // Each access appends entry, so entries of routes accessed later again are stale and skipped
+        QList<LruEntry> _lru;
+        uint64_t _nextGeneration;
+
+        inline void shrink()
+        {
+            while (_routes.size() > maxRoutesCount && !_lru.isEmpty())
+            {
+                const auto lruEntry = _lru.front();
+                _lru.pop_front();
+
+                const auto itRoute = _routes.find(lruEntry.routeOffset);
+                if (itRoute == _routes.end() || itRoute.value().generation != lruEntry.generation)
+                    continue;
+
+                _routes.erase(itRoute);
+            }
+
+            if (_lru.size() > 2 * _routes.size() + maxRoutesCount)
+            {
+                QList<LruEntry> compactedLru;
+                compactedLru.reserve(_routes.size());
+                for (const auto& lruEntry : constOf(_lru))
+                {
+                    const auto citRoute = _routes.constFind(lruEntry.routeOffset);
+                    if (citRoute == _routes.cend() || citRoute.value().generation != lruEntry.generation)
+                        continue;
+
+                    compactedLru.push_back(lruEntry);
+                }
+                _lru.swap(compactedLru);
+            }
+        }
+    public:
+        inline explicit TransportRoutesCache(const int maxRoutesCount_)
+            : _nextGeneration(0)
+            , maxRoutesCount(maxRoutesCount_)
+        {
+        }
+
+        const int maxRoutesCount;
+
+        inline std::shared_ptr<const TransportRoute> get(const uint32_t routeOffset)
+        {
+            const auto itRoute = _routes.find(routeOffset);
+            if (itRoute == _routes.end())
+                return nullptr;
+
+            auto& cachedRoute = itRoute.value();
+            cachedRoute.generation = ++_nextGeneration;
+            _lru.push_back({ routeOffset, cachedRoute.generation });
+            shrink();
+
+            return cachedRoute.route;
+        }
+
+        // If route is already cached, e.g. it was decoded concurrently, the cached one is returned
+        inline std::shared_ptr<const TransportRoute> put(
+            const uint32_t routeOffset,
+            const std::shared_ptr<const TransportRoute>& route)
+        {
+            auto& cachedRoute = _routes[routeOffset];
+            if (!cachedRoute.route)
+                cachedRoute.route = route;
+            cachedRoute.generation = ++_nextGeneration;
+            _lru.push_back({ routeOffset, cachedRoute.generation });
+            const auto result = cachedRoute.route;
+            shrink();
+
+            return result;
+        }
+
+        inline bool contains(const uint32_t routeOffset) const
+        {
+            return _routes.contains(routeOffset);
+        }
+
+        inline int size() const
+        {
+            return _routes.size();
+        }
+
+        inline int lruSize() const
+        {
+            return _lru.size();
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_OBF_TRANSPORT_SECTION_INDEX_H_)
@@ -1,7 +1,9 @@
 #include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionInfo_P.h"
 
 OsmAnd::ObfTransportSectionInfo::ObfTransportSectionInfo(const std::shared_ptr<const ObfInfo>& container)
     : ObfSectionInfo(container)
+    , _p(new ObfTransportSectionInfo_P(this))
     , area31(_area31)
     , stopsOffset(_stopsOffset)
     , stopsLength(_stopsLength)
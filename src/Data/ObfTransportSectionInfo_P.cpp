@@ -0,0 +1,12 @@
+#include "ObfTransportSectionInfo_P.h"
+#include "ObfTransportSectionInfo.h"
+
+OsmAnd::ObfTransportSectionInfo_P::ObfTransportSectionInfo_P(ObfTransportSectionInfo* owner_)
+    : _routes(MaxCachedRoutes)
+    , owner(owner_)
+{
+}
+
+OsmAnd::ObfTransportSectionInfo_P::~ObfTransportSectionInfo_P()
+{
+}
@@ -0,0 +1,69 @@
+#ifndef _OSMAND_CORE_OBF_TRANSPORT_SECTION_INFO_P_H_
+#define _OSMAND_CORE_OBF_TRANSPORT_SECTION_INFO_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QMutex>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+#include "ObfSectionInfo.h"
+#include "ObfTransportSectionIndex.h"
+
+namespace OsmAnd
+{
+    class TransportStop;
+    class TransportRoute;
+    class ObfTransportSectionReader_P;
+
+    class ObfTransportSectionInfo;
+    class ObfTransportSectionInfo_P Q_DECL_FINAL
+    {
+    public:
+        enum : int32_t {
+            // Decoded routes kept by section
+            MaxCachedRoutes = 2048,
+        };
+        enum : uint32_t {
+            NoStringId = std::numeric_limits<uint32_t>::max(),
+        };
+
+        // Everything that is needed to answer stop queries without touching the file
+        struct StopsIndex
+        {
+            // Stops in the order of stops tree, with names resolved
+            QVector< std::shared_ptr<const TransportStop> > stops;
+            // Identifiers of names of stops in string table, NoStringId if stop has no such name
+            QVector<uint32_t> localizedNamesIds;
+            QVector<uint32_t> enNamesIds;
+            TransportStopsGrid grid;
+        };
+
+    private:
+    protected:
+        ObfTransportSectionInfo_P(ObfTransportSectionInfo* owner);
+
+        mutable std::shared_ptr<const ObfSectionInfo::StringTable> _stringTable;
+        mutable QMutex _stringTableMutex;
+
+        mutable std::shared_ptr<const StopsIndex> _stopsIndex;
+        mutable QMutex _stopsIndexMutex;
+
+        mutable TransportRoutesCache _routes;
+        mutable QMutex _routesMutex;
+    public:
+        virtual ~ObfTransportSectionInfo_P();
+
+        ImplementationInterface<ObfTransportSectionInfo> owner;
+
+    friend class OsmAnd::ObfTransportSectionInfo;
+    friend class OsmAnd::ObfTransportSectionReader_P;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_OBF_TRANSPORT_SECTION_INFO_P_H_)
@@ -44,6 +44,14 @@ std::shared_ptr<OsmAnd::TransportRoute> OsmAnd::ObfTransportSectionReader::getTr
     return ObfTransportSectionReader_P::getTransportRoute(*reader->_p, section, routeOffset, stringTable, onlyDescription);
 }
 
+std::shared_ptr<const OsmAnd::TransportRoute> OsmAnd::ObfTransportSectionReader::obtainTransportRoute(
+    const std::shared_ptr<const ObfReader>& reader,
+    const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    const uint32_t routeOffset)
+{
+    return ObfTransportSectionReader_P::obtainTransportRoute(*reader->_p, section, routeOffset);
+}
+
 void OsmAnd::ObfTransportSectionReader::searchTransportStops(
     const std::shared_ptr<const ObfReader>& reader,
     const std::shared_ptr<const ObfTransportSectionInfo>& section,
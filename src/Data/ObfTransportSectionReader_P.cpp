@@ -5,13 +5,17 @@
 #include <google/protobuf/wire_format_lite.h>
 #include "restore_internal_warnings.h"
 
+#include "QtCommon.h"
+
 #include "ObfReader_P.h"
 #include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionInfo_P.h"
 #include "TransportStop.h"
 #include "TransportStopExit.h"
 #include "TransportRoute.h"
 #include "ObfReaderUtilities.h"
 #include "Utilities.h"
+#include "IQueryController.h"
 
 OsmAnd::ObfTransportSectionReader_P::ObfTransportSectionReader_P()
 {
@@ -197,6 +201,121 @@ void OsmAnd::ObfTransportSectionReader_P::initializeNames(
         s->enName = stringTable->value(s->enName[0].unicode());
 }
 
+void OsmAnd::ObfTransportSectionReader_P::readStringTable(
+    const ObfReader_P& reader,
+    const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    ObfSectionInfo::StringTable& outStringTable)
+{
+    const auto cis = reader.getCodedInputStream().get();
+    cis->Seek(section->stringTable->fileOffset);
+    const auto oldLimit = cis->PushLimit(section->stringTable->length);
+    uint32_t current = 0;
+    while (cis->BytesUntilLimit() > 0)
+    {
+        const auto tag = cis->ReadTag();
+        switch (gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+            case 0:
+                break;
+            case OBF::StringTable::kSFieldNumber:
+            {
+                QString value;
+                ObfReaderUtilities::readQString(cis, value);
+                outStringTable.insert(current++, value);
+                break;
+            }
+            default:
+                ObfReaderUtilities::skipUnknownField(cis, tag);
+                break;
+        }
+    }
+    cis->PopLimit(oldLimit);
+}
+
+std::shared_ptr<const OsmAnd::ObfSectionInfo::StringTable> OsmAnd::ObfTransportSectionReader_P::obtainStringTable(
+    const ObfReader_P& reader,
+    const std::shared_ptr<const ObfTransportSectionInfo>& section)
+{
+    QMutexLocker scopedLocker(&section->_p->_stringTableMutex);
+
+    if (!section->_p->_stringTable)
+    {
+        const auto stringTable = std::make_shared<ObfSectionInfo::StringTable>();
+        if (section->stringTable.isSet())
+            readStringTable(reader, section, *stringTable);
+        section->_p->_stringTable = stringTable;
+    }
+
+    return section->_p->_stringTable;
+}
+
+std::shared_ptr<const OsmAnd::ObfTransportSectionInfo_P::StopsIndex> OsmAnd::ObfTransportSectionReader_P::obtainStopsIndex(
+    const ObfReader_P& reader,
+    const std::shared_ptr<const ObfTransportSectionInfo>& section)
+{
+    QMutexLocker scopedLocker(&section->_p->_stopsIndexMutex);
+
+    if (section->_p->_stopsIndex)
+        return section->_p->_stopsIndex;
+
+    // Read all stops of section at once, names are resolved using whole string table
+    QList< std::shared_ptr<TransportStop> > stops;
+    {
+        const auto cis = reader.getCodedInputStream().get();
+        cis->Seek(section->stopsOffset);
+        const auto oldLimit = cis->PushLimit(section->stopsLength);
+        auto pbbox31 = AreaI(0, 0, 0, 0);
+        const auto bbox31 = AreaI::largest();
+        ObfSectionInfo::StringTable referencedStrings;
+
+        searchTransportTreeBounds(
+            reader,
+            section,
+            stops,
+            pbbox31,
+            &bbox31,
+            &referencedStrings,
+            nullptr);
+
+        ObfReaderUtilities::ensureAllDataWasRead(cis);
+        cis->PopLimit(oldLimit);
+    }
+    const auto stringTable = obtainStringTable(reader, section);
+
+    const std::shared_ptr<ObfTransportSectionInfo_P::StopsIndex> stopsIndex(new ObfTransportSectionInfo_P::StopsIndex());
+    stopsIndex->stops.reserve(stops.size());
+    stopsIndex->localizedNamesIds.reserve(stops.size());
+    stopsIndex->enNamesIds.reserve(stops.size());
+    QVector<PointI> positions;
+    positions.reserve(stops.size());
+    for (const auto& stop : constOf(stops))
+    {
+        auto localizedNameId = static_cast<uint32_t>(ObfTransportSectionInfo_P::NoStringId);
+        if (!stop->localizedName.isEmpty())
+        {
+            localizedNameId = stop->localizedName[0].unicode();
+            stop->localizedName = stringTable->value(localizedNameId);
+        }
+        auto enNameId = static_cast<uint32_t>(ObfTransportSectionInfo_P::NoStringId);
+        if (!stop->enName.isEmpty())
+        {
+            enNameId = stop->enName[0].unicode();
+            stop->enName = stringTable->value(enNameId);
+        }
+
+        stopsIndex->stops.push_back(stop);
+        stopsIndex->localizedNamesIds.push_back(localizedNameId);
+        stopsIndex->enNamesIds.push_back(enNameId);
+        positions.push_back(PointI(
+            qRound(Utilities::getTileNumberX(TRANSPORT_STOP_ZOOM, stop->location.longitude)),
+            qRound(Utilities::getTileNumberY(TRANSPORT_STOP_ZOOM, stop->location.latitude))));
+    }
+    stopsIndex->grid.build(positions);
+
+    section->_p->_stopsIndex = stopsIndex;
+    return stopsIndex;
+}
+
 void OsmAnd::ObfTransportSectionReader_P::searchTransportStops(
     const ObfReader_P& reader,
     const std::shared_ptr<const ObfTransportSectionInfo>& section,
@@ -206,32 +325,28 @@ void OsmAnd::ObfTransportSectionReader_P::searchTransportStops(
     const TransportStopVisitorFunction visitor,
     const std::shared_ptr<const IQueryController>& queryController)
 {
-    const auto cis = reader.getCodedInputStream().get();
-    cis->Seek(section->stopsOffset);
-    const auto oldLimit = cis->PushLimit(section->stopsLength);
-    QList< std::shared_ptr<TransportStop> > res;
-    auto pbbox31 = AreaI(0, 0, 0, 0);
-    
-    searchTransportTreeBounds(
-                              reader,
-                              section,
-                              res,
-                              pbbox31,
-                              bbox31,
-                              stringTable,
-                              queryController);
-    
-    ObfReaderUtilities::ensureAllDataWasRead(cis);
-    cis->PopLimit(oldLimit);
-    
-    if (stringTable)
-    {
-        initializeStringTable(reader, section, stringTable);
-        for (auto st : res)
-            initializeNames(stringTable, st);
-    }
-    for (auto transportStop : res)
+    const auto stopsIndex = obtainStopsIndex(reader, section);
+    const auto sectionStringTable = stringTable ? obtainStringTable(reader, section) : nullptr;
+
+    QVector<uint32_t> stopsIndices;
+    stopsIndex->grid.query(bbox31, stopsIndices);
+    for (const auto stopIndex : constOf(stopsIndices))
     {
+        if (queryController && queryController->isAborted())
+            return;
+
+        // Names of stops are resolved already, string table still gets strings they were resolved from
+        if (stringTable)
+        {
+            const uint32_t namesIds[] = { stopsIndex->localizedNamesIds[stopIndex], stopsIndex->enNamesIds[stopIndex] };
+            for (const auto nameId : namesIds)
+            {
+                if (nameId != ObfTransportSectionInfo_P::NoStringId)
+                    stringTable->insert(nameId, sectionStringTable->value(nameId));
+            }
+        }
+
+        const auto& transportStop = stopsIndex->stops[stopIndex];
         if (!visitor || visitor(transportStop))
         {
             if (resultOut)
@@ -240,6 +355,33 @@ void OsmAnd::ObfTransportSectionReader_P::searchTransportStops(
     }
 }
 
+std::shared_ptr<const OsmAnd::TransportRoute> OsmAnd::ObfTransportSectionReader_P::obtainTransportRoute(
+    const ObfReader_P& reader,
+    const std::shared_ptr<const ObfTransportSectionInfo>& section,
+    const uint32_t routeOffset)
+{
+    {
+        QMutexLocker scopedLocker(&section->_p->_routesMutex);
+
+        if (const auto cachedRoute = section->_p->_routes.get(routeOffset))
+            return cachedRoute;
+    }
+
+    // Decode route outside of lock, only referenced strings are taken from decoded string table
+    ObfSectionInfo::StringTable referencedStrings;
+    const auto route = getTransportRoute(reader, section, routeOffset, &referencedStrings, false);
+    const auto stringTable = obtainStringTable(reader, section);
+    for (auto itEntry = mutableIteratorOf(referencedStrings); itEntry.hasNext();)
+    {
+        itEntry.next();
+        itEntry.setValue(stringTable->value(itEntry.key()));
+    }
+    initializeNames(false, &referencedStrings, route);
+
+    QMutexLocker scopedLocker(&section->_p->_routesMutex);
+    return section->_p->_routes.put(routeOffset, route);
+}
+
 void OsmAnd::ObfTransportSectionReader_P::searchTransportTreeBounds(
     const ObfReader_P& reader,
     const std::shared_ptr<const ObfTransportSectionInfo>& section,
@@ -11,6 +11,7 @@
 #include "DataCommonTypes.h"
 #include "ObfTransportSectionReader.h"
 #include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionInfo_P.h"
 
 namespace OsmAnd {
 
@@ -97,6 +98,19 @@ namespace OsmAnd {
         static QString regStr(
             const ObfReader_P& reader,
             ObfSectionInfo::StringTable* const stringTable);
+
+        static void readStringTable(
+            const ObfReader_P& reader,
+            const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            ObfSectionInfo::StringTable& outStringTable);
+
+        static std::shared_ptr<const ObfSectionInfo::StringTable> obtainStringTable(
+            const ObfReader_P& reader,
+            const std::shared_ptr<const ObfTransportSectionInfo>& section);
+
+        static std::shared_ptr<const ObfTransportSectionInfo_P::StopsIndex> obtainStopsIndex(
+            const ObfReader_P& reader,
+            const std::shared_ptr<const ObfTransportSectionInfo>& section);
         
     public:
 
@@ -109,6 +123,11 @@ namespace OsmAnd {
             const TransportStopVisitorFunction visitor = nullptr,
             const std::shared_ptr<const IQueryController>& queryController = nullptr);
 
+        static std::shared_ptr<const TransportRoute> obtainTransportRoute(
+            const ObfReader_P& reader,
+            const std::shared_ptr<const ObfTransportSectionInfo>& section,
+            const uint32_t routeOffset);
+
     friend class OsmAnd::ObfReader_P;
     friend class OsmAnd::ObfTransportSectionReader;
     };
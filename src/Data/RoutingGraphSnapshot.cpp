@@ -0,0 +1,320 @@
+#include "RoutingGraphSnapshot.h"
+
+#include "QtExtensions.h"
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+
+#include "Road.h"
+#include "ObfRoutingSectionInfo.h"
+#include "Utilities.h"
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    static const quint32 RoutingGraphSnapshotMagic = 0x4F524753; // "ORGS"
+    static const quint32 RoutingGraphSnapshotVersion = 1;
+}
+
+OsmAnd::RoutingGraphSnapshot::RoutingGraphSnapshot()
+{
+}
+
+OsmAnd::RoutingGraphSnapshot::~RoutingGraphSnapshot()
+{
+}
+
+OsmAnd::RoutingGraphSnapshot::RoadInfo::RoadInfo()
+    : id(0)
+    , flags(0)
+    , maxSpeed(0.0f)
+{
+}
+
+OsmAnd::RoutingGraphSnapshot::RoadInfo::~RoadInfo()
+{
+}
+
+int OsmAnd::RoutingGraphSnapshot::findNode(const PointI& point31) const
+{
+    // Nodes are sorted by x31, then by y31
+    auto low = 0;
+    auto high = static_cast<int>(getNodesCount()) - 1;
+    while (low <= high)
+    {
+        const auto middle = (low + high) / 2;
+        const auto x31 = nodesCoordinates31[2 * middle];
+        const auto y31 = nodesCoordinates31[2 * middle + 1];
+        if (x31 < point31.x || (x31 == point31.x && y31 < point31.y))
+            low = middle + 1;
+        else if (x31 > point31.x || (x31 == point31.x && y31 > point31.y))
+            high = middle - 1;
+        else
+            return middle;
+    }
+
+    return -1;
+}
+
+bool OsmAnd::RoutingGraphSnapshot::roadHasType(const unsigned int roadIndex, const uint32_t attributeId) const
+{
+    const auto end = roadsTypesOffsets[roadIndex + 1];
+    for (auto typeIndex = roadsTypesOffsets[roadIndex]; typeIndex < end; typeIndex++)
+    {
+        if (types[roadsTypes[typeIndex]] == attributeId)
+            return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<const OsmAnd::RoutingGraphSnapshot> OsmAnd::RoutingGraphSnapshot::build(
+    const QList< std::shared_ptr<const Road> >& roads)
+{
+    QList<RoadInfo> roadsInfos;
+    roadsInfos.reserve(roads.size());
+    for (const auto& road : constOf(roads))
+    {
+        if (road->points31.size() < 2 || road->isDeleted())
+            continue;
+
+        RoadInfo roadInfo;
+        roadInfo.id = road->id.id;
+        roadInfo.points31 = road->points31;
+        roadInfo.attributeIds = road->attributeIds;
+        roadInfo.flags = road->pointsTypes.isEmpty() ? 0 : HasPointTypes;
+        roadInfo.maxSpeed = qMax(road->getMaximumSpeed(true), road->getMaximumSpeed(false));
+
+        const auto& decodeMap = road->section->getAttributeMapping()->routingDecodeMap;
+        for (const auto attributeId : constOf(road->attributeIds))
+        {
+            const auto rule = decodeMap.getRef(attributeId);
+            if (!rule)
+                continue;
+            if (rule->onewayDirection() > 0)
+                roadInfo.flags |= OneWayForward;
+            else if (rule->onewayDirection() < 0)
+                roadInfo.flags |= OneWayReverse;
+            if (rule->roundabout())
+                roadInfo.flags |= Roundabout;
+        }
+
+        roadsInfos.push_back(roadInfo);
+    }
+
+    return build(roadsInfos);
+}
+
+std::shared_ptr<const OsmAnd::RoutingGraphSnapshot> OsmAnd::RoutingGraphSnapshot::build(
+    const QList<RoadInfo>& roads)
+{
+    const std::shared_ptr<RoutingGraphSnapshot> graph(new RoutingGraphSnapshot());
+
+    // Collect unique points in sorted order, they become nodes
+    std::vector<PointI> points31;
+    for (const auto& road : constOf(roads))
+    {
+        if (road.points31.size() < 2)
+            continue;
+        points31.insert(points31.end(), road.points31.cbegin(), road.points31.cend());
+    }
+    const auto pointsComparator =
+        []
+        (const PointI& l, const PointI& r) -> bool
+        {
+            return l.x < r.x || (l.x == r.x && l.y < r.y);
+        };
+    std::sort(points31.begin(), points31.end(), pointsComparator);
+    points31.erase(std::unique(points31.begin(), points31.end()), points31.end());
+
+    graph->nodesCoordinates31.reserve(static_cast<int>(points31.size() * 2));
+    for (const auto& point31 : points31)
+    {
+        graph->nodesCoordinates31.push_back(point31.x);
+        graph->nodesCoordinates31.push_back(point31.y);
+    }
+
+    struct Edge
+    {
+        uint32_t source;
+        uint32_t target;
+        float length;
+        uint32_t road;
+    };
+    std::vector<Edge> edges;
+
+    QHash<uint32_t, uint16_t> typesIndices;
+    graph->roadsTypesOffsets.push_back(0);
+    for (const auto& road : constOf(roads))
+    {
+        if (road.points31.size() < 2)
+            continue;
+
+        const auto roadIndex = graph->getRoadsCount();
+        auto flags = road.flags;
+        if ((flags & Roundabout) && !(flags & (OneWayForward | OneWayReverse)))
+            flags |= OneWayForward;
+        for (const auto attributeId : constOf(road.attributeIds))
+        {
+            auto itTypeIndex = typesIndices.constFind(attributeId);
+            if (itTypeIndex == typesIndices.cend())
+            {
+                itTypeIndex = typesIndices.insert(attributeId, static_cast<uint16_t>(graph->types.size()));
+                graph->types.push_back(attributeId);
+            }
+            graph->roadsTypes.push_back(*itTypeIndex);
+        }
+
+        graph->roadsIds.push_back(road.id);
+        graph->roadsFlags.push_back(flags);
+        graph->roadsMaxSpeeds.push_back(road.maxSpeed);
+        graph->roadsTypesOffsets.push_back(graph->roadsTypes.size());
+
+        const auto& roadPoints31 = road.points31;
+        auto prevNodeIndex = static_cast<uint32_t>(
+            std::lower_bound(points31.cbegin(), points31.cend(), roadPoints31[0], pointsComparator) - points31.cbegin());
+        for (auto idx = 1, count = roadPoints31.size(); idx < count; idx++)
+        {
+            const auto nodeIndex = static_cast<uint32_t>(
+                std::lower_bound(points31.cbegin(), points31.cend(), roadPoints31[idx], pointsComparator) - points31.cbegin());
+            const auto length = static_cast<float>(Utilities::distance31(roadPoints31[idx - 1], roadPoints31[idx]));
+            if (!(flags & OneWayReverse))
+                edges.push_back({ prevNodeIndex, nodeIndex, length, roadIndex });
+            if (!(flags & OneWayForward))
+                edges.push_back({ nodeIndex, prevNodeIndex, length, roadIndex });
+            prevNodeIndex = nodeIndex;
+        }
+    }
+
+    // Counting sort of edges by source node
+    const auto nodesCount = graph->getNodesCount();
+    graph->edgesOffsets.fill(0, nodesCount + 1);
+    for (const auto& edge : edges)
+        graph->edgesOffsets[edge.source + 1]++;
+    for (auto nodeIndex = 0u; nodeIndex < nodesCount; nodeIndex++)
+        graph->edgesOffsets[nodeIndex + 1] += graph->edgesOffsets[nodeIndex];
+
+    const auto edgesCount = static_cast<int>(edges.size());
+    graph->edgesTargets.resize(edgesCount);
+    graph->edgesLengths.resize(edgesCount);
+    graph->edgesRoads.resize(edgesCount);
+    auto edgesInsertPositions = graph->edgesOffsets;
+    for (const auto& edge : edges)
+    {
+        const auto position = edgesInsertPositions[edge.source]++;
+        graph->edgesTargets[position] = edge.target;
+        graph->edgesLengths[position] = edge.length;
+        graph->edgesRoads[position] = edge.road;
+    }
+
+    return graph;
+}
+
+bool OsmAnd::RoutingGraphSnapshot::saveTo(QIODevice& output) const
+{
+    QDataStream stream(&output);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << RoutingGraphSnapshotMagic << RoutingGraphSnapshotVersion;
+    stream << nodesCoordinates31;
+    stream << edgesOffsets << edgesTargets << edgesLengths << edgesRoads;
+    stream << roadsIds << roadsFlags << roadsMaxSpeeds << roadsTypesOffsets << roadsTypes;
+    stream << types;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool OsmAnd::RoutingGraphSnapshot::saveTo(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to open '%s' for writing routing graph snapshot",
+            qPrintable(fileName));
+        return false;
+    }
+
+    const auto ok = saveTo(file);
+    file.close();
+
+    return ok;
+}
+
+std::shared_ptr<const OsmAnd::RoutingGraphSnapshot> OsmAnd::RoutingGraphSnapshot::loadFrom(QIODevice& input)
+{
+    QDataStream stream(&input);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != RoutingGraphSnapshotMagic || version != RoutingGraphSnapshotVersion)
+        return nullptr;
+
+    const std::shared_ptr<RoutingGraphSnapshot> graph(new RoutingGraphSnapshot());
+    stream >> graph->nodesCoordinates31;
+    stream >> graph->edgesOffsets >> graph->edgesTargets >> graph->edgesLengths >> graph->edgesRoads;
+    stream >> graph->roadsIds >> graph->roadsFlags >> graph->roadsMaxSpeeds >> graph->roadsTypesOffsets >> graph->roadsTypes;
+    stream >> graph->types;
+    if (stream.status() != QDataStream::Ok)
+        return nullptr;
+
+    // Verify consistency of arrays, to avoid out-of-bounds access later
+    const auto nodesCount = graph->getNodesCount();
+    const auto edgesCount = graph->getEdgesCount();
+    const auto roadsCount = graph->getRoadsCount();
+    if (graph->edgesOffsets.size() != static_cast<int>(nodesCount + 1) ||
+        graph->edgesOffsets.last() != edgesCount ||
+        graph->edgesLengths.size() != static_cast<int>(edgesCount) ||
+        graph->edgesRoads.size() != static_cast<int>(edgesCount) ||
+        graph->roadsFlags.size() != static_cast<int>(roadsCount) ||
+        graph->roadsMaxSpeeds.size() != static_cast<int>(roadsCount) ||
+        graph->roadsTypesOffsets.size() != static_cast<int>(roadsCount + 1) ||
+        graph->roadsTypesOffsets.last() != static_cast<uint32_t>(graph->roadsTypes.size()))
+    {
+        return nullptr;
+    }
+    for (auto nodeIndex = 0u; nodeIndex < nodesCount; nodeIndex++)
+    {
+        if (graph->edgesOffsets[nodeIndex] > graph->edgesOffsets[nodeIndex + 1])
+            return nullptr;
+    }
+    for (auto roadIndex = 0u; roadIndex < roadsCount; roadIndex++)
+    {
+        if (graph->roadsTypesOffsets[roadIndex] > graph->roadsTypesOffsets[roadIndex + 1])
+            return nullptr;
+    }
+    for (const auto target : constOf(graph->edgesTargets))
+    {
+        if (target >= nodesCount)
+            return nullptr;
+    }
+    for (const auto road : constOf(graph->edgesRoads))
+    {
+        if (road >= roadsCount)
+            return nullptr;
+    }
+    for (const auto type : constOf(graph->roadsTypes))
+    {
+        if (type >= graph->types.size())
+            return nullptr;
+    }
+
+    return graph;
+}
+
+std::shared_ptr<const OsmAnd::RoutingGraphSnapshot> OsmAnd::RoutingGraphSnapshot::loadFrom(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const auto graph = loadFrom(file);
+    file.close();
+
+    return graph;
+}
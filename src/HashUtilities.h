@@ -0,0 +1,39 @@
+#ifndef _OSMAND_CORE_HASH_UTILITIES_H_
+#define _OSMAND_CORE_HASH_UTILITIES_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtGlobal>
+#include <QHash>
+#include <QString>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+
+namespace OsmAnd
+{
+    // Mixes hash of value into hash of preceding fields of key, same as boost::hash_combine()
+    template<typename T>
+    inline uint qHashCombine(const uint hash, const T& value) Q_DECL_NOTHROW
+    {
+        return hash ^ (::qHash(value) + 0x9e3779b9u + (hash << 6) + (hash >> 2));
+    }
+
+    // Entries of cache are not ranked, so once it's full it simply starts over. That's cheaper than tracking
+    // usage when number of distinct keys is usually far below the limit. Caller has to serialize access
+    template<typename KEY, typename VALUE>
+    inline void insertIntoBoundedCache(
+        QHash<KEY, VALUE>& cache,
+        const int maxEntriesCount,
+        const KEY& key,
+        const VALUE& value)
+    {
+        if (cache.size() >= maxEntriesCount && !cache.contains(key))
+            cache.clear();
+        cache.insert(key, value);
+    }
+}
+
+#endif // !defined(_OSMAND_CORE_HASH_UTILITIES_H_)
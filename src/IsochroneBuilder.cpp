@@ -0,0 +1,84 @@
+#include "IsochroneBuilder.h"
+#include "IsochroneBuilder_P.h"
+
+#include "Polygon.h"
+#include "PolygonBuilder.h"
+#include "PolygonsCollection.h"
+
+OsmAnd::IsochroneBuilder::IsochroneBuilder(
+    const std::shared_ptr<const IObfsCollection>& obfsCollection_,
+    const std::shared_ptr<ObfRoutingSectionReader::DataBlocksCache>& cache_ /*= nullptr*/)
+    : _p(new IsochroneBuilder_P(this))
+    , obfsCollection(obfsCollection_)
+    , cache(cache_)
+{
+}
+
+OsmAnd::IsochroneBuilder::~IsochroneBuilder()
+{
+}
+
+QList<OsmAnd::IsochroneBuilder::Isochrone> OsmAnd::IsochroneBuilder::buildIsochrones(
+    const PointI origin31,
+    const QList<float>& timeLimits,
+    const SpeedFunction speedFunction /*= nullptr*/,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/) const
+{
+    return _p->buildIsochrones(origin31, timeLimits, speedFunction, queryController);
+}
+
+QList< std::shared_ptr<OsmAnd::Polygon> > OsmAnd::IsochroneBuilder::buildPolygons(
+    const PointI origin31,
+    const QList<float>& timeLimits,
+    const QList<FColorARGB>& fillColors,
+    const std::shared_ptr<PolygonsCollection>& collection,
+    const int basePolygonId,
+    const int baseOrder,
+    const SpeedFunction speedFunction /*= nullptr*/,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/) const
+{
+    QList< std::shared_ptr<Polygon> > polygons;
+
+    const auto isochrones = buildIsochrones(origin31, timeLimits, speedFunction, queryController);
+    for (auto index = 0; index < isochrones.size(); index++)
+    {
+        const auto& isochrone = isochrones[index];
+        if (isochrone.polygon31.size() < 3)
+            continue;
+
+        // Isochrone of smaller time limit is drawn above ones of larger time limits
+        auto order = baseOrder;
+        for (const auto timeLimit : constOf(timeLimits))
+        {
+            if (timeLimit > isochrone.timeLimit)
+                order--;
+        }
+
+        PolygonBuilder builder;
+        builder
+            .setPolygonId(basePolygonId + index)
+            .setBaseOrder(order)
+            .setFillColor(index < fillColors.size() ? fillColors[index] : FColorARGB())
+            .setPoints(isochrone.polygon31);
+        const auto polygon = builder.buildAndAddToCollection(collection);
+        if (polygon)
+            polygons.push_back(polygon);
+    }
+
+    return polygons;
+}
+
+float OsmAnd::IsochroneBuilder::getDefaultSpeed(const std::shared_ptr<const Road>& road)
+{
+    return IsochroneBuilder_P::getDefaultSpeed(road);
+}
+
+OsmAnd::IsochroneBuilder::Isochrone::Isochrone()
+    : timeLimit(0.0f)
+    , reachedPointsCount(0)
+{
+}
+
+OsmAnd::IsochroneBuilder::Isochrone::~Isochrone()
+{
+}
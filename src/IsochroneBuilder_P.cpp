@@ -0,0 +1,415 @@
+#include "IsochroneBuilder_P.h"
+#include "IsochroneBuilder.h"
+
+#include "QtExtensions.h"
+#include <QSemaphore>
+#include <QSet>
+
+#include "Road.h"
+#include "RoutingGraphSnapshot.h"
+#include "ObfRoutingSectionInfo.h"
+#include "IObfsCollection.h"
+#include "ObfDataInterface.h"
+#include "IQueryController.h"
+#include "RoadLocator.h"
+#include "QRunnableFunctor.h"
+#include "Utilities.h"
+
+OsmAnd::IsochroneBuilder_P::IsochroneBuilder_P(IsochroneBuilder* const owner_)
+    : owner(owner_)
+{
+}
+
+OsmAnd::IsochroneBuilder_P::~IsochroneBuilder_P()
+{
+    _threadPool.waitForDone();
+}
+
+QList<OsmAnd::IsochroneBuilder::Isochrone> OsmAnd::IsochroneBuilder_P::buildIsochrones(
+    const PointI origin31,
+    const QList<float>& timeLimits,
+    const IsochroneBuilder::SpeedFunction speedFunction_,
+    const std::shared_ptr<const IQueryController>& queryController) const
+{
+    QList<IsochroneBuilder::Isochrone> result;
+    if (timeLimits.isEmpty())
+        return result;
+
+    const auto speedFunction = speedFunction_ ? speedFunction_ : IsochroneBuilder::SpeedFunction(getDefaultSpeed);
+    auto maxTimeLimit = 0.0f;
+    for (const auto timeLimit : constOf(timeLimits))
+        maxTimeLimit = qMax(maxTimeLimit, timeLimit);
+
+    // Nothing can be reached farther than by moving at maximal speed, so limit area of loaded roads by that
+    auto maxSpeed = speedFunction(nullptr) / 3.6f;
+    if (maxSpeed <= 0.0f)
+        maxSpeed = getDefaultSpeed(nullptr) / 3.6f;
+    const auto radiusInMeters = static_cast<double>(maxTimeLimit * maxSpeed);
+    const auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(radiusInMeters, origin31);
+
+    QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> > dataBlocks;
+    const auto roads = loadRoads(bbox31, radiusInMeters, owner->cache ? &dataBlocks : nullptr, queryController);
+    const auto releaseDataBlocks =
+        [this, &dataBlocks]
+        ()
+        {
+            for (auto dataBlock : dataBlocks)
+                owner->cache->releaseReference(dataBlock->id, dataBlock);
+            dataBlocks.clear();
+        };
+    if (queryController && queryController->isAborted())
+    {
+        releaseDataBlocks();
+        return result;
+    }
+
+    int nearestRoadPointIndex = -1;
+    double distanceToNearestRoadPoint = -1.0;
+    const auto nearestRoad = RoadLocator::findNearestRoad(
+        roads,
+        origin31,
+        [speedFunction]
+        (const std::shared_ptr<const Road>& road) -> bool
+        {
+            return speedFunction(road) > 0.0f;
+        },
+        &nearestRoadPointIndex,
+        &distanceToNearestRoadPoint);
+
+    // Roads of cached blocks come with prebuilt flat graphs, only the rest is processed road by road
+    IsochroneGraph graph;
+    QSet<uint64_t> processedRoadsIds;
+    buildGraph(dataBlocks, speedFunction, graph, processedRoadsIds);
+    releaseDataBlocks();
+    if (processedRoadsIds.isEmpty())
+        buildGraph(roads, speedFunction, graph);
+    else
+    {
+        QList< std::shared_ptr<const Road> > remainingRoads;
+        for (const auto& road : constOf(roads))
+        {
+            if (!processedRoadsIds.contains(road->id.id))
+                remainingRoads.push_back(road);
+        }
+        buildGraph(remainingRoads, speedFunction, graph);
+    }
+
+    QList< std::pair<int, float> > seeds;
+    if (nearestRoad && nearestRoadPointIndex > 0)
+    {
+        // Reaching the road itself is assumed to take place at road speed
+        const auto speed = speedFunction(nearestRoad) / 3.6f;
+        for (const auto pointIndex : { nearestRoadPointIndex - 1, nearestRoadPointIndex })
+        {
+            const auto& point31 = nearestRoad->points31[pointIndex];
+            const auto distance = Utilities::distance31(origin31, point31);
+            seeds.push_back({ graph.obtainPointIndex(point31), static_cast<float>(distance / speed) });
+        }
+    }
+
+    const auto arrivalTimes = graph.expand(seeds, maxTimeLimit, queryController);
+    if (queryController && queryController->isAborted())
+        return result;
+
+    // Each time band is independent from others, so produce them concurrently
+    QVector<IsochroneBuilder::Isochrone> isochrones(timeLimits.size());
+    QSemaphore isochronesDone;
+    for (auto index = 0; index < timeLimits.size(); index++)
+    {
+        const auto timeLimit = timeLimits[index];
+        auto& isochrone = isochrones[index];
+        _threadPool.start(new QRunnableFunctor(
+            [origin31, timeLimit, &isochrone, &isochronesDone, &graph, &arrivalTimes]
+            (const QRunnableFunctor* const runnable)
+            {
+                const auto reachedPoints = graph.collectReachedPoints(arrivalTimes, timeLimit);
+
+                isochrone.timeLimit = timeLimit;
+                isochrone.reachedPointsCount = reachedPoints.size();
+                isochrone.polygon31 = buildHull(origin31, reachedPoints);
+                isochronesDone.release();
+            }));
+    }
+    isochronesDone.acquire(timeLimits.size());
+
+    result.reserve(isochrones.size());
+    for (const auto& isochrone : constOf(isochrones))
+        result.push_back(isochrone);
+
+    return result;
+}
+
+QList< std::shared_ptr<const OsmAnd::Road> > OsmAnd::IsochroneBuilder_P::loadRoads(
+    const AreaI bbox31,
+    const double radiusInMeters,
+    QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* const outDataBlocks,
+    const std::shared_ptr<const IQueryController>& queryController) const
+{
+    // Large areas are split into grid of cells, each loaded by separate thread
+    const auto gridSize = radiusInMeters > ParallelLoadingRadiusThreshold ? ParallelLoadingGridSize : 1;
+    const auto cellWidth = bbox31.width() / gridSize + 1;
+    const auto cellHeight = bbox31.height() / gridSize + 1;
+
+    QVector< QList< std::shared_ptr<const Road> > > roadsByCells(gridSize * gridSize);
+    QVector< QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> > > dataBlocksByCells(
+        gridSize * gridSize);
+    QSemaphore cellsDone;
+    for (auto cellY = 0; cellY < gridSize; cellY++)
+    {
+        for (auto cellX = 0; cellX < gridSize; cellX++)
+        {
+            AreaI cellBBox31;
+            cellBBox31.top() = bbox31.top() + cellY * cellHeight;
+            cellBBox31.left() = bbox31.left() + cellX * cellWidth;
+            cellBBox31.bottom() = qMin(cellBBox31.top() + cellHeight, bbox31.bottom());
+            cellBBox31.right() = qMin(cellBBox31.left() + cellWidth, bbox31.right());
+
+            auto& cellRoads = roadsByCells[cellY * gridSize + cellX];
+            auto& cellDataBlocks = dataBlocksByCells[cellY * gridSize + cellX];
+            _threadPool.start(new QRunnableFunctor(
+                [this, cellBBox31, &cellRoads, &cellDataBlocks, &cellsDone, outDataBlocks, queryController]
+                (const QRunnableFunctor* const runnable)
+                {
+                    const auto obfDataInterface = owner->obfsCollection->obtainDataInterface(
+                        &cellBBox31,
+                        MinZoomLevel,
+                        MaxZoomLevel,
+                        ObfDataTypesMask().set(ObfDataType::Routing));
+                    obfDataInterface->loadRoads(
+                        RoutingDataLevel::Detailed,
+                        &cellBBox31,
+                        &cellRoads,
+                        nullptr,
+                        nullptr,
+                        owner->cache.get(),
+                        outDataBlocks ? &cellDataBlocks : nullptr,
+                        queryController,
+                        nullptr);
+                    cellsDone.release();
+                }));
+        }
+    }
+    cellsDone.acquire(gridSize * gridSize);
+
+    // Each referenced block has to be released by caller, even if referenced by several cells
+    if (outDataBlocks)
+    {
+        for (const auto& cellDataBlocks : constOf(dataBlocksByCells))
+            outDataBlocks->append(cellDataBlocks);
+    }
+
+    // Roads that cross cells borders are loaded several times
+    QList< std::shared_ptr<const Road> > roads;
+    QSet<ObfObjectId> processedIds;
+    for (const auto& cellRoads : constOf(roadsByCells))
+    {
+        for (const auto& road : constOf(cellRoads))
+        {
+            if (road->points31.size() < 2 || road->isDeleted())
+                continue;
+            if (gridSize > 1 && processedIds.contains(road->id))
+                continue;
+
+            processedIds.insert(road->id);
+            roads.push_back(road);
+        }
+    }
+
+    return roads;
+}
+
+void OsmAnd::IsochroneBuilder_P::buildGraph(
+    const QList< std::shared_ptr<const Road> >& roads,
+    const IsochroneBuilder::SpeedFunction speedFunction,
+    IsochroneGraph& outGraph)
+{
+    for (const auto& road : constOf(roads))
+    {
+        const auto speed = speedFunction(road) / 3.6f;
+        if (speed <= 0.0f)
+            continue;
+
+        auto oneway = 0;
+        const auto& decodeMap = road->section->getAttributeMapping()->routingDecodeMap;
+        for (const auto attributeId : constOf(road->attributeIds))
+        {
+            const auto rule = decodeMap.getRef(attributeId);
+            if (!rule)
+                continue;
+
+            if (rule->onewayDirection() != 0)
+            {
+                oneway = rule->onewayDirection();
+                break;
+            }
+            if (rule->roundabout())
+                oneway = 1;
+        }
+
+        const auto& points31 = road->points31;
+        auto prevPointIndex = outGraph.obtainPointIndex(points31[0]);
+        for (auto idx = 1, count = points31.size(); idx < count; idx++)
+        {
+            const auto pointIndex = outGraph.obtainPointIndex(points31[idx]);
+            const auto time = static_cast<float>(Utilities::distance31(points31[idx - 1], points31[idx]) / speed);
+            if (oneway >= 0)
+                outGraph.edges[prevPointIndex].push_back({ pointIndex, time });
+            if (oneway <= 0)
+                outGraph.edges[pointIndex].push_back({ prevPointIndex, time });
+            prevPointIndex = pointIndex;
+        }
+    }
+}
+
+void OsmAnd::IsochroneBuilder_P::buildGraph(
+    const QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >& dataBlocks,
+    const IsochroneBuilder::SpeedFunction speedFunction,
+    IsochroneGraph& outGraph,
+    QSet<uint64_t>& outProcessedRoadsIds)
+{
+    QSet<const ObfRoutingSectionReader::DataBlock*> processedDataBlocks;
+    QVector<float> roadsSpeeds;
+    QVector<int> nodesPointIndices;
+    for (const auto& dataBlock : constOf(dataBlocks))
+    {
+        if (processedDataBlocks.contains(dataBlock.get()))
+            continue;
+        processedDataBlocks.insert(dataBlock.get());
+
+        const auto graph = dataBlock->getGraph();
+        if (!graph)
+            continue;
+
+        // Snapshot roads are block roads without degenerate and deleted ones, in same order
+        roadsSpeeds.resize(0);
+        roadsSpeeds.reserve(graph->getRoadsCount());
+        for (const auto& road : constOf(dataBlock->roads))
+        {
+            if (road->points31.size() < 2 || road->isDeleted())
+                continue;
+
+            roadsSpeeds.push_back(speedFunction(road) / 3.6f);
+            outProcessedRoadsIds.insert(road->id.id);
+        }
+        if (roadsSpeeds.size() != static_cast<int>(graph->getRoadsCount()))
+        {
+            for (const auto roadId : constOf(graph->roadsIds))
+                outProcessedRoadsIds.remove(roadId);
+            continue;
+        }
+
+        // Oneway restrictions are already applied to edges of snapshot
+        const auto nodesCount = graph->getNodesCount();
+        nodesPointIndices.fill(-1, static_cast<int>(nodesCount));
+        for (auto nodeIndex = 0u; nodeIndex < nodesCount; nodeIndex++)
+        {
+            const auto edgesEnd = graph->edgesOffsets[nodeIndex + 1];
+            for (auto edgeIndex = graph->edgesOffsets[nodeIndex]; edgeIndex < edgesEnd; edgeIndex++)
+            {
+                const auto speed = roadsSpeeds[graph->edgesRoads[edgeIndex]];
+                if (speed <= 0.0f)
+                    continue;
+
+                const auto targetNodeIndex = graph->edgesTargets[edgeIndex];
+                if (nodesPointIndices[nodeIndex] < 0)
+                    nodesPointIndices[nodeIndex] = outGraph.obtainPointIndex(graph->getNode(nodeIndex));
+                if (nodesPointIndices[targetNodeIndex] < 0)
+                    nodesPointIndices[targetNodeIndex] = outGraph.obtainPointIndex(graph->getNode(targetNodeIndex));
+
+                const auto time = graph->edgesLengths[edgeIndex] / speed;
+                outGraph.edges[nodesPointIndices[nodeIndex]].push_back({ nodesPointIndices[targetNodeIndex], time });
+            }
+        }
+    }
+}
+
+QVector<OsmAnd::PointI> OsmAnd::IsochroneBuilder_P::buildHull(
+    const PointI origin31,
+    const QVector<PointI>& points31)
+{
+    // Star-shaped concave hull: farthest reached point in each angular sector around origin.
+    // Unlike convex hull it follows the shape of the road network, and it's always a simple polygon.
+    const auto sectorsCount = qBound(
+        static_cast<int>(MinHullSectorsCount),
+        points31.size() / PointsPerHullSector,
+        static_cast<int>(MaxHullSectorsCount));
+
+    QVector<double> sectorSquareDistances(sectorsCount, -1.0);
+    QVector<PointI> sectorPoints(sectorsCount);
+    for (const auto& point31 : constOf(points31))
+    {
+        const auto dx = static_cast<double>(point31.x - origin31.x);
+        const auto dy = static_cast<double>(point31.y - origin31.y);
+        const auto angle = qAtan2(dy, dx) + M_PI;
+        const auto sector = qMin(static_cast<int>(angle / (2.0 * M_PI) * sectorsCount), sectorsCount - 1);
+        const auto squareDistance = dx * dx + dy * dy;
+        if (squareDistance > sectorSquareDistances[sector])
+        {
+            sectorSquareDistances[sector] = squareDistance;
+            sectorPoints[sector] = point31;
+        }
+    }
+
+    QVector<PointI> hull;
+    hull.reserve(sectorsCount + 1);
+    for (auto sector = 0; sector < sectorsCount; sector++)
+    {
+        if (sectorSquareDistances[sector] < 0.0)
+            continue;
+        hull.push_back(sectorPoints[sector]);
+    }
+    if (hull.size() < 3)
+        return {};
+
+    // Close the ring
+    hull.push_back(hull.first());
+
+    return hull;
+}
+
+float OsmAnd::IsochroneBuilder_P::getDefaultSpeed(const std::shared_ptr<const Road>& road)
+{
+    // Without road, maximal possible speed is requested
+    if (!road)
+        return 130.0f;
+
+    const auto maxSpeed = qMax(road->getMaximumSpeed(true), road->getMaximumSpeed(false));
+    if (maxSpeed > 0.0f)
+        return maxSpeed * 3.6f;
+
+    const auto& decodeMap = road->section->getAttributeMapping()->routingDecodeMap;
+    for (const auto attributeId : constOf(road->attributeIds))
+    {
+        const auto rule = decodeMap.getRef(attributeId);
+        if (!rule)
+            continue;
+
+        const auto highway = rule->highwayRoad();
+        if (highway.isEmpty())
+            continue;
+
+        if (highway.startsWith(QLatin1String("motorway")))
+            return 110.0f;
+        else if (highway.startsWith(QLatin1String("trunk")))
+            return 90.0f;
+        else if (highway.startsWith(QLatin1String("primary")))
+            return 70.0f;
+        else if (highway.startsWith(QLatin1String("secondary")))
+            return 60.0f;
+        else if (highway.startsWith(QLatin1String("tertiary")))
+            return 50.0f;
+        else if (highway == QLatin1String("unclassified") || highway == QLatin1String("road"))
+            return 40.0f;
+        else if (highway == QLatin1String("residential"))
+            return 30.0f;
+        else if (highway == QLatin1String("service") || highway == QLatin1String("track"))
+            return 15.0f;
+        else if (highway == QLatin1String("living_street"))
+            return 10.0f;
+
+        // Footways, steps, paths and others are not suitable for car
+        return 0.0f;
+    }
+
+    return 0.0f;
+}
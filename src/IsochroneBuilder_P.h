@@ -0,0 +1,71 @@
+#ifndef _OSMAND_CORE_ISOCHRONE_BUILDER_P_H_
+#define _OSMAND_CORE_ISOCHRONE_BUILDER_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QThreadPool>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+#include "IsochroneBuilder.h"
+#include "IsochroneGraph.h"
+
+namespace OsmAnd
+{
+    class IsochroneBuilder;
+    class IsochroneBuilder_P Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(IsochroneBuilder_P);
+    private:
+        // Budgets that need roads from area larger than this radius are loaded by several threads
+        static const int ParallelLoadingRadiusThreshold = 10000;
+        static const int ParallelLoadingGridSize = 4;
+        static const int MinHullSectorsCount = 16;
+        static const int MaxHullSectorsCount = 360;
+        static const int PointsPerHullSector = 16;
+
+        mutable QThreadPool _threadPool;
+
+        QList< std::shared_ptr<const Road> > loadRoads(
+            const AreaI bbox31,
+            const double radiusInMeters,
+            QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* const outDataBlocks,
+            const std::shared_ptr<const IQueryController>& queryController) const;
+        static void buildGraph(
+            const QList< std::shared_ptr<const Road> >& roads,
+            const IsochroneBuilder::SpeedFunction speedFunction,
+            IsochroneGraph& outGraph);
+        static void buildGraph(
+            const QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >& dataBlocks,
+            const IsochroneBuilder::SpeedFunction speedFunction,
+            IsochroneGraph& outGraph,
+            QSet<uint64_t>& outProcessedRoadsIds);
+        static QVector<PointI> buildHull(
+            const PointI origin31,
+            const QVector<PointI>& points31);
+    protected:
+        IsochroneBuilder_P(IsochroneBuilder* const owner);
+    public:
+        ~IsochroneBuilder_P();
+
+        ImplementationInterface<IsochroneBuilder> owner;
+
+        QList<IsochroneBuilder::Isochrone> buildIsochrones(
+            const PointI origin31,
+            const QList<float>& timeLimits,
+            const IsochroneBuilder::SpeedFunction speedFunction,
+            const std::shared_ptr<const IQueryController>& queryController) const;
+
+        static float getDefaultSpeed(const std::shared_ptr<const Road>& road);
+
+    friend class OsmAnd::IsochroneBuilder;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ISOCHRONE_BUILDER_P_H_)
@@ -0,0 +1,128 @@
+#ifndef _OSMAND_CORE_ISOCHRONE_GRAPH_H_
+#define _OSMAND_CORE_ISOCHRONE_GRAPH_H_
+
+#include "stdlib_common.h"
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "IQueryController.h"
+
+namespace OsmAnd
+{
+    // Graph of road points with travel times along road segments, that isochrone builder searches
+    struct IsochroneGraph Q_DECL_FINAL
+    {
+        struct Edge
+        {
+            int target;
+            float time;
+        };
+
+        QVector<PointI> points31;
+        QVector< QVector<Edge> > edges;
+        QHash<int64_t, int> pointIndices;
+
+        inline int obtainPointIndex(const PointI& point31)
+        {
+            const auto key = (static_cast<int64_t>(point31.x) << 32) | static_cast<uint32_t>(point31.y);
+            const auto citPointIndex = pointIndices.constFind(key);
+            if (citPointIndex != pointIndices.cend())
+                return *citPointIndex;
+
+            const auto pointIndex = points31.size();
+            points31.push_back(point31);
+            edges.push_back({});
+            pointIndices.insert(key, pointIndex);
+            return pointIndex;
+        }
+
+        // Earliest arrival time at each point from seeds, infinity for points that can't be reached within limit
+        inline QVector<float> expand(
+            const QList< std::pair<int, float> >& seeds,
+            const float timeLimit,
+            const std::shared_ptr<const IQueryController>& queryController) const
+        {
+            QVector<float> arrivalTimes(points31.size(), std::numeric_limits<float>::infinity());
+
+            typedef std::pair<float, int> QueueEntry;
+            std::priority_queue< QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+            for (const auto& seed : constOf(seeds))
+            {
+                if (seed.second > timeLimit || seed.second >= arrivalTimes[seed.first])
+                    continue;
+
+                arrivalTimes[seed.first] = seed.second;
+                queue.push({ seed.second, seed.first });
+            }
+
+            while (!queue.empty())
+            {
+                if (queryController && queryController->isAborted())
+                    break;
+
+                const auto entry = queue.top();
+                queue.pop();
+                if (entry.first > arrivalTimes[entry.second])
+                    continue;
+
+                for (const auto& edge : constOf(edges[entry.second]))
+                {
+                    const auto arrivalTime = entry.first + edge.time;
+                    if (arrivalTime > timeLimit || arrivalTime >= arrivalTimes[edge.target])
+                        continue;
+
+                    arrivalTimes[edge.target] = arrivalTime;
+                    queue.push({ arrivalTime, edge.target });
+                }
+            }
+
+            return arrivalTimes;
+        }
+
+        // Points reached within limit, and points where edges leaving them stop being passable
+        inline QVector<PointI> collectReachedPoints(
+            const QVector<float>& arrivalTimes,
+            const float timeLimit) const
+        {
+            QVector<PointI> reachedPoints;
+            for (auto pointIndex = 0, count = arrivalTimes.size(); pointIndex < count; pointIndex++)
+            {
+                const auto arrivalTime = arrivalTimes[pointIndex];
+                if (arrivalTime > timeLimit)
+                    continue;
+
+                const auto& point31 = points31[pointIndex];
+                reachedPoints.push_back(point31);
+
+                // Edges that can not be passed completely are reached partially
+                for (const auto& edge : constOf(edges[pointIndex]))
+                {
+                    if (arrivalTimes[edge.target] <= timeLimit || edge.time <= 0.0f)
+                        continue;
+
+                    const auto factor = (timeLimit - arrivalTime) / edge.time;
+                    const auto& target31 = points31[edge.target];
+                    reachedPoints.push_back(PointI(
+                        point31.x + static_cast<int32_t>((target31.x - point31.x) * factor),
+                        point31.y + static_cast<int32_t>((target31.y - point31.y) * factor)));
+                }
+            }
+
+            return reachedPoints;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ISOCHRONE_GRAPH_H_)
@@ -0,0 +1,75 @@
+#include "CoastlinesPolygonizationCache.h"
+
+#include "QtCommon.h"
+
+OsmAnd::CoastlinesPolygonizationCache::CoastlinesPolygonizationCache()
+{
+}
+
+OsmAnd::CoastlinesPolygonizationCache::~CoastlinesPolygonizationCache()
+{
+}
+
+QVector<const OsmAnd::MapObject*> OsmAnd::CoastlinesPolygonizationCache::getSortedCoastlines(
+    const QList< std::shared_ptr<const MapObject> >& coastlines)
+{
+    // Same coastlines may come in different order from different queries
+    QVector<const MapObject*> sortedCoastlines;
+    sortedCoastlines.reserve(coastlines.size());
+    for (const auto& coastline : constOf(coastlines))
+        sortedCoastlines.push_back(coastline.get());
+    std::sort(sortedCoastlines.begin(), sortedCoastlines.end());
+
+    return sortedCoastlines;
+}
+
+bool OsmAnd::CoastlinesPolygonizationCache::obtain(
+    const AreaI area31,
+    const ZoomLevel zoom,
+    const QList< std::shared_ptr<const MapObject> >& coastlines,
+    bool& outProcessed,
+    QList< std::shared_ptr<const MapObject> >& outPolygonizedCoastlines) const
+{
+    const auto sortedCoastlines = getSortedCoastlines(coastlines);
+
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    for (auto itEntry = _entries.begin(); itEntry != _entries.end(); ++itEntry)
+    {
+        const auto& entry = *itEntry;
+        if (entry->area31 != area31 || entry->zoom != zoom || entry->sortedCoastlines != sortedCoastlines)
+            continue;
+
+        outProcessed = entry->processed;
+        outPolygonizedCoastlines.append(entry->polygonizedCoastlines);
+
+        if (itEntry != _entries.begin())
+            _entries.move(itEntry - _entries.begin(), 0);
+
+        return true;
+    }
+
+    return false;
+}
+
+void OsmAnd::CoastlinesPolygonizationCache::insert(
+    const AreaI area31,
+    const ZoomLevel zoom,
+    const QList< std::shared_ptr<const MapObject> >& coastlines,
+    const bool processed,
+    const QList< std::shared_ptr<const MapObject> >& polygonizedCoastlines)
+{
+    const std::shared_ptr<Entry> entry(new Entry());
+    entry->area31 = area31;
+    entry->zoom = zoom;
+    entry->sortedCoastlines = getSortedCoastlines(coastlines);
+    entry->coastlines = coastlines;
+    entry->processed = processed;
+    entry->polygonizedCoastlines = polygonizedCoastlines;
+
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    _entries.push_front(entry);
+    while (_entries.size() > MaxEntries)
+        _entries.removeLast();
+}
@@ -0,0 +1,68 @@
+#ifndef _OSMAND_CORE_COASTLINES_POLYGONIZATION_CACHE_H_
+#define _OSMAND_CORE_COASTLINES_POLYGONIZATION_CACHE_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "MapObject.h"
+
+namespace OsmAnd
+{
+    // Land and water polygons built from coastlines for given area and zoom. Neighbouring tiles polygonize
+    // same area when surface type is determined from overscaled or basemap coastlines, and same tile is
+    // polygonized again each time it's requested. Source coastlines are held by entries, so that identity
+    // of map objects can be used as part of the key.
+    class CoastlinesPolygonizationCache Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(CoastlinesPolygonizationCache);
+    public:
+        enum {
+            MaxEntries = 64,
+        };
+
+    private:
+        struct Entry
+        {
+            AreaI area31;
+            ZoomLevel zoom;
+            QVector<const MapObject*> sortedCoastlines;
+            QList< std::shared_ptr<const MapObject> > coastlines;
+            bool processed;
+            QList< std::shared_ptr<const MapObject> > polygonizedCoastlines;
+        };
+
+        mutable QMutex _entriesMutex;
+        // Most recently used entries are in front
+        mutable QList< std::shared_ptr<const Entry> > _entries;
+
+        static QVector<const MapObject*> getSortedCoastlines(
+            const QList< std::shared_ptr<const MapObject> >& coastlines);
+    protected:
+    public:
+        CoastlinesPolygonizationCache();
+        ~CoastlinesPolygonizationCache();
+
+        bool obtain(
+            const AreaI area31,
+            const ZoomLevel zoom,
+            const QList< std::shared_ptr<const MapObject> >& coastlines,
+            bool& outProcessed,
+            QList< std::shared_ptr<const MapObject> >& outPolygonizedCoastlines) const;
+        void insert(
+            const AreaI area31,
+            const ZoomLevel zoom,
+            const QList< std::shared_ptr<const MapObject> >& coastlines,
+            const bool processed,
+            const QList< std::shared_ptr<const MapObject> >& polygonizedCoastlines);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_COASTLINES_POLYGONIZATION_CACHE_H_)
@@ -1,8 +1,14 @@
 #include "MapPresentationEnvironment.h"
 #include "MapPresentationEnvironment_P.h"
 
+#include "ignore_warnings_on_external_includes.h"
+#include <QAtomicInt>
+#include "restore_internal_warnings.h"
+
 #include "MapStyleBuiltinValueDefinitions.h"
 
+static QAtomicInt lastEnvironmentUniqueId;
+
 OsmAnd::MapPresentationEnvironment::MapPresentationEnvironment(
     const std::shared_ptr<const IMapStyle>& mapStyle_,
     const float displayDensityFactor_ /*= 1.0f*/,
@@ -18,6 +24,7 @@ OsmAnd::MapPresentationEnvironment::MapPresentationEnvironment(
     , symbolsScaleFactor(symbolsScaleFactor_)
     , externalResourcesProvider(externalResourcesProvider_)
     , disabledAttributes(disabledAttributes)
+    , uniqueId(static_cast<unsigned int>(lastEnvironmentUniqueId.fetchAndAddOrdered(1) + 1))
 {
     _p->initialize();
 }
@@ -68,6 +75,18 @@ void OsmAnd::MapPresentationEnvironment::applyTo(MapStyleEvaluator& evaluator) c
     _p->applyTo(evaluator);
 }
 
+std::shared_ptr<OsmAnd::MapStyleEvaluationResultsCache> OsmAnd::MapPresentationEnvironment::getEvaluationResultsCache() const
+{
+    return _p->getEvaluationResultsCache();
+}
+
+std::shared_ptr<OsmAnd::MapStyleEvaluatorsContext> OsmAnd::MapPresentationEnvironment::obtainEvaluatorsContext(
+    const ZoomLevel zoom,
+    const ZoomLevel detailedZoom) const
+{
+    return _p->obtainEvaluatorsContext(zoom, detailedZoom);
+}
+
 std::shared_ptr<const OsmAnd::LayeredIconData> OsmAnd::MapPresentationEnvironment::getLayeredIconData(
     const QString& tag,
     const QString& value,
@@ -126,6 +145,20 @@ bool OsmAnd::MapPresentationEnvironment::obtainShaderOrShield(
     return _p->obtainShaderOrShield(name, scale, outTextShield);
 }
 
+bool OsmAnd::MapPresentationEnvironment::obtainPathEffect(
+    const QString& encodedPathEffect,
+    sk_sp<SkPathEffect>& outPathEffect) const
+{
+    return _p->obtainPathEffect(encodedPathEffect, outPathEffect);
+}
+
+bool OsmAnd::MapPresentationEnvironment::obtainImageShader(
+    const QString& name,
+    sk_sp<SkShader>& outShader) const
+{
+    return _p->obtainImageShader(name, outShader);
+}
+
 OsmAnd::ColorARGB OsmAnd::MapPresentationEnvironment::getDefaultBackgroundColor(
     const ZoomLevel zoom) const
 {
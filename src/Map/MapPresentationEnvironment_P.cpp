@@ -8,10 +8,13 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <SkData.h>
 #include <SkImage.h>
+#include <SkDashPathEffect.h>
 #include "restore_internal_warnings.h"
 
 #include "MapStyleEvaluator.h"
 #include "MapStyleEvaluationResult.h"
+#include "MapStyleEvaluationResultsCache.h"
+#include "MapStyleEvaluatorsPool.h"
 #include "MapStyleValueDefinition.h"
 #include "MapStyleConstantValue.h"
 #include "MapStyleBuiltinValueDefinitions.h"
@@ -36,6 +39,8 @@ OsmAnd::MapPresentationEnvironment_P::~MapPresentationEnvironment_P()
 
 void OsmAnd::MapPresentationEnvironment_P::initialize()
 {
+    _evaluatorsPool.reset(new MapStyleEvaluatorsPool(*this, _settings));
+
     _mapIcons.reset(new IconsProvider(("map/icons/%1.svg"), owner->externalResourcesProvider, owner->displayDensityFactor));
     _shadersAndShields.reset(new IconsProvider(QLatin1String("map/shaders_and_shields/%1.svg"), owner->externalResourcesProvider, owner->displayDensityFactor));
 
@@ -97,6 +102,163 @@ void OsmAnd::MapPresentationEnvironment_P::initialize()
     }
 
     _desiredStubsStyle = MapStubStyle::Unspecified;
+
+    prepareStyleResources();
+}
+
+void OsmAnd::MapPresentationEnvironment_P::prepareStyleResources()
+{
+    const auto& builtinValueDefs = owner->styleBuiltinValueDefs;
+
+    QSet<QString> encodedPathEffects;
+    collectStyleStrings(
+        QSet<IMapStyle::ValueDefinitionId>()
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT__2
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT__1
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT_0
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT_2
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT_3
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT_4
+            << builtinValueDefs->id_OUTPUT_PATH_EFFECT_5,
+        encodedPathEffects);
+    _pathEffects.reserve(encodedPathEffects.size());
+    for (const auto& encodedPathEffect : constOf(encodedPathEffects))
+    {
+        // Invalid values are remembered as well, so that they are reported only once
+        sk_sp<SkPathEffect> pathEffect;
+        createPathEffect(encodedPathEffect, pathEffect);
+        _pathEffects.insert(encodedPathEffect, pathEffect);
+    }
+
+    QSet<QString> shaderNames;
+    collectStyleStrings(
+        QSet<IMapStyle::ValueDefinitionId>() << builtinValueDefs->id_OUTPUT_SHADER,
+        shaderNames);
+    _imageShaders.reserve(shaderNames.size());
+    for (const auto& shaderName : constOf(shaderNames))
+    {
+        sk_sp<SkShader> shader;
+        createImageShader(shaderName, shader);
+        _imageShaders.insert(shaderName, shader);
+    }
+}
+
+void OsmAnd::MapPresentationEnvironment_P::collectStyleStrings(
+    const QSet<IMapStyle::ValueDefinitionId>& valueDefIds,
+    QSet<QString>& outStrings) const
+{
+    const auto& mapStyle = owner->mapStyle;
+    const auto attributeValueDefId = owner->styleBuiltinValueDefs->id_OUTPUT_ATTR_STRING_VALUE;
+
+    // Attributes referenced by values of interest are walked as well, looking for values they output
+    QList< std::pair<std::shared_ptr<const IMapStyle::IRuleNode>, bool> > pendingNodes;
+    for (auto rulesetTypeIdx = 0u; rulesetTypeIdx < MapStyleRulesetTypesCount; rulesetTypeIdx++)
+    {
+        const auto& ruleset = mapStyle->getRuleset(static_cast<MapStyleRulesetType>(rulesetTypeIdx));
+        for (const auto& rule : constOf(ruleset))
+            pendingNodes.push_back({ rule->getRootNodeRef(), false });
+    }
+
+    QSet<const IMapStyle::IRuleNode*> visitedNodes;
+    QSet<const IMapStyle::IAttribute*> visitedAttributes;
+    while (!pendingNodes.isEmpty())
+    {
+        const auto pendingNode = pendingNodes.takeLast();
+        const auto& ruleNode = pendingNode.first;
+        const auto isAttributeNode = pendingNode.second;
+        if (!ruleNode || visitedNodes.contains(ruleNode.get()))
+            continue;
+        visitedNodes.insert(ruleNode.get());
+
+        for (const auto& valueEntry : rangeOf(constOf(ruleNode->getValuesRef())))
+        {
+            const auto valueDefId = valueEntry.key();
+            if (isAttributeNode ? valueDefId != attributeValueDefId : !valueDefIds.contains(valueDefId))
+                continue;
+
+            const auto& value = valueEntry.value();
+            if (!value.isDynamic)
+            {
+                const auto string = mapStyle->getStringById(value.asConstantValue.asSimple.asUInt);
+                if (!string.isEmpty())
+                    outStrings.insert(string);
+            }
+            else if (const auto& attribute = value.asDynamicValue.attribute)
+            {
+                if (!visitedAttributes.contains(attribute.get()))
+                {
+                    visitedAttributes.insert(attribute.get());
+                    pendingNodes.push_back({ attribute->getRootNodeRef(), true });
+                }
+            }
+        }
+
+        for (const auto& subnode : constOf(ruleNode->getOneOfConditionalSubnodesRef()))
+            pendingNodes.push_back({ subnode, isAttributeNode });
+        for (const auto& subnode : constOf(ruleNode->getApplySubnodesRef()))
+            pendingNodes.push_back({ subnode, isAttributeNode });
+    }
+}
+
+bool OsmAnd::MapPresentationEnvironment_P::createPathEffect(
+    const QString& encodedPathEffect,
+    sk_sp<SkPathEffect>& outPathEffect) const
+{
+    const auto& strIntervals = encodedPathEffect.split(QLatin1Char('_'), QString::SkipEmptyParts);
+    const auto intervalsCount = strIntervals.size();
+
+    // Validate
+    if (intervalsCount < 2 || intervalsCount % 2 != 0)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Path effect (%s) with %d intervals is invalid",
+            qPrintable(encodedPathEffect),
+            intervalsCount);
+        return false;
+    }
+
+    QVector<SkScalar> intervals(intervalsCount);
+    auto pInterval = intervals.data();
+    for (const auto& strInterval : constOf(strIntervals))
+    {
+        float computedValue = 0.0f;
+
+        if (!strInterval.contains(QLatin1Char(':')))
+        {
+            computedValue = strInterval.toFloat()*owner->displayDensityFactor;
+        }
+        else
+        {
+            // "pt:px" format
+            const auto& complexValue = strInterval.split(QLatin1Char(':'), QString::KeepEmptyParts);
+
+            computedValue = complexValue[0].toFloat()*owner->displayDensityFactor + complexValue[1].toFloat();
+        }
+
+        *(pInterval++) = computedValue;
+    }
+
+    outPathEffect = SkDashPathEffect::Make(intervals.constData(), intervalsCount, 0);
+    return static_cast<bool>(outPathEffect);
+}
+
+bool OsmAnd::MapPresentationEnvironment_P::createImageShader(
+    const QString& name,
+    sk_sp<SkShader>& outShader) const
+{
+    sk_sp<const SkImage> image;
+    if (!obtainIcon(name, 1.0f, image))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to get '%s' shader image",
+            qPrintable(name));
+
+        return false;
+    }
+
+    outShader = image->makeShader(SkTileMode::kRepeat, SkTileMode::kRepeat, {});
+    return true;
 }
 
 QString OsmAnd::MapPresentationEnvironment_P::getLocaleLanguageId() const
@@ -139,6 +301,30 @@ void OsmAnd::MapPresentationEnvironment_P::setSettings(const QHash< OsmAnd::IMap
     QMutexLocker scopedLocker(&_settingsChangeMutex);
 
     _settings = newSettings;
+
+    // Pooled evaluators and cached evaluation results were obtained with previous settings
+    _evaluatorsPool.reset(new MapStyleEvaluatorsPool(*this, _settings));
+}
+
+std::shared_ptr<OsmAnd::MapStyleEvaluationResultsCache> OsmAnd::MapPresentationEnvironment_P::getEvaluationResultsCache() const
+{
+    QMutexLocker scopedLocker(&_settingsChangeMutex);
+
+    return _evaluatorsPool->evaluationResultsCache;
+}
+
+std::shared_ptr<OsmAnd::MapStyleEvaluatorsContext> OsmAnd::MapPresentationEnvironment_P::obtainEvaluatorsContext(
+    const ZoomLevel zoom,
+    const ZoomLevel detailedZoom) const
+{
+    std::shared_ptr<const MapStyleEvaluatorsPool> evaluatorsPool;
+    {
+        QMutexLocker scopedLocker(&_settingsChangeMutex);
+
+        evaluatorsPool = _evaluatorsPool;
+    }
+
+    return evaluatorsPool->obtainContext(zoom, detailedZoom);
 }
 
 QHash<OsmAnd::IMapStyle::ValueDefinitionId, OsmAnd::MapStyleConstantValue> OsmAnd::MapPresentationEnvironment_P::resolveSettings(const QHash<QString, QString> &newSettings) const
@@ -412,6 +598,76 @@ bool OsmAnd::MapPresentationEnvironment_P::obtainShaderOrShield(
     return _shadersAndShields->obtainIcon(name, scale, outIcon);
 }
 
+bool OsmAnd::MapPresentationEnvironment_P::obtainPathEffect(
+    const QString& encodedPathEffect,
+    sk_sp<SkPathEffect>& outPathEffect) const
+{
+    // Table of values known from style is not modified after initialization, so it's read without locking
+    const auto citPathEffect = _pathEffects.constFind(encodedPathEffect);
+    if (citPathEffect != _pathEffects.cend())
+    {
+        outPathEffect = *citPathEffect;
+        return static_cast<bool>(outPathEffect);
+    }
+
+    {
+        QReadLocker scopedLocker(&_otherPathEffectsLock);
+
+        const auto citOtherPathEffect = _otherPathEffects.constFind(encodedPathEffect);
+        if (citOtherPathEffect != _otherPathEffects.cend())
+        {
+            outPathEffect = *citOtherPathEffect;
+            return static_cast<bool>(outPathEffect);
+        }
+    }
+
+    sk_sp<SkPathEffect> pathEffect;
+    createPathEffect(encodedPathEffect, pathEffect);
+    {
+        QWriteLocker scopedLocker(&_otherPathEffectsLock);
+
+        _otherPathEffects.insert(encodedPathEffect, pathEffect);
+    }
+
+    outPathEffect = pathEffect;
+    return static_cast<bool>(outPathEffect);
+}
+
+bool OsmAnd::MapPresentationEnvironment_P::obtainImageShader(
+    const QString& name,
+    sk_sp<SkShader>& outShader) const
+{
+    const auto citImageShader = _imageShaders.constFind(name);
+    if (citImageShader != _imageShaders.cend())
+    {
+        outShader = *citImageShader;
+        return static_cast<bool>(outShader);
+    }
+
+    {
+        QReadLocker scopedLocker(&_otherImageShadersLock);
+
+        const auto citOtherImageShader = _otherImageShaders.constFind(name);
+        if (citOtherImageShader != _otherImageShaders.cend())
+        {
+            outShader = *citOtherImageShader;
+            return static_cast<bool>(outShader);
+        }
+    }
+
+    // Failed ones are stored as well, so that warning is logged once
+    sk_sp<SkShader> shader;
+    createImageShader(name, shader);
+    {
+        QWriteLocker scopedLocker(&_otherImageShadersLock);
+
+        _otherImageShaders.insert(name, shader);
+    }
+
+    outShader = shader;
+    return static_cast<bool>(outShader);
+}
+
 OsmAnd::ColorARGB OsmAnd::MapPresentationEnvironment_P::getDefaultBackgroundColor(const ZoomLevel zoom) const
 {
     auto result = _defaultBackgroundColor;
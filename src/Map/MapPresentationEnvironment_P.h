@@ -8,6 +8,7 @@
 #include <QMap>
 #include <QList>
 #include <QHash>
+#include <QSet>
 #include <QMutex>
 #include <QReadWriteLock>
 #include "restore_internal_warnings.h"
@@ -15,6 +16,8 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <SkImage.h>
 #include <SkPaint.h>
+#include <SkPathEffect.h>
+#include <SkShader.h>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -31,6 +34,9 @@ namespace OsmAnd
     class UnresolvedMapStyle;
     class MapStyleEvaluator;
     class MapStyleEvaluator_P;
+    class MapStyleEvaluationResultsCache;
+    class MapStyleEvaluatorsContext;
+    class MapStyleEvaluatorsPool;
 
     class MapPresentationEnvironment_P Q_DECL_FINAL
     {
@@ -54,6 +60,7 @@ namespace OsmAnd
 
         mutable QMutex _settingsChangeMutex;
         QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > _settings;
+        std::shared_ptr<MapStyleEvaluatorsPool> _evaluatorsPool;
 
         std::shared_ptr<const IMapStyle::IAttribute> _defaultBackgroundColorAttribute;
         ColorARGB _defaultBackgroundColor;
@@ -92,6 +99,22 @@ namespace OsmAnd
         std::shared_ptr<IconsProvider> _mapIcons;
         std::shared_ptr<IconsProvider> _shadersAndShields;
 
+        // Built in initialize() for every value style may output and never modified afterwards
+        QHash< QString, sk_sp<SkPathEffect> > _pathEffects;
+        QHash< QString, sk_sp<SkShader> > _imageShaders;
+        // Values composed at evaluation time are not known in advance
+        mutable QReadWriteLock _otherPathEffectsLock;
+        mutable QHash< QString, sk_sp<SkPathEffect> > _otherPathEffects;
+        mutable QReadWriteLock _otherImageShadersLock;
+        mutable QHash< QString, sk_sp<SkShader> > _otherImageShaders;
+
+        void prepareStyleResources();
+        void collectStyleStrings(
+            const QSet<IMapStyle::ValueDefinitionId>& valueDefIds,
+            QSet<QString>& outStrings) const;
+        bool createPathEffect(const QString& encodedPathEffect, sk_sp<SkPathEffect>& outPathEffect) const;
+        bool createImageShader(const QString& name, sk_sp<SkShader>& outShader) const;
+
         bool obtainIconLayerData(
             const std::shared_ptr<const MapObject>& mapObject,
             const MapStyleEvaluationResult& evaluationResult,
@@ -120,6 +143,11 @@ namespace OsmAnd
         void applyTo(MapStyleEvaluator& evaluator) const;
         void applyTo(MapStyleEvaluator &evaluator, const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > &settings) const;
 
+        std::shared_ptr<MapStyleEvaluationResultsCache> getEvaluationResultsCache() const;
+        std::shared_ptr<MapStyleEvaluatorsContext> obtainEvaluatorsContext(
+            const ZoomLevel zoom,
+            const ZoomLevel detailedZoom) const;
+
         std::shared_ptr<const LayeredIconData> getLayeredIconData(
             const QString& tag,
             const QString& value,
@@ -133,6 +161,8 @@ namespace OsmAnd
         bool obtainIcon(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
         bool obtainMapIcon(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
         bool obtainShaderOrShield(const QString& name, const float scale, sk_sp<const SkImage>& outIcon) const;
+        bool obtainPathEffect(const QString& encodedPathEffect, sk_sp<SkPathEffect>& outPathEffect) const;
+        bool obtainImageShader(const QString& name, sk_sp<SkShader>& outShader) const;
 
         ColorARGB getDefaultBackgroundColor(const ZoomLevel zoom) const;
         void obtainShadowOptions(const ZoomLevel zoom, ShadowMode& mode, ColorARGB& color) const;
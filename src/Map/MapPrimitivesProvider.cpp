@@ -43,6 +43,15 @@ bool OsmAnd::MapPrimitivesProvider::obtainTiledPrimitives(
     return _p->obtainTiledPrimitives(request, outTiledPrimitives, metric);
 }
 
+bool OsmAnd::MapPrimitivesProvider::obtainMetatilePrimitives(
+    const Request& request,
+    const unsigned int metatileSize,
+    std::shared_ptr<Data>& outMetatilePrimitives,
+    MapPrimitivesProvider_Metrics::Metric_obtainData* metric /*= nullptr*/)
+{
+    return _p->obtainMetatilePrimitives(request, metatileSize, outMetatilePrimitives, metric);
+}
+
 QList<std::shared_ptr<const OsmAnd::MapObject>> OsmAnd::MapPrimitivesProvider::retreivePolygons(PointI point, ZoomLevel zoom)
 {
     return _p->retreivePolygons(point, zoom);
@@ -1,6 +1,11 @@
 #include "MapPrimitivesProvider_P.h"
 #include "MapPrimitivesProvider.h"
 
+#include "QtCommon.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QSet>
+#include "restore_internal_warnings.h"
+
 #include "IMapObjectsProvider.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
@@ -328,6 +333,113 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainTiledPrimitives(
     return true;
 }
 
+bool OsmAnd::MapPrimitivesProvider_P::obtainMetatilePrimitives(
+    const MapPrimitivesProvider::Request& request,
+    const unsigned int metatileSize,
+    std::shared_ptr<MapPrimitivesProvider::Data>& outMetatilePrimitives,
+    MapPrimitivesProvider_Metrics::Metric_obtainData* const metric)
+{
+    const auto& queryController = request.queryController;
+
+    if (queryController->isAborted())
+        return false;
+
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    // Collect map objects of all tiles, objects that cross tiles borders are shared by them
+    QList< std::shared_ptr<const MapObject> > mapObjects;
+    QSet<const MapObject*> collectedMapObjects;
+    auto surfaceType = MapSurfaceType::Undefined;
+    bool hasData = false;
+    for (auto y = 0u; y < metatileSize; y++)
+    {
+        for (auto x = 0u; x < metatileSize; x++)
+        {
+            MapPrimitivesProvider::Request tileRequest(request);
+            tileRequest.tileId = TileId::fromXY(request.tileId.x + x, request.tileId.y + y);
+
+            std::shared_ptr<IMapObjectsProvider::Data> dataTile;
+            std::shared_ptr<Metric> submetric;
+            owner->mapObjectsProvider->obtainTiledMapObjects(
+                tileRequest,
+                dataTile,
+                metric ? &submetric : nullptr);
+            if (metric && submetric)
+                metric->addSubmetric(submetric);
+
+            if (queryController->isAborted())
+                return false;
+
+            if (!dataTile)
+                continue;
+            hasData = true;
+
+            if (surfaceType == MapSurfaceType::Undefined)
+                surfaceType = dataTile->tileSurfaceType;
+            else if (dataTile->tileSurfaceType != MapSurfaceType::Undefined && dataTile->tileSurfaceType != surfaceType)
+                surfaceType = MapSurfaceType::Mixed;
+
+            for (const auto& mapObject : constOf(dataTile->mapObjects))
+            {
+                if (!collectedMapObjects.contains(mapObject.get()))
+                {
+                    collectedMapObjects.insert(mapObject.get());
+                    mapObjects.push_back(mapObject);
+                }
+            }
+        }
+    }
+
+    if (!hasData)
+    {
+        outMetatilePrimitives.reset();
+        return true;
+    }
+
+    const auto lastTileId = TileId::fromXY(request.tileId.x + metatileSize - 1, request.tileId.y + metatileSize - 1);
+    const auto firstTileBBox31 = Utilities::tileBoundingBox31(request.tileId, request.zoom);
+    const auto lastTileBBox31 = Utilities::tileBoundingBox31(lastTileId, request.zoom);
+    AreaI metatileBBox31;
+    metatileBBox31.top() = firstTileBBox31.top();
+    metatileBBox31.left() = firstTileBBox31.left();
+    metatileBBox31.bottom() = lastTileBBox31.bottom();
+    metatileBBox31.right() = lastTileBBox31.right();
+
+    const auto primitivisedObjects = owner->primitiviser->primitiviseWithSurface(
+        metatileBBox31,
+        PointI(owner->tileSize * metatileSize, owner->tileSize * metatileSize),
+        request.zoom,
+        request.detailedZoom != InvalidZoomLevel ? request.detailedZoom : request.zoom,
+        request.tileId,
+        request.visibleArea31,
+        request.areaTime,
+        surfaceType,
+        mapObjects,
+        nullptr,
+        queryController,
+        metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>().get() : nullptr);
+
+    if (queryController->isAborted())
+        return false;
+
+    const std::shared_ptr<IMapObjectsProvider::Data> mapObjectsData(new IMapObjectsProvider::Data(
+        request.tileId,
+        request.zoom,
+        surfaceType,
+        mapObjects));
+    outMetatilePrimitives.reset(new MapPrimitivesProvider::Data(
+        request.tileId,
+        request.zoom,
+        request.detailedZoom != InvalidZoomLevel ? request.detailedZoom : request.zoom,
+        mapObjectsData,
+        primitivisedObjects));
+
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+
+    return true;
+}
+
 OsmAnd::MapPrimitivesProvider_P::RetainableCacheMetadata::RetainableCacheMetadata(
     const std::shared_ptr<TileEntry>& tileEntry,
     const std::shared_ptr<const IMapDataProvider::RetainableCacheMetadata>& binaryMapRetainableCacheMetadata_)
@@ -91,6 +91,11 @@ namespace OsmAnd
             const MapPrimitivesProvider::Request& request,
             std::shared_ptr<MapPrimitivesProvider::Data>& outTiledPrimitives,
             MapPrimitivesProvider_Metrics::Metric_obtainData* const metric_);
+        bool obtainMetatilePrimitives(
+            const MapPrimitivesProvider::Request& request,
+            const unsigned int metatileSize,
+            std::shared_ptr<MapPrimitivesProvider::Data>& outMetatilePrimitives,
+            MapPrimitivesProvider_Metrics::Metric_obtainData* const metric);
         QList<std::shared_ptr<const OsmAnd::MapObject>> retreivePolygons(PointI point, ZoomLevel zoom);
 
     friend class OsmAnd::MapPrimitivesProvider;
@@ -8,6 +8,11 @@
 #include <memory>
 
 #include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include "restore_internal_warnings.h"
 #include "QtCommon.h"
 
 #include "Nullable.h"
@@ -23,8 +28,10 @@
 #include "Utilities.h"
 #include "QKeyValueIterator.h"
 #include "QCachingIterator.h"
+#include "QRunnableFunctor.h"
 #include "Logging.h"
 #include "multipolygons.h"
+#include "RoadsDensityFilter.h"
 
 //#define OSMAND_VERBOSE_MAP_PRIMITIVISER 1
 #if !defined(OSMAND_VERBOSE_MAP_PRIMITIVISER)
@@ -45,6 +52,7 @@ OsmAnd::MapPrimitiviser_P::MapPrimitiviser_P(MapPrimitiviser* const owner_)
 
 OsmAnd::MapPrimitiviser_P::~MapPrimitiviser_P()
 {
+    _threadPool.waitForDone();
 }
 
 std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimitiviser_P::primitiviseAllMapObjects(
@@ -93,7 +101,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, zoom, &_threadPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -119,6 +127,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     if (queryController && queryController->isAborted())
         return nullptr;
 
+    // Merge shared primitives groups that other threads were producing meanwhile
+    mergePendingSharedPrimitivesGroups(context, primitivisedObjects, metric);
+
     // Sort and filter primitives
     const Stopwatch sortAndFilterPrimitivesStopwatch(metric != nullptr);
     sortAndFilterPrimitives(context, primitivisedObjects, metric);
@@ -156,7 +167,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     MapPrimitiviser_Metrics::Metric_primitiviseWithSurface* const metric)
 {
     const Stopwatch totalStopwatch(metric != nullptr);
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, detailedZoom, &_threadPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -271,15 +282,23 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
             getWidenArea(area31, zoom),
             zoom,
             detailedmapCoastlineObjects,
-            polygonizedCoastlineObjects);
+            polygonizedCoastlineObjects,
+            &_coastlinesPolygonizationCache);
         fillEntireArea = !coastlinesWereAdded;
         
         if (!coastlinesWereAdded)
         {
             //detect if broken coastline inside area31 (tile bbox)
-            for (auto obj : detailedmapCoastlineObjects)
+            for (const auto& obj : constOf(detailedmapCoastlineObjects))
             {
-                for (auto point : obj->points31)
+                // Skip coastlines which bbox is known and is outside of tile. Geometry is summarized only for
+                // objects decoded by map section reader, which sets bbox of all points before
+                if (obj->isGeometrySummaryComputed && !obj->bbox31.intersects(area31))
+                {
+                    continue;
+                }
+
+                for (const auto& point : constOf(obj->points31))
                 {
                     if (area31.contains(point))
                     {
@@ -314,7 +333,8 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
             area31,
             zoom,
             basemapCoastlineObjects,
-            polygonizedCoastlineObjects);
+            polygonizedCoastlineObjects,
+            &_coastlinesPolygonizationCache);
         fillEntireArea = !coastlinesWereAdded && fillEntireArea;
     }
 
@@ -342,7 +362,8 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
                 bboxZoom13,
                 ZoomLevel::ZoomLevel13,
                 extraCoastlineObjects,
-                polygonizedCoastlines);
+                polygonizedCoastlines,
+                &_coastlinesPolygonizationCache);
             surfaceTypeOverscaled = determineSurfaceType(area31, polygonizedCoastlines);
             if (surfaceTypeOverscaled != MapSurfaceType::Undefined)
             {
@@ -361,7 +382,8 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
                 bboxBasemap,
                 basemapZoom,
                 basemapCoastlineObjects,
-                polygonizedCoastlines);
+                polygonizedCoastlines,
+                &_coastlinesPolygonizationCache);
             surfaceTypeBasemap = determineSurfaceType(area31, polygonizedCoastlines);
             if (surfaceTypeBasemap != MapSurfaceType::Undefined)
             {
@@ -491,6 +513,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     if (queryController && queryController->isAborted())
         return nullptr;
 
+    // Merge shared primitives groups that other threads were producing meanwhile
+    mergePendingSharedPrimitivesGroups(context, primitivisedObjects, metric);
+
     // Sort and filter primitives
     const Stopwatch sortAndFilterPrimitivesStopwatch(metric != nullptr);
     sortAndFilterPrimitives(context, primitivisedObjects, metric);
@@ -524,7 +549,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, zoom, &_threadPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache, 
@@ -598,6 +623,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     if (queryController && queryController->isAborted())
         return nullptr;
 
+    // Merge shared primitives groups that other threads were producing meanwhile
+    mergePendingSharedPrimitivesGroups(context, primitivisedObjects, metric);
+
     // Sort and filter primitives
     const Stopwatch sortAndFilterPrimitivesStopwatch(metric != nullptr);
     sortAndFilterPrimitives(context, primitivisedObjects, metric);
@@ -638,34 +666,270 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
 
     const Stopwatch obtainPrimitivesStopwatch(metric != nullptr);
 
-    // Initialize shared settings for order evaluation
-    MapStyleEvaluator orderEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
-    env->applyTo(orderEvaluator);
-    orderEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
-    orderEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
-
-    // Initialize shared settings for polygon evaluation
-    MapStyleEvaluator polygonEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
-    env->applyTo(polygonEvaluator);
-    polygonEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
-    polygonEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
-
-    // Initialize shared settings for polyline evaluation
-    MapStyleEvaluator polylineEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
-    env->applyTo(polylineEvaluator);
-    polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, detailedZoom);
-    polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, detailedZoom);
-
-    // Initialize shared settings for point evaluation
-    MapStyleEvaluator pointEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
-    env->applyTo(pointEvaluator);
-    pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
-    pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
+    // Evaluators of context already have settings and zoom applied
+    assert(context.evaluators->zoom == zoom && context.evaluators->detailedZoom == detailedZoom);
 
     const auto pSharedPrimitivesGroups = cache ? cache->getPrimitivesGroupsPtr(zoom) : nullptr;
-    QList< proper::shared_future< std::shared_ptr<const PrimitivesGroup> > > futureSharedPrimitivesGroups;
-    for (const auto& mapObject : constOf(source))
+
+    const auto sourceSize = source.size();
+    const auto chunksCount = (context.threadPool && sourceSize >= ParallelPrimitivisationThreshold)
+        ? (sourceSize + MapObjectsPerChunk - 1) / MapObjectsPerChunk
+        : 1;
+    QVector<PrimitivesChunk> chunks(chunksCount);
+    if (chunksCount == 1)
+    {
+        obtainPrimitivesChunk(
+            context,
+            *context.evaluators,
+            detailScaleFactor,
+            primitivisedObjects,
+            source,
+            0,
+            sourceSize,
+            evaluationResult,
+            pSharedPrimitivesGroups,
+            chunks[0],
+            queryController,
+            metric);
+    }
+    else
+    {
+        const Stopwatch concurrentPrimitivisationStopwatch(metric != nullptr);
+
+        // Calling thread and helpers take chunks in order until none is left, so that idle threads
+        // pick up work of busy ones. Each thread uses own evaluators and evaluation result.
+        QAtomicInt nextChunkIndex(0);
+        const auto processChunks =
+            [&context, &chunks, &nextChunkIndex, &source, sourceSize, chunksCount, detailScaleFactor,
+                &primitivisedObjects, pSharedPrimitivesGroups, &queryController]
+            (MapStyleEvaluatorsContext& evaluators,
+                MapStyleEvaluationResult& evaluationResult,
+                MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+            {
+                for (auto chunkIndex = nextChunkIndex.fetchAndAddOrdered(1);
+                    chunkIndex < chunksCount;
+                    chunkIndex = nextChunkIndex.fetchAndAddOrdered(1))
+                {
+                    const auto chunkBegin = chunkIndex * MapObjectsPerChunk;
+                    obtainPrimitivesChunk(
+                        context,
+                        evaluators,
+                        detailScaleFactor,
+                        primitivisedObjects,
+                        source,
+                        chunkBegin,
+                        qMin(chunkBegin + MapObjectsPerChunk, sourceSize),
+                        evaluationResult,
+                        pSharedPrimitivesGroups,
+                        chunks[chunkIndex],
+                        queryController,
+                        metric);
+                }
+            };
+
+        // Helpers that start after calling thread ran out of chunks have nothing to do, so they return at once
+        // and only started ones are waited for
+        struct HelpersState
+        {
+            HelpersState()
+                : closed(false)
+                , runningCount(0)
+            {
+            }
+
+            QMutex mutex;
+            QWaitCondition finishedCondition;
+            bool closed;
+            int runningCount;
+        };
+        const std::shared_ptr<HelpersState> helpersState(new HelpersState());
+
+        const auto helpersCount = qMin(chunksCount - 1, context.threadPool->maxThreadCount());
+        QList< std::shared_ptr<MapPrimitiviser_Metrics::Metric_primitivise> > helpersMetrics;
+        for (auto helperIndex = 0; helperIndex < helpersCount; helperIndex++)
+        {
+            // Only fields of Metric_primitivise are used, that metric itself can't be created
+            std::shared_ptr<MapPrimitiviser_Metrics::Metric_primitivise> helperMetric;
+            if (metric)
+            {
+                helperMetric.reset(new MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects());
+                helpersMetrics.push_back(helperMetric);
+            }
+
+            // Context, environment and chunks processing are locals of this frame, captured by reference.
+            // They are used only by helpers counted as running, and this frame is kept until none is.
+            context.threadPool->start(new QRunnableFunctor(
+                [&context, &env, &processChunks, helpersState, detailedZoom, helperMetric]
+                (const QRunnableFunctor* const runnable)
+                {
+                    {
+                        QMutexLocker scopedLocker(&helpersState->mutex);
+                        if (helpersState->closed)
+                            return;
+                        helpersState->runningCount++;
+                    }
+
+                    {
+                        // Evaluators from pool that was replaced meanwhile have other settings applied,
+                        // so in that case chunks are left to other threads
+                        const auto evaluators = env->obtainEvaluatorsContext(context.zoom, detailedZoom);
+                        if (evaluators->evaluationResultsCache == context.evaluators->evaluationResultsCache)
+                        {
+                            MapStyleEvaluationResult evaluationResult(env->mapStyle->getValueDefinitionsCount());
+                            processChunks(*evaluators, evaluationResult, helperMetric.get());
+                        }
+                    }
+
+                    QMutexLocker scopedLocker(&helpersState->mutex);
+                    helpersState->runningCount--;
+                    helpersState->finishedCondition.wakeAll();
+                }));
+        }
+        processChunks(*context.evaluators, evaluationResult, metric);
+        {
+            QMutexLocker scopedLocker(&helpersState->mutex);
+            helpersState->closed = true;
+            while (helpersState->runningCount > 0)
+                helpersState->finishedCondition.wait(&helpersState->mutex);
+        }
+
+        if (metric)
+        {
+            for (const auto& helperMetric : constOf(helpersMetrics))
+            {
+#define ACCUMULATE_METRIC_FIELD(type, name, measurement) metric->name += helperMetric->name
+                OsmAnd__MapPrimitiviser_Metrics__Metric_primitivise__FIELDS(ACCUMULATE_METRIC_FIELD);
+#undef ACCUMULATE_METRIC_FIELD
+            }
+
+            metric->elapsedTimeForConcurrentPrimitivisation += concurrentPrimitivisationStopwatch.elapsed();
+            metric->concurrentlyPrimitivisedChunks += chunksCount;
+        }
+    }
+
+    if (queryController && queryController->isAborted())
+        return;
+
+    // Merge chunks in order of source map objects. Shared groups promised by other threads are merged
+    // once all map objects of tile are done, so that tile doesn't wait for them here
+    auto& pendingSharedPrimitivesGroups = *context.pendingSharedPrimitivesGroups;
+    for (const auto& chunk : constOf(chunks))
+    {
+        primitivisedObjects->polygons.append(chunk.polygons);
+        primitivisedObjects->polylines.append(chunk.polylines);
+        primitivisedObjects->points.append(chunk.points);
+        primitivisedObjects->primitivesGroups.append(chunk.primitivesGroups);
+        pendingSharedPrimitivesGroups.futures.append(chunk.futureSharedPrimitivesGroups);
+    }
+
+    if (metric)
+        metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
+}
+
+template<typename GROUP>
+void OsmAnd::MapPrimitiviser_P::subscribeToPendingSharedGroup(
+    SharedResourcesContainer<MapObject::SharingKey, const GROUP>& sharedGroups,
+    const MapObject::SharingKey sharingKey,
+    const proper::shared_future< std::shared_ptr<const GROUP> >& futureGroup,
+    const std::shared_ptr< PendingSharedGroups<GROUP> >& pendingSharedGroups)
+{
+    // Tile may be gone by the time group is available, so it's not kept alive by producer
+    const std::weak_ptr< PendingSharedGroups<GROUP> > weakPendingSharedGroups(pendingSharedGroups);
+    const auto subscribed = sharedGroups.subscribeToPromise(sharingKey, futureGroup,
+        [weakPendingSharedGroups]
+        ()
+        {
+            if (const auto pendingSharedGroups = weakPendingSharedGroups.lock())
+                pendingSharedGroups->availableSemaphore.release();
+        });
+
+    // Promise of this future was settled right after future was obtained
+    if (!subscribed)
+        pendingSharedGroups->availableSemaphore.release();
+}
+
+template<typename GROUP>
+unsigned int OsmAnd::MapPrimitiviser_P::waitForPendingSharedGroups(
+    PendingSharedGroups<GROUP>& pendingSharedGroups,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    const auto pendingCount = pendingSharedGroups.futures.size();
+    const auto lateCount = qMax(pendingCount - pendingSharedGroups.availableSemaphore.available(), 0);
+    if (lateCount == 0)
+    {
+        pendingSharedGroups.availableSemaphore.acquire(pendingCount);
+        return 0;
+    }
+
+    const Stopwatch blockedStopwatch(metric != nullptr);
+    if (!pendingSharedGroups.availableSemaphore.tryAcquire(pendingCount, PendingSharedGroupsTimeout))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "%d of %d shared groups were not available in %d ms",
+            pendingCount - pendingSharedGroups.availableSemaphore.available(),
+            pendingCount,
+            PendingSharedGroupsTimeout);
+    }
+    if (metric)
+        metric->elapsedTimeBlockedOnSharedGroups += blockedStopwatch.elapsed();
+
+    return lateCount;
+}
+
+void OsmAnd::MapPrimitiviser_P::mergePendingSharedPrimitivesGroups(
+    const Context& context,
+    const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    auto& pendingSharedPrimitivesGroups = *context.pendingSharedPrimitivesGroups;
+    if (pendingSharedPrimitivesGroups.futures.isEmpty())
+        return;
+
+    const Stopwatch futureSharedPrimitivesGroupsStopwatch(metric != nullptr);
+
+    const auto lateCount = waitForPendingSharedGroups(pendingSharedPrimitivesGroups, metric);
+    for (const auto& futureSharedGroup : constOf(pendingSharedPrimitivesGroups.futures))
     {
+        // Group that is still not available after timeout is skipped
+        if (futureSharedGroup.wait_for(proper::chrono::seconds(0)) != proper::future_status::ready)
+            continue;
+        auto group = futureSharedGroup.get();
+
+        // Add polygons, polylines and points from group to current context
+        primitivisedObjects->polygons.append(group->polygons);
+        primitivisedObjects->polylines.append(group->polylines);
+        primitivisedObjects->points.append(group->points);
+
+        // Add shared group to current context
+        primitivisedObjects->primitivesGroups.push_back(qMove(group));
+    }
+    pendingSharedPrimitivesGroups.futures.clear();
+
+    if (metric)
+    {
+        metric->elapsedTimeForFutureSharedPrimitivesGroups += futureSharedPrimitivesGroupsStopwatch.elapsed();
+        metric->lateSharedPrimitivesGroups += lateCount;
+    }
+}
+
+void OsmAnd::MapPrimitiviser_P::obtainPrimitivesChunk(
+    const Context& context,
+    MapStyleEvaluatorsContext& evaluators,
+    const float detailScaleFactor,
+    const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+    const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+    const int sourceBegin,
+    const int sourceEnd,
+    MapStyleEvaluationResult& evaluationResult,
+    Cache::SharedPrimitivesGroupsContainer* const pSharedPrimitivesGroups,
+    PrimitivesChunk& outChunk,
+    const std::shared_ptr<const IQueryController>& queryController,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    for (auto sourceIndex = sourceBegin; sourceIndex < sourceEnd; sourceIndex++)
+    {
+        const auto& mapObject = source[sourceIndex];
+
         //////////////////////////////////////////////////////////////////////////
         //if (mapObject->toString().contains("1333827773"))
         //{
@@ -690,17 +954,22 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
             {
                 if (group)
                 {
-                    // Add polygons, polylines and points from group to current context
-                    primitivisedObjects->polygons.append(group->polygons);
-                    primitivisedObjects->polylines.append(group->polylines);
-                    primitivisedObjects->points.append(group->points);
+                    // Add polygons, polylines and points from group to current chunk
+                    outChunk.polygons.append(group->polygons);
+                    outChunk.polylines.append(group->polylines);
+                    outChunk.points.append(group->points);
 
-                    // Add shared group to current context
-                    primitivisedObjects->primitivesGroups.push_back(qMove(group));
+                    // Add shared group to current chunk
+                    outChunk.primitivesGroups.push_back(qMove(group));
                 }
                 else
                 {
-                    futureSharedPrimitivesGroups.push_back(qMove(futureGroup));
+                    subscribeToPendingSharedGroup(
+                        *pSharedPrimitivesGroups,
+                        sharingKey,
+                        futureGroup,
+                        context.pendingSharedPrimitivesGroups);
+                    outChunk.futureSharedPrimitivesGroups.push_back(qMove(futureGroup));
                 }
 
                 continue;
@@ -711,14 +980,16 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
         const Stopwatch obtainPrimitivesGroupStopwatch(metric != nullptr);
         const auto group = obtainPrimitivesGroup(
             context,
+            evaluators.detailedZoom,
             detailScaleFactor,
             primitivisedObjects,
             mapObject,
             evaluationResult,
-            orderEvaluator,
-            polygonEvaluator,
-            polylineEvaluator,
-            pointEvaluator,
+            evaluators.orderEvaluator,
+            evaluators.polygonEvaluator,
+            evaluators.polylineEvaluator,
+            evaluators.pointEvaluator,
+            evaluators.evaluationResultsCache.get(),
             metric);
         if (metric)
             metric->elapsedTimeForObtainingPrimitivesGroups += obtainPrimitivesGroupStopwatch.elapsed();
@@ -727,53 +998,19 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
         if (pSharedPrimitivesGroups && isShareable)
             pSharedPrimitivesGroups->fulfilPromiseAndReference(sharingKey, group);
 
-        // Add polygons, polylines and points from group to current context
-        primitivisedObjects->polygons.append(group->polygons);
-        primitivisedObjects->polylines.append(group->polylines);
-        primitivisedObjects->points.append(group->points);
+        // Add polygons, polylines and points from group to current chunk
+        outChunk.polygons.append(group->polygons);
+        outChunk.polylines.append(group->polylines);
+        outChunk.points.append(group->points);
 
         // Empty groups are also inserted, to indicate that they are empty
-        primitivisedObjects->primitivesGroups.push_back(qMove(group));
-    }
-
-    int failCounter = 0;
-    // Wait for future primitives groups
-    Stopwatch futureSharedPrimitivesGroupsStopwatch(metric != nullptr);
-    for (auto& futureSharedGroup : futureSharedPrimitivesGroups)
-    {
-        auto timeout = proper::chrono::system_clock::now() + proper::chrono::seconds(3);
-        if (proper::future_status::ready == futureSharedGroup.wait_until(timeout))
-        {
-            auto group = futureSharedGroup.get();
-
-            // Add polygons, polylines and points from group to current context
-            primitivisedObjects->polygons.append(group->polygons);
-            primitivisedObjects->polylines.append(group->polylines);
-            primitivisedObjects->points.append(group->points);
-
-            // Add shared group to current context
-            primitivisedObjects->primitivesGroups.push_back(qMove(group));
-        }
-        else
-        {
-            failCounter++;
-            LogPrintf(LogSeverityLevel::Error, "Get futureSharedGroup timeout exceed = %d", failCounter);
-        }
-        if (failCounter >= 3)
-        {
-            LogPrintf(LogSeverityLevel::Error, "Get futureSharedGroup timeout exceed");
-            break;
-        }
+        outChunk.primitivesGroups.push_back(qMove(group));
     }
-    if (metric)
-        metric->elapsedTimeForFutureSharedPrimitivesGroups += futureSharedPrimitivesGroupsStopwatch.elapsed();
-
-    if (metric)
-        metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
 }
 
 std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPrimitiviser_P::obtainPrimitivesGroup(
     const Context& context,
+    const ZoomLevel detailedZoom,
     const float detailScaleFactor,    
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
     const std::shared_ptr<const MapObject>& mapObject,
@@ -782,9 +1019,11 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     MapStyleEvaluator& polygonEvaluator,
     MapStyleEvaluator& polylineEvaluator,
     MapStyleEvaluator& pointEvaluator,
+    MapStyleEvaluationResultsCache* const evaluationResultsCache,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
     const auto& env = context.env;
+    const auto zoom = primitivisedObjects->zoom;
 
     bool ok;
 
@@ -804,10 +1043,12 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
     // Setup mapObject-specific input data
     const auto layerType = mapObject->getLayerType();
+    const auto isPoint = mapObject->points31.size() == 1;
+    const auto isCycle = mapObject->isClosedFigure();
     orderEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_LAYER, static_cast<int>(layerType));
     orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_AREA, mapObject->isArea);
-    orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_POINT, mapObject->points31.size() == 1);
-    orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_CYCLE, mapObject->isClosedFigure());
+    orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_POINT, isPoint);
+    orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_CYCLE, isCycle);
     polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_LAYER, static_cast<int>(layerType));
 
     const auto& decRules = mapObject->attributeMapping->decodeMap;
@@ -845,8 +1086,12 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
         orderEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_TAG, tagStringId);
         orderEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, valueStringId);
 
-        evaluationResult.clear();
-        ok = orderEvaluator.evaluate(mapObject, MapStyleRulesetType::Order, &evaluationResult);
+        MapStyleEvaluationResultsCache::Key orderKey(MapStyleRulesetType::Order, zoom, tagStringId, valueStringId);
+        orderKey.layer = static_cast<int>(layerType);
+        orderKey.isArea = mapObject->isArea;
+        orderKey.isPoint = isPoint;
+        orderKey.isCycle = isCycle;
+        ok = evaluate(orderEvaluator, mapObject, orderKey, evaluationResult, evaluationResultsCache, metric);
 
         if (metric)
         {
@@ -958,7 +1203,11 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                 ignorePolygonAsPointArea);
 
             if (doubledPolygonArea31 < 0.0)
-                doubledPolygonArea31 = Utilities::doubledPolygonArea(mapObject->points31);
+            {
+                doubledPolygonArea31 = mapObject->isGeometrySummaryComputed
+                    ? mapObject->doubledArea31
+                    : Utilities::doubledPolygonArea(mapObject->points31);
+            }
 
             if ((!ignorePolygonArea || !ignorePolygonAsPointArea) && !rejectByArea.isSet())
             {
@@ -983,8 +1232,12 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                 polygonEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, valueStringId);
 
                 // Evaluate style for this primitive to check if it passes (for Polygon)
-                evaluationResult.clear();
-                ok = polygonEvaluator.evaluate(mapObject, MapStyleRulesetType::Polygon, &evaluationResult);
+                const MapStyleEvaluationResultsCache::Key polygonKey(
+                    MapStyleRulesetType::Polygon,
+                    zoom,
+                    tagStringId,
+                    valueStringId);
+                ok = evaluate(polygonEvaluator, mapObject, polygonKey, evaluationResult, evaluationResultsCache, metric);
 
                 if (metric)
                 {
@@ -1046,8 +1299,9 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                 pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_TEXT_LENGTH, nativeCaptionLength);
 
                 // Evaluate Point rules
-                evaluationResult.clear();
-                const auto hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+                MapStyleEvaluationResultsCache::Key pointKey(MapStyleRulesetType::Point, zoom, tagStringId, valueStringId);
+                pointKey.textLength = nativeCaptionLength;
+                const auto hasIcon = evaluate(pointEvaluator, mapObject, pointKey, evaluationResult, evaluationResultsCache, metric);
 
                 // Update metric
                 if (metric)
@@ -1116,8 +1370,13 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             polylineEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, valueStringId);
 
             // Evaluate style for this primitive to check if it passes
-            evaluationResult.clear();
-            ok = polylineEvaluator.evaluate(mapObject, MapStyleRulesetType::Polyline, &evaluationResult);
+            MapStyleEvaluationResultsCache::Key polylineKey(
+                MapStyleRulesetType::Polyline,
+                detailedZoom,
+                tagStringId,
+                valueStringId);
+            polylineKey.layer = static_cast<int>(layerType);
+            ok = evaluate(polylineEvaluator, mapObject, polylineKey, evaluationResult, evaluationResultsCache, metric);
 
             if (metric)
             {
@@ -1187,8 +1446,9 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_TEXT_LENGTH, nativeCaptionLength);
 
             // Evaluate Point rules
-            evaluationResult.clear();
-            const bool hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+            MapStyleEvaluationResultsCache::Key pointKey(MapStyleRulesetType::Point, zoom, tagStringId, valueStringId);
+            pointKey.textLength = nativeCaptionLength;
+            const bool hasIcon = evaluate(pointEvaluator, mapObject, pointKey, evaluationResult, evaluationResultsCache, metric);
 
             // Update metric
             if (metric)
@@ -1257,6 +1517,45 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     return group;
 }
 
+bool OsmAnd::MapPrimitiviser_P::evaluate(
+    MapStyleEvaluator& evaluator,
+    const std::shared_ptr<const MapObject>& mapObject,
+    const MapStyleEvaluationResultsCache::Key& key,
+    MapStyleEvaluationResult& evaluationResult,
+    MapStyleEvaluationResultsCache* const evaluationResultsCache,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    evaluationResult.clear();
+
+    auto lookupResult = MapStyleEvaluationResultsCache::LookupResult::Uncacheable;
+    if (evaluationResultsCache)
+    {
+        bool success = false;
+        lookupResult = evaluationResultsCache->obtain(key, success, evaluationResult);
+        if (lookupResult == MapStyleEvaluationResultsCache::LookupResult::Hit)
+        {
+            if (metric)
+                metric->evaluationCacheHits++;
+
+            return success;
+        }
+    }
+
+    const auto success = evaluator.evaluate(mapObject, key.rulesetType, &evaluationResult);
+
+    if (lookupResult == MapStyleEvaluationResultsCache::LookupResult::Miss)
+    {
+        evaluationResultsCache->insert(key, success, evaluationResult);
+
+        if (metric)
+            metric->evaluationCacheMisses++;
+    }
+    else if (metric)
+        metric->evaluationCacheBypasses++;
+
+    return success;
+}
+
 void OsmAnd::MapPrimitiviser_P::sortAndFilterPrimitives(
     const Context& context,
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
@@ -1308,52 +1607,47 @@ void OsmAnd::MapPrimitiviser_P::filterOutHighwaysByDensity(
     if (context.roadDensityZoomTile == 0 || context.roadsDensityLimitPerTile == 0)
         return;
 
-    const auto dZ = primitivisedObjects->zoom + context.roadDensityZoomTile;
-    QHash< uint64_t, std::pair<uint32_t, double> > densityMap;
-
-    auto itPolyline = mutableIteratorOf(primitivisedObjects->polylines);
-    itPolyline.toBack();
-    while (itPolyline.hasPrevious())
+    // Find roads, other polylines are accepted
+    const auto& polylines = primitivisedObjects->polylines;
+    QVector<int> roadsPolylinesIndices;
+    QVector< const QVector<PointI>* > roadsPoints31;
+    for (auto polylineIdx = 0, polylinesCount = polylines.size(); polylineIdx < polylinesCount; polylineIdx++)
     {
-        const auto& polyline = itPolyline.previous();
+        const auto& polyline = polylines[polylineIdx];
         const auto& sourceObject = polyline->sourceObject;
 
-        // If polyline is not road, it should be accepted
         const auto pPrimitiveAttribute = sourceObject->resolveAttributeByIndex(polyline->attributeIdIndex);
-        if (!pPrimitiveAttribute)
-            continue;
-        if (pPrimitiveAttribute->tag != QLatin1String("highway"))
+        if (!pPrimitiveAttribute || pPrimitiveAttribute->tag != QLatin1String("highway"))
             continue;
+        roadsPolylinesIndices.push_back(polylineIdx);
+        roadsPoints31.push_back(&sourceObject->points31);
+    }
+    if (roadsPoints31.isEmpty())
+        return;
 
-        auto accept = false;
-        uint64_t prevId = 0;
-        const auto pointsCount = sourceObject->points31.size();
-        auto pPoint = sourceObject->points31.constData();
-        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
-        {
-            auto x = pPoint->x >> (MaxZoomLevel - dZ);
-            auto y = pPoint->y >> (MaxZoomLevel - dZ);
-            uint64_t id = (static_cast<uint64_t>(x) << dZ) | y;
-            if (prevId != id)
-            {
-                prevId = id;
+    const auto isRoadRejected = RoadsDensityFilter::findRejectedRoads(
+        roadsPoints31,
+        primitivisedObjects->zoom + context.roadDensityZoomTile,
+        context.roadsDensityLimitPerTile);
+    QVector<bool> isRejected(polylines.size(), false);
+    for (auto roadIdx = 0, roadsCount = roadsPolylinesIndices.size(); roadIdx < roadsCount; roadIdx++)
+    {
+        if (!isRoadRejected[roadIdx])
+            continue;
 
-                auto& mapEntry = densityMap[id];
-                if (mapEntry.first < context.roadsDensityLimitPerTile /*&& p.second > o */)
-                {
-                    accept = true;
-                    mapEntry.first += 1;
-                    mapEntry.second = polyline->zOrder;
-                }
-            }
-        }
-        if (!accept)
-        {
-            if (metric)
-                metric->polylineRejectedByDensity++;
+        if (metric)
+            metric->polylineRejectedByDensity++;
+        isRejected[roadsPolylinesIndices[roadIdx]] = true;
+    }
 
+    // Remove rejected roads, keeping order of remaining polylines
+    auto polylineIdx = 0;
+    auto itPolyline = mutableIteratorOf(primitivisedObjects->polylines);
+    while (itPolyline.hasNext())
+    {
+        itPolyline.next();
+        if (isRejected[polylineIdx++])
             itPolyline.remove();
-        }
     }
 }
 
@@ -1366,23 +1660,14 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
     const std::shared_ptr<const IQueryController>& queryController,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
-    const auto& env = context.env;
-    const auto zoom = primitivisedObjects->zoom;
-
-    // Initialize shared settings for text evaluation
-    MapStyleEvaluator textEvaluator(env->mapStyle, env->displayDensityFactor * env->symbolsScaleFactor);
-    env->applyTo(textEvaluator);
-    textEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
-    textEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
-
-    // Local cache to speed up textOrder evaluation (based on name tag only!)
-    QHash<QString, int> textOrderCache;
+    // Text evaluator of context already has settings and zoom applied
+    auto& textEvaluator = context.evaluators->textEvaluator;
 
     //NOTE: Em, I'm not sure this is still true
     //NOTE: Since 2 tiles with same MapObject may have different set of polylines, generated from it,
     //NOTE: then set of symbols also should differ, but it won't.
     const auto pSharedSymbolGroups = cache ? cache->getSymbolsGroupsPtr(primitivisedObjects->zoom) : nullptr;
-    QList< proper::shared_future< std::shared_ptr<const SymbolsGroup> > > futureSharedSymbolGroups;
+    const std::shared_ptr<PendingSharedSymbolsGroups> pendingSharedSymbolsGroups(new PendingSharedSymbolsGroups());
     for (const auto& primitivesGroup : constOf(primitivisedObjects->primitivesGroups))
     {
         if (queryController && queryController->isAborted())
@@ -1417,7 +1702,8 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
                 }
                 else
                 {
-                    futureSharedSymbolGroups.push_back(qMove(futureGroup));
+                    subscribeToPendingSharedGroup(*pSharedSymbolGroups, sharingKey, futureGroup, pendingSharedSymbolsGroups);
+                    pendingSharedSymbolsGroups->futures.push_back(qMove(futureGroup));
                 }
 
                 continue;
@@ -1441,7 +1727,6 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
             primitivesGroup->polygons,
             evaluationResult,
             textEvaluator,
-            textOrderCache,
             group->symbols,
             queryController,
             metric);
@@ -1453,7 +1738,6 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
             primitivesGroup->polylines,
             evaluationResult,
             textEvaluator,
-            textOrderCache,
             group->symbols,
             queryController,
             metric);
@@ -1465,7 +1749,6 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
             primitivesGroup->points,
             evaluationResult,
             textEvaluator,
-            textOrderCache,
             group->symbols,
             queryController,
             metric);
@@ -1486,28 +1769,20 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
         primitivisedObjects->symbolsGroups.insert(group->sourceObject, group);
     }
 
-    int failCounter = 0;
-    for (auto& futureGroup : futureSharedSymbolGroups)
+    // Wait only for shared groups that other threads are still producing
+    const auto lateCount = waitForPendingSharedGroups(*pendingSharedSymbolsGroups, metric);
+    if (metric)
+        metric->lateSharedSymbolsGroups += lateCount;
+    for (const auto& futureGroup : constOf(pendingSharedSymbolsGroups->futures))
     {
-        auto timeout = proper::chrono::system_clock::now() + proper::chrono::seconds(3);
-        if (proper::future_status::ready == futureGroup.wait_until(timeout))
-        {
-            const auto group = futureGroup.get();
+        // Group that is still not available after timeout is skipped
+        if (futureGroup.wait_for(proper::chrono::seconds(0)) != proper::future_status::ready)
+            continue;
+        const auto group = futureGroup.get();
 
-            // Add shared group to current context
-            assert(!primitivisedObjects->symbolsGroups.contains(group->sourceObject));
-            primitivisedObjects->symbolsGroups.insert(group->sourceObject, group);
-        }
-        else
-        {
-            failCounter++;
-            LogPrintf(LogSeverityLevel::Error, "Get futureGroup timeout exceed = %d", failCounter);
-        }
-        if (failCounter >= 3)
-        {
-            LogPrintf(LogSeverityLevel::Error, "Get futureGroup timeout exceed");
-            break;
-        }
+        // Add shared group to current context
+        assert(!primitivisedObjects->symbolsGroups.contains(group->sourceObject));
+        primitivisedObjects->symbolsGroups.insert(group->sourceObject, group);
     }
 }
 
@@ -1518,7 +1793,6 @@ void OsmAnd::MapPrimitiviser_P::collectSymbolsFromPrimitives(
     const PrimitivesCollection& primitives,
     MapStyleEvaluationResult& evaluationResult,
     MapStyleEvaluator& textEvaluator,
-    QHash<QString, int>& textOrderCache,
     SymbolsCollection& outSymbols,
     const std::shared_ptr<const IQueryController>& queryController,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
@@ -1547,7 +1821,6 @@ void OsmAnd::MapPrimitiviser_P::collectSymbolsFromPrimitives(
                 primitive,
                 evaluationResult,
                 textEvaluator,
-                textOrderCache,
                 outSymbols,
                 metric);
         }
@@ -1565,7 +1838,6 @@ void OsmAnd::MapPrimitiviser_P::collectSymbolsFromPrimitives(
                     primitive,
                     evaluationResult,
                     textEvaluator,
-                    textOrderCache,
                     outSymbols,
                     metric);
             }
@@ -1579,7 +1851,6 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPolygon(
     const std::shared_ptr<const Primitive>& primitive,
     MapStyleEvaluationResult& evaluationResult,
     MapStyleEvaluator& textEvaluator,
-    QHash<QString, int>& textOrderCache,
     SymbolsCollection& outSymbols,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
@@ -1590,26 +1861,33 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPolygon(
     // assert(primitive->sourceObject->isClosedFigure(true));
 
     // Get center of polygon, since all symbols of polygon are related to it's center
-    PointI64 center;
-    const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    PointI center;
+    if (primitive->sourceObject->isGeometrySummaryComputed)
+        center = primitive->sourceObject->center31;
+    else
     {
-        center.x += pPoint->x;
-        center.y += pPoint->y;
+        PointI64 center_;
+        const auto pointsCount = points31.size();
+        auto pPoint = points31.constData();
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+        {
+            center_.x += pPoint->x;
+            center_.y += pPoint->y;
+        }
+        center_.x /= pointsCount;
+        center_.y /= pointsCount;
+
+        center = Utilities::normalizeCoordinates(center_, ZoomLevel31);
     }
-    center.x /= pointsCount;
-    center.y /= pointsCount;
 
     // Obtain texts for this symbol
     obtainPrimitiveTexts(
         context,
         primitivisedObjects,
         primitive,
-        Utilities::normalizeCoordinates(center, ZoomLevel31),
+        center,
         evaluationResult,
         textEvaluator,
-        textOrderCache,
         outSymbols,
         metric);
 }
@@ -1620,7 +1898,6 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPolyline(
     const std::shared_ptr<const Primitive>& primitive,
     MapStyleEvaluationResult& evaluationResult,
     MapStyleEvaluator& textEvaluator,
-    QHash<QString, int>& textOrderCache,
     SymbolsCollection& outSymbols,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
@@ -1639,7 +1916,6 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPolyline(
         center,
         evaluationResult,
         textEvaluator,
-        textOrderCache,
         outSymbols,
         metric);
 }
@@ -1651,7 +1927,6 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPoint(
     const std::shared_ptr<const Primitive>& primitive,
     MapStyleEvaluationResult& evaluationResult,
     MapStyleEvaluator& textEvaluator,
-    QHash<QString, int>& textOrderCache,
     SymbolsCollection& outSymbols,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
@@ -1681,6 +1956,11 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPoint(
         // Regular point
         center = points31.first();
     }
+    else if (primitive->sourceObject->isGeometrySummaryComputed)
+    {
+        // Point represents center of polygon, which was computed on decoding
+        center = primitive->sourceObject->center31;
+    }
     else
     {
         // Point represents center of polygon
@@ -1724,7 +2004,6 @@ void OsmAnd::MapPrimitiviser_P::obtainSymbolsFromPoint(
         center,
         evaluationResult,
         textEvaluator,
-        textOrderCache,
         outSymbols,
         metric);
 }
@@ -1736,7 +2015,6 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
     const PointI& location,
     MapStyleEvaluationResult& evaluationResult,
     MapStyleEvaluator& textEvaluator,
-    QHash<QString, int>& textOrderCache,
     SymbolsCollection& outSymbols,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
@@ -1759,12 +2037,20 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
     const auto& decodedAttribute = attributeMapping->decodeMap[attributeId];
 
     // Set common evaluator settings
-    textEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-    textEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-    QString tagWithValue = decodedAttribute.tag;
-    tagWithValue.append(QStringLiteral(" = "));
-    tagWithValue.append(decodedAttribute.value);
-    tagWithValue.append(QStringLiteral(", "));
+    const auto resolveStringId =
+        [&env]
+        (const IMapStyle::ValueDefinitionId valueDefId, const QString& string) -> IMapStyle::StringId
+        {
+            MapStyleConstantValue parsedValue;
+            return env->mapStyle->parseValue(string, valueDefId, parsedValue)
+                ? parsedValue.asSimple.asUInt
+                : std::numeric_limits<IMapStyle::StringId>::max();
+        };
+    const auto tagStringId = resolveStringId(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
+    const auto valueStringId = resolveStringId(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
+    textEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_TAG, tagStringId);
+    textEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, valueStringId);
+    const auto evaluationResultsCache = context.evaluators->evaluationResultsCache.get();
 
     // Get captions and their order
     auto captions = mapObject->captions;
@@ -1782,30 +2068,40 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
     const auto citLocalizedNameRuleId = attributeMapping->localizedNameAttributes.constFind(&localeLanguageId);
     if (citLocalizedNameRuleId != attributeMapping->localizedNameAttributes.cend())
         localizedNameRuleId = *citLocalizedNameRuleId;
-    
-    // sort captionsOrder by textOrder property
-    QHash<uint32_t, int> textOrderMap;
 
-    int textOrder;
+    // Text style depends on tag of caption unless it's a 'name[:*]'-attribute, and on length of caption
+    const auto setupCaptionInputs =
+        [&context, &env, &attributeMapping, &textEvaluator, &resolveStringId, &captions, localizedNameRuleId,
+            tagStringId, valueStringId]
+        (const uint32_t captionAttributeId) -> MapStyleEvaluationResultsCache::Key
+        {
+            QString captionAttributeTag;
+            if (captionAttributeId != attributeMapping->nativeNameAttributeId && captionAttributeId != localizedNameRuleId)
+                captionAttributeTag = attributeMapping->decodeMap[captionAttributeId].tag;
+            const auto nameTagStringId =
+                resolveStringId(env->styleBuiltinValueDefs->id_INPUT_NAME_TAG, captionAttributeTag);
+            const auto textLength = constOf(captions)[captionAttributeId].length();
+            textEvaluator.setStringIdValue(env->styleBuiltinValueDefs->id_INPUT_NAME_TAG, nameTagStringId);
+            textEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_TEXT_LENGTH, textLength);
+
+            MapStyleEvaluationResultsCache::Key key(
+                MapStyleRulesetType::Text,
+                context.zoom,
+                tagStringId,
+                valueStringId);
+            key.nameTagStringId = nameTagStringId;
+            key.textLength = textLength;
+            return key;
+        };
 
+    // sort captionsOrder by textOrder property
+    QHash<uint32_t, int> textOrderMap;
     for (const auto& captionAttributeId : constOf(captionsOrder))
     {
-        QString captionAttributeTag;
-        if (captionAttributeId != attributeMapping->nativeNameAttributeId && captionAttributeId != localizedNameRuleId)
-            captionAttributeTag = attributeMapping->decodeMap[captionAttributeId].tag;
-        QString cacheKey = tagWithValue;
-        cacheKey.append(captionAttributeTag);
-        if (!textOrderCache.contains(cacheKey))
-        {
-            textEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_NAME_TAG, captionAttributeTag);
-            evaluationResult.clear();
-            textEvaluator.evaluate(mapObject, MapStyleRulesetType::Text, &evaluationResult);
-            textOrder = 100;
-            evaluationResult.getIntegerValue(env->styleBuiltinValueDefs->id_OUTPUT_TEXT_ORDER, textOrder);
-            textOrderCache.insert(cacheKey, textOrder);
-        }
-        else
-            textOrder = textOrderCache.value(cacheKey);
+        const auto textKey = setupCaptionInputs(captionAttributeId);
+        evaluate(textEvaluator, mapObject, textKey, evaluationResult, evaluationResultsCache, metric);
+        auto textOrder = 100;
+        evaluationResult.getIntegerValue(env->styleBuiltinValueDefs->id_OUTPUT_TEXT_ORDER, textOrder);
         textOrderMap.insert(captionAttributeId, textOrder);
     }
     std::sort(captionsOrder.begin(), captionsOrder.end(), [&textOrderMap] (uint32_t c1, uint32_t c2) {
@@ -2020,16 +2316,8 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
         const Stopwatch textEvaluationStopwatch(metric != nullptr);
 
         // Evaluate style to obtain text parameters
-        textEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_TEXT_LENGTH, caption.length());
-
-        // Get tag of the attribute, in case caption is not from a 'name[:*]'-attribute
-        QString captionAttributeTag;
-        if (captionAttributeId != attributeMapping->nativeNameAttributeId && captionAttributeId != localizedNameRuleId)
-            captionAttributeTag = attributeMapping->decodeMap[captionAttributeId].tag;
-        textEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_NAME_TAG, captionAttributeTag);
-
-        evaluationResult.clear();
-        ok = textEvaluator.evaluate(mapObject, MapStyleRulesetType::Text, &evaluationResult);
+        const auto textKey = setupCaptionInputs(captionAttributeId);
+        ok = evaluate(textEvaluator, mapObject, textKey, evaluationResult, evaluationResultsCache, metric);
 
         if (metric)
         {
@@ -2416,9 +2704,14 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveIcon(
 
 OsmAnd::MapPrimitiviser_P::Context::Context(
     const std::shared_ptr<const MapPresentationEnvironment>& env_,
-    const ZoomLevel zoom_)
+    const ZoomLevel zoom_,
+    const ZoomLevel detailedZoom_,
+    QThreadPool* const threadPool_)
     : env(env_)
     , zoom(zoom_)
+    , evaluators(env_->obtainEvaluatorsContext(zoom_, detailedZoom_))
+    , threadPool(threadPool_)
+    , pendingSharedPrimitivesGroups(new PendingSharedPrimitivesGroups())
 {
     polygonAreaMinimalThreshold = env->getPolygonAreaMinimalThreshold(zoom);
     roadDensityZoomTile = env->getRoadDensityZoomTile(zoom);
@@ -2427,6 +2720,26 @@ OsmAnd::MapPrimitiviser_P::Context::Context(
     defaultBlockPathSpacing = env->getDefaultBlockPathSpacing();
 }
 
+bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
+    const AreaI area31,
+    const ZoomLevel zoom,
+    const QList< std::shared_ptr<const MapObject> >& coastlines,
+    QList< std::shared_ptr<const MapObject> >& outVectorized,
+    CoastlinesPolygonizationCache* const cache)
+{
+    bool processed = false;
+    if (cache && cache->obtain(area31, zoom, coastlines, processed, outVectorized))
+        return processed;
+
+    QList< std::shared_ptr<const MapObject> > polygonizedCoastlines;
+    processed = polygonizeCoastlines(area31, zoom, coastlines, polygonizedCoastlines);
+    if (cache)
+        cache->insert(area31, zoom, coastlines, processed, polygonizedCoastlines);
+    outVectorized.append(polygonizedCoastlines);
+
+    return processed;
+}
+
 bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
     const AreaI area31,
     const ZoomLevel zoom,
@@ -5,6 +5,9 @@
 
 #include "QtExtensions.h"
 #include <QList>
+#include <QVector>
+#include <QThreadPool>
+#include <QSemaphore>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -13,6 +16,9 @@
 #include "MapCommonTypes.h"
 #include "MapPresentationEnvironment.h"
 #include "MapPrimitiviser.h"
+#include "MapStyleEvaluationResultsCache.h"
+#include "MapStyleEvaluatorsPool.h"
+#include "CoastlinesPolygonizationCache.h"
 #include "commonOsmAndCore.h"
 
 namespace OsmAnd
@@ -41,6 +47,9 @@ namespace OsmAnd
         typedef MapPrimitiviser::Cache Cache;
 
     private:
+        mutable QThreadPool _threadPool;
+        mutable CoastlinesPolygonizationCache _coastlinesPolygonizationCache;
+
         void debugCoastline(const AreaI & area31, const QList< std::shared_ptr<const MapObject>> & coastlines) const;
         const AreaI getWidenArea(const AreaI & area31, const ZoomLevel & zoom) const;
     protected:
@@ -54,14 +63,37 @@ namespace OsmAnd
             Points,
         };
 
+        // Tiles with fewer map objects are primitivised by calling thread only
+        static const int ParallelPrimitivisationThreshold = 2048;
+        static const int MapObjectsPerChunk = 512;
+
+        // Last resort for groups which promise is never settled, e.g. if producing thread died
+        static const int PendingSharedGroupsTimeout = 3000;
+
+        // Shared groups which other threads promised to produce. Producer releases semaphore once group is
+        // available, so tile continues with own objects and then waits only for groups that are still late
+        template<typename GROUP>
+        struct PendingSharedGroups Q_DECL_FINAL
+        {
+            QList< proper::shared_future< std::shared_ptr<const GROUP> > > futures;
+            QSemaphore availableSemaphore;
+        };
+        typedef PendingSharedGroups<PrimitivesGroup> PendingSharedPrimitivesGroups;
+        typedef PendingSharedGroups<SymbolsGroup> PendingSharedSymbolsGroups;
+
         struct Context Q_DECL_FINAL
         {
             Context(
                 const std::shared_ptr<const MapPresentationEnvironment>& env,
-                const ZoomLevel zoom);
+                const ZoomLevel zoom,
+                const ZoomLevel detailedZoom,
+                QThreadPool* const threadPool);
 
             const std::shared_ptr<const MapPresentationEnvironment> env;
             const ZoomLevel zoom;
+            const std::shared_ptr<MapStyleEvaluatorsContext> evaluators;
+            QThreadPool* const threadPool;
+            const std::shared_ptr<PendingSharedPrimitivesGroups> pendingSharedPrimitivesGroups;
 
             double polygonAreaMinimalThreshold;
             unsigned int roadDensityZoomTile;
@@ -73,6 +105,12 @@ namespace OsmAnd
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
 
+        static bool polygonizeCoastlines(
+            const AreaI area31,
+            const ZoomLevel zoom,
+            const QList< std::shared_ptr<const MapObject> >& coastlines,
+            QList< std::shared_ptr<const MapObject> >& outVectorized,
+            CoastlinesPolygonizationCache* const cache);
         static bool polygonizeCoastlines(
             const AreaI area31,
             const ZoomLevel zoom,
@@ -92,8 +130,50 @@ namespace OsmAnd
             const std::shared_ptr<const IQueryController>& queryController,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
+        template<typename GROUP>
+        static void subscribeToPendingSharedGroup(
+            SharedResourcesContainer<MapObject::SharingKey, const GROUP>& sharedGroups,
+            const MapObject::SharingKey sharingKey,
+            const proper::shared_future< std::shared_ptr<const GROUP> >& futureGroup,
+            const std::shared_ptr< PendingSharedGroups<GROUP> >& pendingSharedGroups);
+
+        template<typename GROUP>
+        static unsigned int waitForPendingSharedGroups(
+            PendingSharedGroups<GROUP>& pendingSharedGroups,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        static void mergePendingSharedPrimitivesGroups(
+            const Context& context,
+            const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        // Primitives of consecutive map objects, merged into primitivised objects in order of chunks
+        struct PrimitivesChunk
+        {
+            PrimitivesCollection polygons;
+            PrimitivesCollection polylines;
+            PrimitivesCollection points;
+            PrimitivesGroupsCollection primitivesGroups;
+            QList< proper::shared_future< std::shared_ptr<const PrimitivesGroup> > > futureSharedPrimitivesGroups;
+        };
+
+        static void obtainPrimitivesChunk(
+            const Context& context,
+            MapStyleEvaluatorsContext& evaluators,
+            const float detailScaleFactor,
+            const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+            const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+            const int sourceBegin,
+            const int sourceEnd,
+            MapStyleEvaluationResult& evaluationResult,
+            Cache::SharedPrimitivesGroupsContainer* const pSharedPrimitivesGroups,
+            PrimitivesChunk& outChunk,
+            const std::shared_ptr<const IQueryController>& queryController,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
         static std::shared_ptr<const PrimitivesGroup> obtainPrimitivesGroup(
             const Context& context,
+            const ZoomLevel detailedZoom,
             const float detailScaleFactor,
             const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
             const std::shared_ptr<const MapObject>& mapObject,
@@ -102,6 +182,15 @@ namespace OsmAnd
             MapStyleEvaluator& polygonEvaluator,
             MapStyleEvaluator& polylineEvaluator,
             MapStyleEvaluator& pointEvaluator,
+            MapStyleEvaluationResultsCache* const evaluationResultsCache,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        static bool evaluate(
+            MapStyleEvaluator& evaluator,
+            const std::shared_ptr<const MapObject>& mapObject,
+            const MapStyleEvaluationResultsCache::Key& key,
+            MapStyleEvaluationResult& evaluationResult,
+            MapStyleEvaluationResultsCache* const evaluationResultsCache,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
         static void sortAndFilterPrimitives(
@@ -130,7 +219,6 @@ namespace OsmAnd
             const PrimitivesCollection& primitives,
             MapStyleEvaluationResult& evaluationResult,
             MapStyleEvaluator& textEvaluator,
-            QHash<QString, int>& textOrderCache,
             SymbolsCollection& outSymbols,
             const std::shared_ptr<const IQueryController>& queryController,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
@@ -141,7 +229,6 @@ namespace OsmAnd
             const std::shared_ptr<const Primitive>& primitive,
             MapStyleEvaluationResult& evaluationResult,
             MapStyleEvaluator& textEvaluator,
-            QHash<QString, int>& textOrderCache,
             SymbolsCollection& outSymbols,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
@@ -151,7 +238,6 @@ namespace OsmAnd
             const std::shared_ptr<const Primitive>& primitive,
             MapStyleEvaluationResult& evaluationResult,
             MapStyleEvaluator& textEvaluator,
-            QHash<QString, int>& textOrderCache,
             SymbolsCollection& outSymbols,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
@@ -162,7 +248,6 @@ namespace OsmAnd
             const std::shared_ptr<const Primitive>& primitive,
             MapStyleEvaluationResult& evaluationResult,
             MapStyleEvaluator& textEvaluator,
-            QHash<QString, int>& textOrderCache,
             SymbolsCollection& outSymbols,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
@@ -173,7 +258,6 @@ namespace OsmAnd
             const PointI& location,
             MapStyleEvaluationResult& evaluationResult,
             MapStyleEvaluator& textEvaluator,
-            QHash<QString, int>& textOrderCache,
             SymbolsCollection& outSymbols,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
@@ -53,7 +53,7 @@ namespace OsmAnd
             std::shared_ptr<IMapDataProvider::Data>& outData,
             std::shared_ptr<Metric>* const pOutMetric);
 
-        bool obtainRasterizedTile(
+        virtual bool obtainRasterizedTile(
             const MapRasterLayerProvider::Request& request,
             std::shared_ptr<MapRasterLayerProvider::Data>& outData,
             MapRasterLayerProvider_Metrics::Metric_obtainData* const metric);
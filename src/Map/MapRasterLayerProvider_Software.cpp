@@ -5,9 +5,11 @@ OsmAnd::MapRasterLayerProvider_Software::MapRasterLayerProvider_Software(
     const std::shared_ptr<MapPrimitivesProvider>& primitivesProvider_,
     const bool fillBackground_ /* = true */,
     const bool forceObtainDataAsync_ /* = false */,
-    const bool adjustToDetailedZoom_ /* = false */)
+    const bool adjustToDetailedZoom_ /* = false */,
+    const unsigned int metatileSize_ /* = 1 */)
     : MapRasterLayerProvider(new MapRasterLayerProvider_Software_P(this),
         primitivesProvider_, fillBackground_, forceObtainDataAsync_, adjustToDetailedZoom_)
+    , metatileSize(metatileSize_)
 {
 }
 
@@ -1,6 +1,8 @@
 #include "MapRasterLayerProvider_Software_P.h"
 #include "MapRasterLayerProvider_Software.h"
 
+#include "QtCommon.h"
+
 #include "ignore_warnings_on_external_includes.h"
 #include <SkStream.h>
 #include <SkBitmap.h>
@@ -9,6 +11,9 @@
 #include "restore_internal_warnings.h"
 
 #include "MapPrimitivesProvider.h"
+#include "MapPrimitivesProvider_Metrics.h"
+#include "MapPrimitiviser.h"
+#include "IMapObjectsProvider.h"
 #include "ObfsCollection.h"
 #include "ObfDataInterface.h"
 #include "MapRasterizer.h"
@@ -19,6 +24,7 @@
 
 OsmAnd::MapRasterLayerProvider_Software_P::MapRasterLayerProvider_Software_P(MapRasterLayerProvider_Software* owner_)
     : MapRasterLayerProvider_P(owner_)
+    , _metatilesSerial(0)
     , owner(owner_)
 {
 }
@@ -63,3 +69,243 @@ sk_sp<SkImage> OsmAnd::MapRasterLayerProvider_Software_P::rasterize(
 
     return bitmap.asImage();
 }
+
+bool OsmAnd::MapRasterLayerProvider_Software_P::obtainRasterizedTile(
+    const MapRasterLayerProvider::Request& request,
+    std::shared_ptr<MapRasterLayerProvider::Data>& outData,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric)
+{
+    // Metatiles are primitivised with surface only, and have to fit the map exactly
+    const auto metatileSize = owner->metatileSize;
+    const auto tilesPerSide = 1u << static_cast<unsigned int>(request.zoom);
+    if (metatileSize <= 1 || tilesPerSide < metatileSize || (tilesPerSide % metatileSize) != 0 ||
+        owner->primitivesProvider->mode != MapPrimitivesProvider::Mode::WithSurface)
+    {
+        return MapRasterLayerProvider_P::obtainRasterizedTile(request, outData, metric);
+    }
+
+    const auto& queryController = request.queryController;
+
+    if (queryController->isAborted())
+        return false;
+
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    const auto metatileId = TileId::fromXY(
+        request.tileId.x - request.tileId.x % metatileSize,
+        request.tileId.y - request.tileId.y % metatileSize);
+
+    // Metatile aborted by request that started it is rasterized again by request that still needs it
+    std::shared_ptr<const Metatile> metatile;
+    bool rasterizedHere = false;
+    while (!metatile && !rasterizedHere)
+    {
+        if (queryController->isAborted())
+            return false;
+
+        metatile = obtainMetatile(request, metatileId, metatileSize, rasterizedHere, metric);
+    }
+
+    // Metatile failed for other reason, so rasterize this tile on its own
+    if (!metatile)
+    {
+        if (queryController->isAborted())
+            return false;
+
+        return MapRasterLayerProvider_P::obtainRasterizedTile(request, outData, metric);
+    }
+
+    const auto tileIndex =
+        (request.tileId.y - metatileId.y) * metatileSize +
+        (request.tileId.x - metatileId.x);
+    const auto& image = metatile->images[tileIndex];
+    if (!image)
+    {
+        outData.reset();
+
+        if (metric)
+            metric->elapsedTime += totalStopwatch.elapsed();
+
+        return true;
+    }
+
+    outData.reset(new MapRasterLayerProvider::Data(
+        request.tileId,
+        request.zoom,
+        AlphaChannelPresence::NotPresent,
+        owner->getTileDensityFactor(),
+        image,
+        metatile->primitivesData,
+        new RetainableCacheMetadata(metatile->primitivesData->retainableCacheMetadata)));
+
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+
+    return true;
+}
+
+void OsmAnd::MapRasterLayerProvider_Software_P::removeMetatile(const MetatileKey& key)
+{
+    _metatiles.remove(key);
+    _metatilesKeys.removeOne(key);
+}
+
+std::shared_ptr<const OsmAnd::MapRasterLayerProvider_Software_P::Metatile>
+OsmAnd::MapRasterLayerProvider_Software_P::obtainMetatile(
+    const MapRasterLayerProvider::Request& request,
+    const TileId metatileId,
+    const unsigned int metatileSize,
+    bool& outRasterizedHere,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric)
+{
+    const MetatileKey key(static_cast<uint64_t>(metatileId), static_cast<int>(request.zoom));
+    const std::shared_ptr<const MapStyleEvaluationResultsCache> settingsIdentity =
+        owner->primitivesProvider->primitiviser->environment->getEvaluationResultsCache();
+
+    // First request of metatile rasterizes it, others wait for it to be done.
+    // Metatile is forgotten once each of its tiles was served.
+    proper::promise< std::shared_ptr<const Metatile> > metatilePromise;
+    proper::shared_future< std::shared_ptr<const Metatile> > metatileFuture;
+    unsigned int serial = 0;
+    outRasterizedHere = false;
+    {
+        QMutexLocker scopedLocker(&_metatilesMutex);
+
+        const auto itMetatileEntry = _metatiles.find(key);
+        if (itMetatileEntry != _metatiles.end() && itMetatileEntry->settingsIdentity == settingsIdentity)
+        {
+            metatileFuture = itMetatileEntry->future;
+            if (++itMetatileEntry->servedTilesCount >= metatileSize * metatileSize)
+                removeMetatile(key);
+        }
+        else
+        {
+            if (itMetatileEntry != _metatiles.end())
+                removeMetatile(key);
+
+            metatileFuture = metatilePromise.get_future().share();
+            outRasterizedHere = true;
+            serial = ++_metatilesSerial;
+
+            MetatileEntry metatileEntry;
+            metatileEntry.future = metatileFuture;
+            metatileEntry.settingsIdentity = settingsIdentity;
+            metatileEntry.serial = serial;
+            metatileEntry.servedTilesCount = 1;
+            _metatiles.insert(key, metatileEntry);
+            _metatilesKeys.enqueue(key);
+            while (_metatilesKeys.size() > MaxRetainedMetatiles)
+                _metatiles.remove(_metatilesKeys.dequeue());
+        }
+    }
+    if (!outRasterizedHere)
+    {
+        // Waiting request may be cancelled before metatile is done, then it's up to caller to give up
+        const auto& queryController = request.queryController;
+        while (metatileFuture.wait_for(proper::chrono::milliseconds(MetatileWaitPollInterval)) != proper::future_status::ready)
+        {
+            if (queryController->isAborted())
+                return nullptr;
+        }
+
+        return metatileFuture.get();
+    }
+
+    const auto metatile = rasterizeMetatile(request, metatileId, metatileSize, metric);
+
+    // Failed metatile is forgotten before waiters are woken up, so that they don't get it again
+    if (!metatile)
+    {
+        QMutexLocker scopedLocker(&_metatilesMutex);
+
+        const auto citMetatileEntry = _metatiles.constFind(key);
+        if (citMetatileEntry != _metatiles.cend() && citMetatileEntry->serial == serial)
+            removeMetatile(key);
+    }
+    metatilePromise.set_value(metatile);
+
+    return metatile;
+}
+
+std::shared_ptr<const OsmAnd::MapRasterLayerProvider_Software_P::Metatile>
+OsmAnd::MapRasterLayerProvider_Software_P::rasterizeMetatile(
+    const MapRasterLayerProvider::Request& request,
+    const TileId metatileId,
+    const unsigned int metatileSize,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric)
+{
+    const auto& queryController = request.queryController;
+
+    MapPrimitivesProvider::Request metatileRequest(request);
+    metatileRequest.tileId = metatileId;
+    std::shared_ptr<MapPrimitivesProvider::Data> primitivesData;
+    const auto obtained = owner->primitivesProvider->obtainMetatilePrimitives(
+        metatileRequest,
+        metatileSize,
+        primitivesData,
+        metric ? metric->findOrAddSubmetricOfType<MapPrimitivesProvider_Metrics::Metric_obtainData>().get() : nullptr);
+    if (!obtained || queryController->isAborted())
+        return nullptr;
+
+    const std::shared_ptr<Metatile> metatile(new Metatile());
+    metatile->tileId = metatileId;
+    metatile->zoom = request.zoom;
+    metatile->size = metatileSize;
+    metatile->primitivesData = primitivesData;
+    metatile->images.resize(static_cast<int>(metatileSize * metatileSize));
+
+    // Without any primitives all tiles of metatile are empty
+    if (!primitivesData || !primitivesData->primitivisedObjects || primitivesData->primitivisedObjects->isEmpty())
+        return metatile;
+
+    const auto tileSize = owner->getTileSize();
+    const auto metatileSizeInPixels = tileSize * metatileSize;
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(metatileSizeInPixels, metatileSizeInPixels)))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate buffer for rasterization surface %dx%d",
+            metatileSizeInPixels,
+            metatileSizeInPixels);
+        return nullptr;
+    }
+
+    SkCanvas canvas(bitmap);
+    if (!owner->fillBackground)
+        canvas.clear(SK_ColorTRANSPARENT);
+    const auto lastTileId = TileId::fromXY(metatileId.x + metatileSize - 1, metatileId.y + metatileSize - 1);
+    AreaI metatileBBox31;
+    metatileBBox31.top() = Utilities::tileBoundingBox31(metatileId, request.zoom).top();
+    metatileBBox31.left() = Utilities::tileBoundingBox31(metatileId, request.zoom).left();
+    metatileBBox31.bottom() = Utilities::tileBoundingBox31(lastTileId, request.zoom).bottom();
+    metatileBBox31.right() = Utilities::tileBoundingBox31(lastTileId, request.zoom).right();
+    _mapRasterizer->rasterize(
+        metatileBBox31,
+        primitivesData->primitivisedObjects,
+        canvas,
+        owner->fillBackground,
+        nullptr,
+        metric ? metric->findOrAddSubmetricOfType<MapRasterizer_Metrics::Metric_rasterize>().get() : nullptr,
+        queryController);
+
+    if (queryController->isAborted())
+        return nullptr;
+
+    // Each tile gets its own copy of pixels, so that whole metatile is released once it's sliced
+    for (auto y = 0u; y < metatileSize; y++)
+    {
+        for (auto x = 0u; x < metatileSize; x++)
+        {
+            SkBitmap tileBitmap;
+            if (!bitmap.extractSubset(&tileBitmap, SkIRect::MakeXYWH(
+                static_cast<int32_t>(x * tileSize),
+                static_cast<int32_t>(y * tileSize),
+                static_cast<int32_t>(tileSize),
+                static_cast<int32_t>(tileSize))))
+                return nullptr;
+            metatile->images[y * metatileSize + x] = tileBitmap.asImage();
+        }
+    }
+
+    return metatile;
+}
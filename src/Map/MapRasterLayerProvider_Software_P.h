@@ -4,8 +4,16 @@
 #include "stdlib_common.h"
 #include <functional>
 #include <array>
+#include <proper/future.h>
 
 #include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QPair>
+#include <QQueue>
+#include <QMutex>
+#include <QVector>
+#include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -15,10 +23,57 @@
 
 namespace OsmAnd
 {
+    class MapStyleEvaluationResultsCache;
     class MapRasterLayerProvider_Software;
     class MapRasterLayerProvider_Software_P Q_DECL_FINAL : public MapRasterLayerProvider_P
     {
+    public:
+        enum {
+            // Rasterized metatiles kept for tiles that weren't requested yet
+            MaxRetainedMetatiles = 16,
+
+            // Milliseconds between checks for abort while waiting for metatile rasterized by other request
+            MetatileWaitPollInterval = 20,
+        };
+
     private:
+        // Tiles of metatile are sliced from single image, rows first. Tiles without any primitives have no image.
+        struct Metatile
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+            unsigned int size;
+            std::shared_ptr<const MapPrimitivesProvider::Data> primitivesData;
+            QVector< sk_sp<SkImage> > images;
+        };
+        typedef QPair<uint64_t, int> MetatileKey;
+        struct MetatileEntry
+        {
+            proper::shared_future< std::shared_ptr<const Metatile> > future;
+            // Metatile rasterized with other style settings is stale
+            std::shared_ptr<const MapStyleEvaluationResultsCache> settingsIdentity;
+            unsigned int serial;
+            unsigned int servedTilesCount;
+        };
+
+        mutable QMutex _metatilesMutex;
+        QHash<MetatileKey, MetatileEntry> _metatiles;
+        // Oldest metatiles are in front
+        QQueue<MetatileKey> _metatilesKeys;
+        unsigned int _metatilesSerial;
+
+        void removeMetatile(const MetatileKey& key);
+        std::shared_ptr<const Metatile> obtainMetatile(
+            const MapRasterLayerProvider::Request& request,
+            const TileId metatileId,
+            const unsigned int metatileSize,
+            bool& outRasterizedHere,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric);
+        std::shared_ptr<const Metatile> rasterizeMetatile(
+            const MapRasterLayerProvider::Request& request,
+            const TileId metatileId,
+            const unsigned int metatileSize,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric);
     protected:
         MapRasterLayerProvider_Software_P(MapRasterLayerProvider_Software* owner);
 
@@ -31,6 +86,11 @@ namespace OsmAnd
 
         ImplementationInterface<MapRasterLayerProvider_Software> owner;
 
+        virtual bool obtainRasterizedTile(
+            const MapRasterLayerProvider::Request& request,
+            std::shared_ptr<MapRasterLayerProvider::Data>& outData,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric);
+
     friend class OsmAnd::MapRasterLayerProvider_Software;
     };
 }
@@ -0,0 +1,194 @@
+#ifndef _OSMAND_CORE_MAP_RASTERIZER_GEOMETRY_H_
+#define _OSMAND_CORE_MAP_RASTERIZER_GEOMETRY_H_
+
+#include "stdlib_common.h"
+#include <algorithm>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtGlobal>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkMatrix.h>
+#include <SkPath.h>
+#include <SkPoint.h>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define VERTICES_PROJECTION_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#   define VERTICES_PROJECTION_NEON 1
+#   include <arm_neon.h>
+#endif
+#ifndef VERTICES_PROJECTION_SSE2
+#   define VERTICES_PROJECTION_SSE2 0
+#endif // !defined(VERTICES_PROJECTION_SSE2)
+#ifndef VERTICES_PROJECTION_NEON
+#   define VERTICES_PROJECTION_NEON 0
+#endif // !defined(VERTICES_PROJECTION_NEON)
+
+namespace OsmAnd
+{
+    // Geometry of map rasterizer that doesn't depend on map style
+    struct MapRasterizerGeometry Q_DECL_FINAL
+    {
+        // Projects point in 31 coordinates to pixel of area
+        inline static void calculateVertex(
+            const AreaI& area31,
+            const PointD& scaleDivisor31ToPixel,
+            const PointI& pixelOrigin,
+            const PointI& point31,
+            PointF& vertex)
+        {
+            vertex.x = static_cast<float>(point31.x - area31.left()) / scaleDivisor31ToPixel.x;
+            vertex.y = static_cast<float>(point31.y - area31.top()) / scaleDivisor31ToPixel.y;
+
+            vertex += PointF(pixelOrigin);
+        }
+
+        // Same as calculateVertex() for each of points, bit to bit
+        inline static void calculateVertices(
+            const AreaI& area31,
+            const PointD& scaleDivisor31ToPixel,
+            const PointI& pixelOrigin,
+            const PointI* const points31,
+            const int count,
+            SkPoint* const outVertices)
+        {
+            static_assert(sizeof(PointI) == 2 * sizeof(int32_t), "PointI has to be a packed pair of coordinates");
+            static_assert(sizeof(SkPoint) == 2 * sizeof(float), "SkPoint has to be a packed pair of coordinates");
+
+            // Vector code repeats operations of calculateVertex() exactly, including division in double precision,
+            // so that results are same bit to bit
+            const PointF pixelOriginF(pixelOrigin);
+            auto pointIdx = 0;
+#if VERTICES_PROJECTION_SSE2
+            {
+                const auto area31Origin = _mm_setr_epi32(area31.left(), area31.top(), area31.left(), area31.top());
+                const auto divisor = _mm_setr_pd(scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y);
+                const auto origin = _mm_setr_ps(pixelOriginF.x, pixelOriginF.y, pixelOriginF.x, pixelOriginF.y);
+                for (; pointIdx + 2 <= count; pointIdx += 2)
+                {
+                    const auto points = _mm_loadu_si128(reinterpret_cast<const __m128i*>(points31 + pointIdx));
+                    const auto offsets = _mm_cvtepi32_ps(_mm_sub_epi32(points, area31Origin));
+                    const auto first = _mm_cvtpd_ps(_mm_div_pd(_mm_cvtps_pd(offsets), divisor));
+                    const auto second = _mm_cvtpd_ps(_mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(offsets, offsets)), divisor));
+                    const auto vertices = _mm_add_ps(_mm_movelh_ps(first, second), origin);
+                    _mm_storeu_ps(reinterpret_cast<float*>(outVertices + pointIdx), vertices);
+                }
+            }
+#elif VERTICES_PROJECTION_NEON
+            {
+                const int32_t area31OriginValues[4] = { area31.left(), area31.top(), area31.left(), area31.top() };
+                const double divisorValues[2] = { scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y };
+                const float originValues[4] = { pixelOriginF.x, pixelOriginF.y, pixelOriginF.x, pixelOriginF.y };
+                const auto area31Origin = vld1q_s32(area31OriginValues);
+                const auto divisor = vld1q_f64(divisorValues);
+                const auto origin = vld1q_f32(originValues);
+                for (; pointIdx + 2 <= count; pointIdx += 2)
+                {
+                    const auto points = vld1q_s32(reinterpret_cast<const int32_t*>(points31 + pointIdx));
+                    const auto offsets = vcvtq_f32_s32(vsubq_s32(points, area31Origin));
+                    const auto first = vcvt_f32_f64(vdivq_f64(vcvt_f64_f32(vget_low_f32(offsets)), divisor));
+                    const auto second = vcvt_f32_f64(vdivq_f64(vcvt_high_f64_f32(offsets), divisor));
+                    const auto vertices = vaddq_f32(vcombine_f32(first, second), origin);
+                    vst1q_f32(reinterpret_cast<float*>(outVertices + pointIdx), vertices);
+                }
+            }
+#endif
+
+            PointF vertex;
+            for (; pointIdx < count; pointIdx++)
+            {
+                calculateVertex(area31, scaleDivisor31ToPixel, pixelOrigin, points31[pointIdx], vertex);
+                outVertices[pointIdx].set(vertex.x, vertex.y);
+            }
+        }
+
+        // Arc lengths of straight segments along first non-empty contour of path
+        struct PathMeasure
+        {
+            struct Segment
+            {
+                SkPoint start;
+                SkPoint end;
+                float distance;
+            };
+
+            QVector<Segment> segments;
+
+            explicit PathMeasure(const SkPath& path)
+            {
+                // Same as SkPathMeasure: zero-length segments are skipped, as well as contours without length
+                segments.reserve(path.countPoints());
+
+                auto distance = 0.0f;
+                SkPoint points[4];
+                SkPath::Iter itPath(path, false);
+                for (auto verb = itPath.next(points); verb != SkPath::kDone_Verb; verb = itPath.next(points))
+                {
+                    if (verb == SkPath::kMove_Verb)
+                    {
+                        if (!segments.isEmpty())
+                            break;
+                        continue;
+                    }
+                    if (verb != SkPath::kLine_Verb)
+                        continue;
+
+                    const auto prevDistance = distance;
+                    distance += SkPoint::Distance(points[0], points[1]);
+                    if (distance > prevDistance)
+                        segments.push_back({ points[0], points[1], distance });
+                }
+            }
+
+            inline float getLength() const
+            {
+                return segments.isEmpty() ? 0.0f : segments.last().distance;
+            }
+
+            // Same as SkPathMeasure::getMatrix(), distance is pinned to the path
+            inline bool getMatrix(const float distance_, SkMatrix& outMatrix) const
+            {
+                if (segments.isEmpty())
+                    return false;
+
+                const auto distance = qBound(0.0f, distance_, segments.last().distance);
+
+                // Segment that ends at or after given distance
+                const auto citSegment = std::lower_bound(segments.cbegin(), segments.cend(), distance,
+                    []
+                    (const Segment& segment, const float value) -> bool
+                    {
+                        return segment.distance < value;
+                    });
+                const auto& segment = *citSegment;
+                const auto startDistance = citSegment == segments.cbegin() ? 0.0f : (citSegment - 1)->distance;
+                const auto t = (distance - startDistance) / (segment.distance - startDistance);
+
+                const auto position = SkPoint::Make(
+                    segment.start.fX + (segment.end.fX - segment.start.fX) * t,
+                    segment.start.fY + (segment.end.fY - segment.start.fY) * t);
+                SkVector tangent;
+                tangent.setNormalize(segment.end.fX - segment.start.fX, segment.end.fY - segment.start.fY);
+
+                outMatrix.setSinCos(tangent.fY, tangent.fX, 0, 0);
+                outMatrix.postTranslate(position.fX, position.fY);
+                return true;
+            }
+        };
+
+    private:
+        MapRasterizerGeometry();
+        ~MapRasterizerGeometry();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_RASTERIZER_GEOMETRY_H_)
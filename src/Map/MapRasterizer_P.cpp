@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <limits>
 #include "QtCommon.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QReadWriteLock>
@@ -13,16 +14,15 @@
 #include <SkImage.h>
 #include <SkBlurMaskFilter.h>
 #include <SkColorFilter.h>
-#include <SkDashPathEffect.h>
 #include <SkShader.h>
 #include <SkPoint.h>
-#include <SkPathMeasure.h>
 #include "restore_internal_warnings.h"
 
 #include "MapPresentationEnvironment.h"
 #include "MapStyleEvaluationResult.h"
 #include "MapStyleBuiltinValueDefinitions.h"
 #include "MapPrimitiviser.h"
+#include "MapRasterizerGeometry.h"
 #include "QKeyValueIterator.h"
 #include "QCachingIterator.h"
 #include "Stopwatch.h"
@@ -178,6 +178,7 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
 {
     assert(type != PrimitivesType::Points);
 
+    PolygonsBatch polygonsBatch;
     for (const auto& primitive : constOf(primitives))
     {
         if (queryController && queryController->isAborted())
@@ -185,12 +186,20 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
 
         if (primitive->type == MapPrimitiviser::PrimitiveType::Polygon)
         {
-            rasterizePolygon(
-                context,
-                canvas,
-                primitive);
+            SkPath path;
+            if (!calculatePolygonPath(context, primitive, path))
+                continue;
+
+            if (!appendToPolygonsBatch(polygonsBatch, primitive, path))
+            {
+                drawPolygonsBatch(canvas, polygonsBatch);
+                startPolygonsBatch(context, polygonsBatch, primitive, path);
+            }
+            continue;
         }
-        else if (primitive->type == MapPrimitiviser::PrimitiveType::Polyline)
+
+        drawPolygonsBatch(canvas, polygonsBatch);
+        if (primitive->type == MapPrimitiviser::PrimitiveType::Polyline)
         {
             rasterizePolyline(
                 context,
@@ -199,6 +208,7 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
                 (type == PrimitivesType::Polylines_ShadowOnly));
         }
     }
+    drawPolygonsBatch(canvas, polygonsBatch);
 }
 
 bool OsmAnd::MapRasterizer_P::updatePaint(
@@ -329,7 +339,7 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
         else
         {
             sk_sp<SkPathEffect> pathEffect;
-            ok = obtainPathEffect(encodedPathEffect, pathEffect);
+            ok = env->obtainPathEffect(encodedPathEffect, pathEffect);
 
             if (ok && pathEffect)
                 paint.setPathEffect(pathEffect);
@@ -347,7 +357,7 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
         if (ok && !shader.isEmpty())
         {
             sk_sp<SkShader> skShader;
-            if (obtainImageShader(env, shader, skShader) && skShader)
+            if (env->obtainImageShader(shader, skShader) && skShader)
             {
                 // SKIA requires non-transparent color
                 if (paint.getColor() == SK_ColorTRANSPARENT)
@@ -383,10 +393,10 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
     return true;
 }
 
-void OsmAnd::MapRasterizer_P::rasterizePolygon(
+bool OsmAnd::MapRasterizer_P::calculatePolygonPath(
     const Context& context,
-    SkCanvas& canvas,
-    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive)
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+    SkPath& outPath) const
 {
     const auto& points31 = primitive->sourceObject->points31;
     const auto& area31 = context.area31;
@@ -405,48 +415,32 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     const auto& evaluationResult = primitive->evaluationResult;
     if (!evaluationResult.contains(context.env->styleBuiltinValueDefs->id_OUTPUT_COLOR) &&
         !evaluationResult.contains(context.env->styleBuiltinValueDefs->id_OUTPUT_SHADER))
-        return;
-
-    SkPaint paint = _defaultPaint;
+        return false;
 
-    // Construct and test geometry against bbox area
-    SkPath path;
+    // Test geometry against bbox area
     bool containsAtLeastOnePoint = false;
-    int pointIdx = 0;
-    PointF vertex;
     Utilities::CHValue prevChValue;
     QVector< PointI > outerPoints;
     const auto pointsCount = points31.size();
     auto pPoint = points31.constData();
-    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    for (auto pointIdx = 0; pointIdx < pointsCount && !containsAtLeastOnePoint; pointIdx++, pPoint++)
     {
         const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
 
-        // Hit-test
-        if (!containsAtLeastOnePoint)
+        if (area31.contains(point))
+            containsAtLeastOnePoint = true;
+        else
+            outerPoints.push_back(point);
+
+        const auto chValue = Utilities::computeCohenSutherlandValue(point, area31);
+        if (Q_LIKELY(pointIdx > 0))
         {
-            if (area31.contains(point))
+            // Check if line crosses area (reject only if points are on the same side)
+            const auto intersectedChValue = prevChValue & chValue;
+            if (static_cast<unsigned int>(intersectedChValue) != 0)
                 containsAtLeastOnePoint = true;
-            else
-                outerPoints.push_back(point);
-
-            const auto chValue = Utilities::computeCohenSutherlandValue(point, area31);
-            if (Q_LIKELY(pointIdx > 0))
-            {
-                // Check if line crosses area (reject only if points are on the same side)
-                const auto intersectedChValue = prevChValue & chValue;
-                if (static_cast<unsigned int>(intersectedChValue) != 0)
-                    containsAtLeastOnePoint = true;
-            }
-            prevChValue = chValue;
         }
-
-        // Plot vertex
-        if (pointIdx == 0)
-            path.moveTo(vertex.x, vertex.y);
-        else
-            path.lineTo(vertex.x, vertex.y);
+        prevChValue = chValue;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -465,7 +459,7 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
         ok = ok || OsmAnd::Utilities::contains(outerPoints, PointI(0, area31.bottom()));
         ok = ok || OsmAnd::Utilities::contains(outerPoints, PointI(area31.right(), 0));
         if (!ok)
-            return;
+            return false;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -475,31 +469,208 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     //}
     //////////////////////////////////////////////////////////////////////////
 
+    // Parts of large polygons far outside of tile are cut off before projection. Outline is left intact when
+    // it's dashed, since clipping would shift dashes.
+    const bool clip = !evaluationResult.contains(context.env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_2);
+    const auto& scalePixelTo31 = context.primitivisedObjects->scaleDivisor31ToPixel;
+    const auto enlarge31X = static_cast<int64_t>(context.pixelArea.width() / 4.0f * scalePixelTo31.x);
+    const auto enlarge31Y = static_cast<int64_t>(context.pixelArea.height() / 4.0f * scalePixelTo31.y);
+    const AreaI64 clipArea31(
+        qMax<int64_t>(area31.top() - enlarge31Y, std::numeric_limits<int32_t>::min()),
+        qMax<int64_t>(area31.left() - enlarge31X, std::numeric_limits<int32_t>::min()),
+        qMin<int64_t>(area31.bottom() + enlarge31Y, std::numeric_limits<int32_t>::max()),
+        qMin<int64_t>(area31.right() + enlarge31X, std::numeric_limits<int32_t>::max()));
+
+    QVector<PointI> clippedPoints31;
+    QVector<SkPoint> vertices;
+    if (!appendPolygonToPath(context, points31, clip ? &clipArea31 : nullptr, clippedPoints31, vertices, outPath))
+        return false;
+
     if (!primitive->sourceObject->innerPolygonsPoints31.isEmpty())
     {
-        path.setFillType(SkPathFillType::kEvenOdd);
+        outPath.setFillType(SkPathFillType::kEvenOdd);
         for (const auto& polygon : constOf(primitive->sourceObject->innerPolygonsPoints31))
+            appendPolygonToPath(context, polygon, clip ? &clipArea31 : nullptr, clippedPoints31, vertices, outPath);
+    }
+
+    return true;
+}
+
+bool OsmAnd::MapRasterizer_P::appendPolygonToPath(
+    const Context& context,
+    const QVector<PointI>& points31,
+    const AreaI64* const pClipArea31,
+    QVector<PointI>& clippedPoints31,
+    QVector<SkPoint>& vertices,
+    SkPath& outPath) const
+{
+    auto pPoints31 = &points31;
+    if (pClipArea31)
+    {
+        bool isInside = true;
+        for (const auto& point : constOf(points31))
         {
-            pointIdx = 0;
-            for (auto itVertex = cachingIteratorOf(constOf(polygon)); itVertex; ++itVertex, pointIdx++)
+            if (point.x < pClipArea31->left() || point.x > pClipArea31->right() ||
+                point.y < pClipArea31->top() || point.y > pClipArea31->bottom())
             {
-                const auto& point = *itVertex;
-                calculateVertex(context, point, vertex);
+                isInside = false;
+                break;
+            }
+        }
+
+        if (!isInside)
+        {
+            clipPolygon(points31, *pClipArea31, clippedPoints31);
+            pPoints31 = &clippedPoints31;
+        }
+    }
+    if (pPoints31->size() < 3)
+        return false;
+
+    const auto pointsCount = pPoints31->size();
+    vertices.resize(pointsCount);
+    calculateVertices(context, pPoints31->constData(), pointsCount, vertices.data());
+    outPath.addPoly(vertices.constData(), pointsCount, false);
+
+    return true;
+}
+
+void OsmAnd::MapRasterizer_P::clipPolygon(
+    const QVector<PointI>& points31,
+    const AreaI64& clipArea31,
+    QVector<PointI>& outPoints31)
+{
+    // Sutherland-Hodgman: ring is clipped by each side of area in turn
+    QVector<PointI> input;
+    outPoints31 = points31;
+    for (auto side = 0; side < 4 && !outPoints31.isEmpty(); side++)
+    {
+        std::swap(input, outPoints31);
+        outPoints31.clear();
 
-                if (pointIdx == 0)
-                    path.moveTo(vertex.x, vertex.y);
+        const auto distanceToSide =
+            [side, &clipArea31]
+            (const PointI& point) -> int64_t
+            {
+                switch (side)
+                {
+                    case 0:
+                        return point.x - clipArea31.left();
+                    case 1:
+                        return clipArea31.right() - point.x;
+                    case 2:
+                        return point.y - clipArea31.top();
+                    default:
+                        return clipArea31.bottom() - point.y;
+                }
+            };
+
+        auto prevPoint = input.at(input.size() - 1);
+        auto prevDistance = distanceToSide(prevPoint);
+        for (const auto& point : constOf(input))
+        {
+            const auto distance = distanceToSide(point);
+            if ((distance >= 0) != (prevDistance >= 0))
+            {
+                // Segment crosses the side, so it's split exactly on it
+                const auto t = static_cast<double>(prevDistance) / static_cast<double>(prevDistance - distance);
+                PointI crossing(
+                    static_cast<int32_t>(prevPoint.x + qRound64(t * (static_cast<int64_t>(point.x) - prevPoint.x))),
+                    static_cast<int32_t>(prevPoint.y + qRound64(t * (static_cast<int64_t>(point.y) - prevPoint.y))));
+                if (side < 2)
+                    crossing.x = static_cast<int32_t>(side == 0 ? clipArea31.left() : clipArea31.right());
                 else
-                    path.lineTo(vertex.x, vertex.y);
+                    crossing.y = static_cast<int32_t>(side == 2 ? clipArea31.top() : clipArea31.bottom());
+                outPoints31.push_back(crossing);
             }
+            if (distance >= 0)
+                outPoints31.push_back(point);
+
+            prevPoint = point;
+            prevDistance = distance;
         }
     }
+}
 
-    if (updatePaint(context, paint, primitive, PaintValuesSet::Layer_0, true))
-        canvas.drawPath(path, paint);
-    if (updatePaint(context, paint, primitive, PaintValuesSet::Layer_1, true))
-        canvas.drawPath(path, paint);
-    if (updatePaint(context, paint, primitive, PaintValuesSet::Layer_2, false))
-        canvas.drawPath(path, paint);
+void OsmAnd::MapRasterizer_P::startPolygonsBatch(
+    const Context& context,
+    PolygonsBatch& batch,
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+    const SkPath& path)
+{
+    batch.primitive = primitive;
+    batch.path = path;
+    batch.bounds.clear();
+
+    // Paints are evaluated once for whole batch
+    const PaintValuesSet layers[PolygonsBatch::LayersCount] = {
+        PaintValuesSet::Layer_0,
+        PaintValuesSet::Layer_1,
+        PaintValuesSet::Layer_2,
+    };
+    const bool isArea[PolygonsBatch::LayersCount] = { true, true, false };
+    SkPaint paint = _defaultPaint;
+    batch.margin = 1.0f;
+    for (auto layerIdx = 0; layerIdx < PolygonsBatch::LayersCount; layerIdx++)
+    {
+        batch.hasPaint[layerIdx] = updatePaint(context, paint, primitive, layers[layerIdx], isArea[layerIdx]);
+        if (!batch.hasPaint[layerIdx])
+            continue;
+        batch.paints[layerIdx] = paint;
+
+        // Miter joins may stick out of stroke up to miter limit
+        if (paint.getStyle() != SkPaint::kFill_Style)
+        {
+            const auto strokeExtent = paint.getStrokeWidth() * qMax(paint.getStrokeMiter(), 1.0f) / 2.0f;
+            batch.margin = qMax(batch.margin, strokeExtent + 1.0f);
+        }
+    }
+
+    batch.bounds.push_back(path.getBounds().makeOutset(batch.margin, batch.margin));
+}
+
+bool OsmAnd::MapRasterizer_P::appendToPolygonsBatch(
+    PolygonsBatch& batch,
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+    const SkPath& path) const
+{
+    if (!batch.primitive || batch.bounds.size() >= MaxPolygonsBatchSize)
+        return false;
+
+    // Drawing as single path gives same pixels only when paints are same and polygons don't touch each other
+    const auto& batchPrimitive = batch.primitive;
+    if (primitive->zOrder != batchPrimitive->zOrder ||
+        primitive->detailScaleFactor != batchPrimitive->detailScaleFactor ||
+        path.getFillType() != batch.path.getFillType() ||
+        primitive->evaluationResult.entries != batchPrimitive->evaluationResult.entries)
+    {
+        return false;
+    }
+
+    const auto bounds = path.getBounds().makeOutset(batch.margin, batch.margin);
+    for (const auto& otherBounds : constOf(batch.bounds))
+    {
+        if (SkRect::Intersects(bounds, otherBounds))
+            return false;
+    }
+
+    batch.path.addPath(path);
+    batch.bounds.push_back(bounds);
+    return true;
+}
+
+void OsmAnd::MapRasterizer_P::drawPolygonsBatch(SkCanvas& canvas, PolygonsBatch& batch) const
+{
+    if (!batch.primitive)
+        return;
+
+    for (auto layerIdx = 0; layerIdx < PolygonsBatch::LayersCount; layerIdx++)
+    {
+        if (batch.hasPaint[layerIdx])
+            canvas.drawPath(batch.path, batch.paints[layerIdx]);
+    }
+
+    batch.primitive.reset();
 }
 
 bool OsmAnd::MapRasterizer_P::calculateLinePath(
@@ -526,20 +697,28 @@ bool OsmAnd::MapRasterizer_P::calculateLinePath(
     std::deque<PointF> originalPoints;
     std::deque<PointF> shiftedPoints;
 
+    // Segments that lie entirely on one side of area are rejected in 31 coordinates, so vertices of long
+    // runs outside of area are never projected
+    bool hasPVertex = false;
     for (pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
     {
         const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
 
         int cross = 0;
         cross |= (point.x < area31.left() ? 1 : 0);
         cross |= (point.x > area31.right() ? 2 : 0);
         cross |= (point.y < area31.top() ? 4 : 0);
         cross |= (point.y > area31.bottom() ? 8 : 0);
+        bool hasVertex = false;
         if (pointIdx > 0)
         {
             if ((prevCross & cross) == 0)
             {
+                if (!hasPVertex)
+                    calculateVertex(context, *(pPoint - 1), pVertex);
+                calculateVertex(context, point, vertex);
+                hasVertex = true;
+
                 if (prevCross != 0 || !intersect)
                 {
                     simplifyVertexToDirection(context, pVertex, vertex, tempVertex);
@@ -566,7 +745,9 @@ bool OsmAnd::MapRasterizer_P::calculateLinePath(
             }
         }
         prevCross = cross;
-        pVertex = vertex;
+        if (hasVertex)
+            pVertex = vertex;
+        hasPVertex = hasVertex;
     }
 
     return intersect;
@@ -611,6 +792,10 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
     SkPaint paint = _defaultPaint;
     ColorARGB shadowColor;
     float shadowRadius = 0.0f;
+    float strokeWidth = 0.0f;
+    const auto hasStroke =
+        evaluationResult.getFloatValue(env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH, strokeWidth) &&
+        strokeWidth > 0.0f;
     if (drawOnlyShadow)
     {
         const auto hasShadowRadius = evaluationResult.getFloatValue(
@@ -628,14 +813,9 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
         if (!hasShadowColor || shadowColor == ColorARGB::fromSkColor(SK_ColorTRANSPARENT))
             shadowColor = context.shadowColor;
     }
-    else
+    else if (!hasStroke)
     {
-        float strokeWidth = 0.0f;
-        if (!evaluationResult.getFloatValue(env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH, strokeWidth) ||
-            strokeWidth <= 0.0f)
-        {
-            return;
-        }
+        return;
     }
 
     // Enlarge area to draw stroke if logical path is outside of original area
@@ -657,9 +837,15 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
 
     assert(points31.size() >= 2);
 
+    // Path is the same for shadow and main passes, so it's projected once
     SkPath path;
-    bool intersect = calculateLinePath(context, points31, enlargedArea31, path);
-    if (!intersect)
+    const auto itPath = drawOnlyShadow ? context.polylinePaths.end() : context.polylinePaths.find(primitive.get());
+    if (itPath != context.polylinePaths.end())
+    {
+        path.swap(*itPath);
+        context.polylinePaths.erase(itPath);
+    }
+    else if (!calculateLinePath(context, points31, enlargedArea31, path))
     {
         if (areaIndex >= 0)
             mapObject->stopReadingArea(areaIndex);
@@ -668,6 +854,9 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
 
     if (drawOnlyShadow)
     {
+        // Main pass skips polylines without stroke, so their paths would never be taken
+        if (hasStroke)
+            context.polylinePaths.insert(primitive.get(), path);
         rasterizePolylineShadow(
             context,
             canvas,
@@ -774,7 +963,7 @@ void OsmAnd::MapRasterizer_P::rasterizePolylineIcons(
     mIconTransform.setTranslate(-0.5f * pathIcon->width(), -0.5f * pathIcon->height());
     mIconTransform.postRotate(90.0f);
 
-    SkPathMeasure pathMeasure(path, false);
+    const MapRasterizerGeometry::PathMeasure pathMeasure(path);
 
     const auto length = pathMeasure.getLength();
     auto iconOffset = 0.5f * pathIconStep;
@@ -786,7 +975,7 @@ void OsmAnd::MapRasterizer_P::rasterizePolylineIcons(
     for (auto iconInstanceIdx = 0; iconInstanceIdx < iconInstancesCount; iconInstanceIdx++, iconOffset += pathIconStep)
     {
         SkMatrix mPinPoint;
-        ok = pathMeasure.getMatrix(iconOffset, &mPinPoint);
+        ok = pathMeasure.getMatrix(iconOffset, mPinPoint);
         if (!ok)
             break;
 
@@ -843,80 +1032,27 @@ void OsmAnd::MapRasterizer_P::simplifyVertexToDirection(
 
 void OsmAnd::MapRasterizer_P::calculateVertex(const Context& context, const PointI& point31, PointF& vertex) const
 {
-    vertex.x = static_cast<float>(point31.x - context.area31.left()) / context.primitivisedObjects->scaleDivisor31ToPixel.x;
-    vertex.y = static_cast<float>(point31.y - context.area31.top()) / context.primitivisedObjects->scaleDivisor31ToPixel.y;
-
-    vertex += PointF(context.pixelArea.topLeft);
-}
-
-bool OsmAnd::MapRasterizer_P::obtainPathEffect(const QString& encodedPathEffect, sk_sp<SkPathEffect> &outPathEffect) const
-{
-    QMutexLocker scopedLocker(&_pathEffectsMutex);
-
-    auto itPathEffects = _pathEffects.constFind(encodedPathEffect);
-    if (itPathEffects == _pathEffects.cend())
-    {
-        const auto& strIntervals = encodedPathEffect.split(QLatin1Char('_'), QString::SkipEmptyParts);
-        const auto intervalsCount = strIntervals.size();
-
-        const auto intervals = new SkScalar[intervalsCount];
-        auto pInterval = intervals;
-        for (const auto& strInterval : constOf(strIntervals))
-        {
-            float computedValue = 0.0f;
-
-            if (!strInterval.contains(QLatin1Char(':')))
-            {
-                computedValue = strInterval.toFloat()*owner->mapPresentationEnvironment->displayDensityFactor;
-            }
-            else
-            {
-                // "pt:px" format
-                const auto& complexValue = strInterval.split(QLatin1Char(':'), QString::KeepEmptyParts);
-
-                computedValue = complexValue[0].toFloat()*owner->mapPresentationEnvironment->displayDensityFactor + complexValue[1].toFloat();
-            }
-
-            *(pInterval++) = computedValue;
-        }
-
-        // Validate
-        if (intervalsCount < 2 || intervalsCount % 2 != 0)
-        {
-            LogPrintf(LogSeverityLevel::Warning,
-                "Path effect (%s) with %d intervals is invalid",
-                qPrintable(encodedPathEffect),
-                intervalsCount);
-            return false;
-        }
-
-        const auto pathEffect = SkDashPathEffect::Make(intervals, intervalsCount, 0);
-        delete[] intervals;
-
-        itPathEffects = _pathEffects.insert(encodedPathEffect, pathEffect);
-    }
-
-    outPathEffect = *itPathEffects;
-    return true;
+    MapRasterizerGeometry::calculateVertex(
+        context.area31,
+        context.primitivisedObjects->scaleDivisor31ToPixel,
+        context.pixelArea.topLeft,
+        point31,
+        vertex);
 }
 
-bool OsmAnd::MapRasterizer_P::obtainImageShader(
-    const std::shared_ptr<const MapPresentationEnvironment>& env,
-    const QString& name,
-    sk_sp<SkShader> &outShader)
+void OsmAnd::MapRasterizer_P::calculateVertices(
+    const Context& context,
+    const PointI* const points31,
+    const int count,
+    SkPoint* const outVertices) const
 {
-    sk_sp<const SkImage> image;
-    if (!env->obtainIcon(name, 1.0f, image))
-    {
-        LogPrintf(LogSeverityLevel::Warning,
-            "Failed to get '%s' shader image",
-            qPrintable(name));
-
-        return false;
-    }
-
-    outShader = image->makeShader(SkTileMode::kRepeat, SkTileMode::kRepeat, {});
-    return true;
+    MapRasterizerGeometry::calculateVertices(
+        context.area31,
+        context.primitivisedObjects->scaleDivisor31ToPixel,
+        context.pixelArea.topLeft,
+        points31,
+        count,
+        outVertices);
 }
 
 OsmAnd::MapRasterizer_P::Context::Context(
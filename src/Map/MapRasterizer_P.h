@@ -8,11 +8,14 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
 #include <QVector>
+#include <QHash>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
 #include <SkCanvas.h>
+#include <SkMatrix.h>
 #include <SkPaint.h>
+#include <SkPath.h>
 #include <SkShader.h>
 #include <SkPathEffect.h>
 #include "restore_internal_warnings.h"
@@ -52,6 +55,9 @@ namespace OsmAnd
             MapPresentationEnvironment::ShadowMode shadowMode;
             ColorARGB shadowColor;
 
+            // Projected paths of polylines made by shadow pass, taken by main pass
+            mutable QHash< const MapPrimitiviser::Primitive*, SkPath > polylinePaths;
+
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
@@ -90,10 +96,51 @@ namespace OsmAnd
             const PrimitivesType type,
             const std::shared_ptr<const IQueryController>& queryController);
 
-        void rasterizePolygon(
+        bool calculatePolygonPath(
             const Context& context,
-            SkCanvas& canvas,
-            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive);
+            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+            SkPath& outPath) const;
+        bool appendPolygonToPath(
+            const Context& context,
+            const QVector<PointI>& points31,
+            const AreaI64* const pClipArea31,
+            QVector<PointI>& clippedPoints31,
+            QVector<SkPoint>& vertices,
+            SkPath& outPath) const;
+        static void clipPolygon(
+            const QVector<PointI>& points31,
+            const AreaI64& clipArea31,
+            QVector<PointI>& outPoints31);
+
+        // Run of adjacent polygons with same paints that is drawn as single path
+        struct PolygonsBatch
+        {
+            enum {
+                LayersCount = 3,
+            };
+
+            std::shared_ptr<const MapPrimitiviser::Primitive> primitive;
+            SkPath path;
+            SkPaint paints[LayersCount];
+            bool hasPaint[LayersCount];
+            float margin;
+            QVector<SkRect> bounds;
+        };
+        enum {
+            // Each polygon appended to batch is tested against every polygon already in it
+            MaxPolygonsBatchSize = 32,
+        };
+
+        void startPolygonsBatch(
+            const Context& context,
+            PolygonsBatch& batch,
+            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+            const SkPath& path);
+        bool appendToPolygonsBatch(
+            PolygonsBatch& batch,
+            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+            const SkPath& path) const;
+        void drawPolygonsBatch(SkCanvas& canvas, PolygonsBatch& batch) const;
 
         void rasterizePolyline(
             const Context& context,
@@ -132,19 +179,17 @@ namespace OsmAnd
             SkPath& outPath,
             float offset) const;
         inline void calculateVertex(const Context& context, const PointI& point31, PointF& vertex) const;
+        void calculateVertices(
+            const Context& context,
+            const PointI* const points31,
+            const int count,
+            SkPoint* const outVertices) const;
         inline float lineEquation(float x1, float y1, float x2, float y2, float x) const;
         inline void simplifyVertexToDirection(const Context& , const PointF& , const PointF& , PointF&) const;
 
         void initialize();
 
         SkPaint _defaultPaint;
-
-        mutable QMutex _pathEffectsMutex;
-        mutable QHash< QString, sk_sp<SkPathEffect> > _pathEffects;
-        bool obtainPathEffect(const QString& encodedPathEffect, sk_sp<SkPathEffect> &outPathEffect) const;
-        bool obtainImageShader(
-            const std::shared_ptr<const MapPresentationEnvironment>& env,
-            const QString& name, sk_sp<SkShader> &outShader);
     public:
         ~MapRasterizer_P();
 
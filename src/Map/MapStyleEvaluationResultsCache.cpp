@@ -0,0 +1,135 @@
+#include "MapStyleEvaluationResultsCache.h"
+
+#include "QtCommon.h"
+
+#include "HashUtilities.h"
+
+#include "ResolvedMapStyle.h"
+#include "MapStyleProgram.h"
+
+OsmAnd::MapStyleEvaluationResultsCache::MapStyleEvaluationResultsCache(const std::shared_ptr<const IMapStyle>& mapStyle)
+    : _program([mapStyle]
+        () -> std::shared_ptr<const MapStyleProgram>
+        {
+            const auto resolvedMapStyle = std::dynamic_pointer_cast<const ResolvedMapStyle>(mapStyle);
+            return resolvedMapStyle ? resolvedMapStyle->getProgram() : nullptr;
+        }())
+{
+}
+
+OsmAnd::MapStyleEvaluationResultsCache::~MapStyleEvaluationResultsCache()
+{
+}
+
+OsmAnd::MapStyleEvaluationResultsCache::Shard& OsmAnd::MapStyleEvaluationResultsCache::getShard(const Key& key)
+{
+    return _shards[(qHash(key) >> 24) % ShardsCount];
+}
+
+const OsmAnd::MapStyleEvaluationResultsCache::Shard& OsmAnd::MapStyleEvaluationResultsCache::getShard(const Key& key) const
+{
+    return _shards[(qHash(key) >> 24) % ShardsCount];
+}
+
+OsmAnd::MapStyleEvaluationResultsCache::LookupResult OsmAnd::MapStyleEvaluationResultsCache::obtain(
+    const Key& key,
+    bool& outSuccess,
+    MapStyleEvaluationResult& outResult) const
+{
+    // Without compiled program it's unknown which rules depend on map object
+    if (!_program)
+        return LookupResult::Uncacheable;
+
+    const auto& shard = getShard(key);
+    QReadLocker scopedLocker(&shard.lock);
+
+    const auto citEntry = shard.entries.constFind(key);
+    if (citEntry == shard.entries.cend())
+        return LookupResult::Miss;
+    const auto& entry = *citEntry;
+    if (!entry.isCacheable)
+        return LookupResult::Uncacheable;
+
+    outSuccess = entry.success;
+    for (const auto& resultEntry : constOf(entry.result.entries))
+        outResult.setValue(resultEntry.first, resultEntry.second);
+
+    return LookupResult::Hit;
+}
+
+void OsmAnd::MapStyleEvaluationResultsCache::insert(
+    const Key& key,
+    const bool success,
+    const MapStyleEvaluationResult& result)
+{
+    if (!_program)
+        return;
+
+    // Whether result depends on map object is remembered as well, so that it's checked once per key
+    Entry entry;
+    entry.isCacheable = !_program->dependsOnMapObject(key.rulesetType, key.tagStringId, key.valueStringId);
+    entry.success = success;
+    if (entry.isCacheable)
+        result.pack(entry.result);
+
+    auto& shard = getShard(key);
+    QWriteLocker scopedLocker(&shard.lock);
+
+    insertIntoBoundedCache(shard.entries, MaxEntriesPerShard, key, entry);
+}
+
+OsmAnd::MapStyleEvaluationResultsCache::Key::Key(
+    const MapStyleRulesetType rulesetType_,
+    const ZoomLevel zoom_,
+    const IMapStyle::StringId tagStringId_,
+    const IMapStyle::StringId valueStringId_)
+    : rulesetType(rulesetType_)
+    , zoom(zoom_)
+    , tagStringId(tagStringId_)
+    , valueStringId(valueStringId_)
+    , layer(0)
+    , isArea(false)
+    , isPoint(false)
+    , isCycle(false)
+    , textLength(0)
+    , nameTagStringId(0)
+{
+}
+
+bool OsmAnd::MapStyleEvaluationResultsCache::Key::operator==(const Key& that) const
+{
+    return
+        rulesetType == that.rulesetType &&
+        zoom == that.zoom &&
+        tagStringId == that.tagStringId &&
+        valueStringId == that.valueStringId &&
+        layer == that.layer &&
+        isArea == that.isArea &&
+        isPoint == that.isPoint &&
+        isCycle == that.isCycle &&
+        textLength == that.textLength &&
+        nameTagStringId == that.nameTagStringId;
+}
+
+bool OsmAnd::MapStyleEvaluationResultsCache::Key::operator!=(const Key& that) const
+{
+    return !(*this == that);
+}
+
+uint OsmAnd::qHash(const MapStyleEvaluationResultsCache::Key& key, uint seed) Q_DECL_NOTHROW
+{
+    const uint flags =
+        (static_cast<uint>(key.rulesetType) << 24) |
+        (static_cast<uint>(key.zoom) << 16) |
+        (static_cast<uint>(key.isArea) << 2) |
+        (static_cast<uint>(key.isPoint) << 1) |
+        static_cast<uint>(key.isCycle);
+
+    auto hash = ::qHash(flags, seed);
+    hash = qHashCombine(hash, key.tagStringId);
+    hash = qHashCombine(hash, key.valueStringId);
+    hash = qHashCombine(hash, key.layer);
+    hash = qHashCombine(hash, key.textLength);
+    hash = qHashCombine(hash, key.nameTagStringId);
+    return hash;
+}
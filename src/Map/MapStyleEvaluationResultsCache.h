@@ -0,0 +1,97 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_EVALUATION_RESULTS_CACHE_H_
+#define _OSMAND_CORE_MAP_STYLE_EVALUATION_RESULTS_CACHE_H_
+
+#include "stdlib_common.h"
+#include <array>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QReadWriteLock>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "MapCommonTypes.h"
+#include "IMapStyle.h"
+#include "MapStyleEvaluationResult.h"
+
+namespace OsmAnd
+{
+    class MapStyleProgram;
+
+    // Results of map style evaluation by primitiviser, keyed by all inputs it sets up for evaluators. Since
+    // settings are part of inputs too, cache is valid only while settings it was created for are in effect.
+    // Rules that look at map object itself (e.g. "additional" conditions) are not cached. All evaluators of same
+    // ruleset are expected to scale values by same factors of environment.
+    class MapStyleEvaluationResultsCache Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleEvaluationResultsCache);
+    public:
+        enum {
+            ShardsCount = 16,
+            MaxEntriesPerShard = 4096,
+        };
+
+        struct Key
+        {
+            Key(const MapStyleRulesetType rulesetType,
+                const ZoomLevel zoom,
+                const IMapStyle::StringId tagStringId,
+                const IMapStyle::StringId valueStringId);
+
+            MapStyleRulesetType rulesetType;
+            ZoomLevel zoom;
+            IMapStyle::StringId tagStringId;
+            IMapStyle::StringId valueStringId;
+            // Inputs below are left zero for rulesets they are not set for
+            int layer;
+            bool isArea;
+            bool isPoint;
+            bool isCycle;
+            int textLength;
+            IMapStyle::StringId nameTagStringId;
+
+            bool operator==(const Key& that) const;
+            bool operator!=(const Key& that) const;
+        };
+
+        enum class LookupResult
+        {
+            Hit,
+            Miss,
+            Uncacheable,
+        };
+
+    private:
+        struct Entry
+        {
+            bool isCacheable;
+            bool success;
+            MapStyleEvaluationResult::Packed result;
+        };
+
+        struct Shard
+        {
+            mutable QReadWriteLock lock;
+            QHash<Key, Entry> entries;
+        };
+
+        const std::shared_ptr<const MapStyleProgram> _program;
+        std::array<Shard, ShardsCount> _shards;
+
+        Shard& getShard(const Key& key);
+        const Shard& getShard(const Key& key) const;
+    protected:
+    public:
+        MapStyleEvaluationResultsCache(const std::shared_ptr<const IMapStyle>& mapStyle);
+        ~MapStyleEvaluationResultsCache();
+
+        LookupResult obtain(const Key& key, bool& outSuccess, MapStyleEvaluationResult& outResult) const;
+        void insert(const Key& key, const bool success, const MapStyleEvaluationResult& result);
+    };
+
+    uint qHash(const MapStyleEvaluationResultsCache::Key& key, uint seed = 0) Q_DECL_NOTHROW;
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_EVALUATION_RESULTS_CACHE_H_)
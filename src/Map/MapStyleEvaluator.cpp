@@ -52,6 +52,16 @@ void OsmAnd::MapStyleEvaluator::setStringIdValue(
     _p->setStringIdValue(valueDefId, value);
 }
 
+bool OsmAnd::MapStyleEvaluator::isProgramEnabled() const
+{
+    return _p->isProgramEnabled();
+}
+
+void OsmAnd::MapStyleEvaluator::setProgramEnabled(const bool enabled)
+{
+    _p->setProgramEnabled(enabled);
+}
+
 bool OsmAnd::MapStyleEvaluator::evaluate(
     const std::shared_ptr<const MapObject>& mapObject,
     const MapStyleRulesetType rulesetType,
@@ -11,6 +11,8 @@
 #include "MapStyleValueDefinition.h"
 #include "MapStyleEvaluationResult.h"
 #include "MapStyleConstantValue.h"
+#include "MapStyleProgram.h"
+#include "ResolvedMapStyle.h"
 #include "MapObject.h"
 #include "QKeyValueIterator.h"
 #include "Logging.h"
@@ -34,6 +36,25 @@ void OsmAnd::MapStyleEvaluator_P::prepare()
     _inputValuesShadow.reset(new ArrayMap<InputValue>(valueDefinitionsCount));
     _intermediateEvaluationResult.reset(new ArrayMap<IMapStyle::Value>(valueDefinitionsCount));
     _constantIntermediateEvaluationResult.reset(new ArrayMap<IMapStyle::Value>(valueDefinitionsCount));
+
+    setProgramEnabled(true);
+}
+
+bool OsmAnd::MapStyleEvaluator_P::isProgramEnabled() const
+{
+    return _program != nullptr;
+}
+
+void OsmAnd::MapStyleEvaluator_P::setProgramEnabled(const bool enabled)
+{
+    _program.reset();
+    _lastAttributeMapping.reset();
+    _lastMappedAdditionalConditions.reset();
+
+    if (!enabled)
+        return;
+    if (const auto resolvedMapStyle = std::dynamic_pointer_cast<const ResolvedMapStyle>(owner->mapStyle))
+        _program = resolvedMapStyle->getProgram();
 }
 
 OsmAnd::ArrayMap<OsmAnd::IMapStyle::Value>* OsmAnd::MapStyleEvaluator_P::allocateIntermediateEvaluationResult()
@@ -139,7 +160,57 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
             _inputValuesShadow,
             *_intermediateEvaluationResult,
             *outResultStorage,
-            constantEvaluationResult);
+            constantEvaluationResult,
+            false);
+    }
+
+    return true;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluate(
+    const std::shared_ptr<const MapObject>& mapObject,
+    const QHash<TagValueId, uint32_t>& compiledRuleset,
+    const ResolvedMapStyle::StringId tagStringId,
+    const ResolvedMapStyle::StringId valueStringId,
+    MapStyleEvaluationResult* const outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    const auto ruleId = TagValueId::compose(tagStringId, valueStringId);
+    const auto citRuleNode = compiledRuleset.constFind(ruleId);
+    if (citRuleNode == compiledRuleset.cend())
+        return false;
+
+    InputValue inputTag;
+    inputTag.asUInt = tagStringId;
+    _inputValuesShadow->set(_builtinValueDefs->id_INPUT_TAG, inputTag);
+
+    InputValue inputValue;
+    inputValue.asUInt = valueStringId;
+    _inputValuesShadow->set(_builtinValueDefs->id_INPUT_VALUE, inputValue);
+
+    if (outResultStorage)
+        _intermediateEvaluationResult->clear();
+
+    bool wasDisabled = false;
+    const auto success = evaluateCompiled(
+        mapObject.get(),
+        *citRuleNode,
+        _inputValuesShadow,
+        wasDisabled,
+        _intermediateEvaluationResult.get(),
+        constantEvaluationResult);
+    if (!success || wasDisabled)
+        return false;
+
+    if (outResultStorage)
+    {
+        postprocessEvaluationResult(
+            mapObject.get(),
+            _inputValuesShadow,
+            *_intermediateEvaluationResult,
+            *outResultStorage,
+            constantEvaluationResult,
+            true);
     }
 
     return true;
@@ -260,79 +331,10 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 
     // In case rule doesn't have any enabled class in "rClass", stop processing
     const auto citSymbolClassValue = ruleNodeValues.constFind(_builtinValueDefs->id_OUTPUT_CLASS);
-    if (citSymbolClassValue != ruleNodeValues.cend())
+    if (citSymbolClassValue != ruleNodeValues.cend()
+        && !isAnySymbolClassEnabled(mapObject, *citSymbolClassValue, inputValues))
     {
-        bool atLeastOneClassEnabled = false;
-        if (citSymbolClassValue->asDynamicValue.symbolClasses)
-        {
-            const auto& symbolClasses = *citSymbolClassValue->asDynamicValue.symbolClasses;
-            for (const auto& symbolClass : symbolClasses)
-            {
-                const auto& symbolClassDefId = owner->mapStyle->getValueDefinitionIdByNameId(symbolClass->getNameId());
-                if (symbolClassDefId > -1)
-                {
-                    InputValue symbolClassValue;
-                    if (inputValues->get(symbolClassDefId, symbolClassValue))
-                    {
-                        if (symbolClassValue.asUInt != 0)
-                        {
-                            atLeastOneClassEnabled = true;
-                            break;
-                        }
-                    }
-                    else if (symbolClass->getDefaultSetting())
-                    {
-                        atLeastOneClassEnabled = true;
-                        break;
-                    }
-                }
-            }
-        }
-        if (!atLeastOneClassEnabled && citSymbolClassValue->asDynamicValue.symbolClassTemplates)
-        {
-            const auto& symbolClassTemplates = *citSymbolClassValue->asDynamicValue.symbolClassTemplates;
-            for (const auto& symbolClassTemplateId : symbolClassTemplates)
-            {
-                const auto& symbolClassTemplate = owner->mapStyle->getStringById(symbolClassTemplateId);
-                const auto splitPosition = symbolClassTemplate.indexOf(QLatin1Char('$'));
-                const auto& classNameHeadPart = symbolClassTemplate.left(splitPosition - 1);
-                const auto& classNameTagName = symbolClassTemplate.mid(splitPosition + 1);
-                const auto& valueDefId = owner->mapStyle->getValueDefinitionIdByName(classNameTagName);
-                QString classNameTailPart;
-                InputValue inputValue;
-                if (valueDefId > -1 && inputValues->get(valueDefId, inputValue))
-                    classNameTailPart = owner->mapStyle->getStringById(inputValue.asUInt);
-                else if (mapObject)
-                    classNameTailPart = mapObject->getResolvedAttribute(QStringRef(&classNameTagName));
-
-                const auto& className = classNameTailPart.isEmpty() ? classNameHeadPart : classNameHeadPart + QLatin1Char('.') + classNameTailPart;
-                const auto& symbolClassDefId = owner->mapStyle->getValueDefinitionIdByName(className);
-                if (symbolClassDefId > -1)
-                {
-                    InputValue symbolClassValue;
-                    if (inputValues->get(symbolClassDefId, symbolClassValue))
-                    {
-                        if (symbolClassValue.asUInt != 0)
-                        {
-                            atLeastOneClassEnabled = true;
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        const auto& symbolClass = owner->mapStyle->getSymbolClass(className);
-                        if (symbolClass && symbolClass->getDefaultSetting())
-                        {
-                            atLeastOneClassEnabled = true;
-                            break;
-                        }
-                    }
-                }
-
-            }
-        }
-        if (!atLeastOneClassEnabled)
-            return false;
+        return false;
     }
 
     if (outResultStorage && !ruleNode->getIsSwitch())
@@ -383,6 +385,379 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     return true;
 }
 
+OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateCompiledAttribute(
+    const MapObject* const mapObject,
+    const MapStyleValueDataType dataType,
+    const uint32_t attributeNode,
+    const std::shared_ptr<const InputValues>& inputValues,
+    IntermediateEvaluationResult* outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& intermediateEvaluationResult) const
+{
+    bool wasDisabled = false;
+    intermediateEvaluationResult->clear();
+    OnDemand<IntermediateEvaluationResult> innerConstantEvaluationResult(intermediateEvaluationResultAllocator);
+    evaluateCompiled(
+        mapObject,
+        attributeNode,
+        inputValues,
+        wasDisabled,
+        intermediateEvaluationResult.get(),
+        innerConstantEvaluationResult);
+
+    IMapStyle::Value evaluatedValue;
+    switch (dataType)
+    {
+        case MapStyleValueDataType::Boolean:
+            intermediateEvaluationResult->get(_builtinValueDefs->id_OUTPUT_ATTR_BOOL_VALUE, evaluatedValue);
+            break;
+        case MapStyleValueDataType::Integer:
+            intermediateEvaluationResult->get(_builtinValueDefs->id_OUTPUT_ATTR_INT_VALUE, evaluatedValue);
+            break;
+        case MapStyleValueDataType::Float:
+            intermediateEvaluationResult->get(_builtinValueDefs->id_OUTPUT_ATTR_FLOAT_VALUE, evaluatedValue);
+            break;
+        case MapStyleValueDataType::String:
+            intermediateEvaluationResult->get(_builtinValueDefs->id_OUTPUT_ATTR_STRING_VALUE, evaluatedValue);
+            break;
+        case MapStyleValueDataType::Color:
+            intermediateEvaluationResult->get(_builtinValueDefs->id_OUTPUT_ATTR_COLOR_VALUE, evaluatedValue);
+            break;
+    }
+
+    if (!evaluatedValue.isDynamic)
+        return evaluatedValue.asConstantValue;
+
+    return evaluateCompiledConstantValue(
+        mapObject,
+        dataType,
+        evaluatedValue,
+        inputValues,
+        outResultStorage,
+        intermediateEvaluationResult);
+}
+
+OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateCompiledConstantValue(
+    const MapObject* const mapObject,
+    const MapStyleValueDataType dataType,
+    const IMapStyle::Value& resolvedValue,
+    const std::shared_ptr<const InputValues>& inputValues,
+    IntermediateEvaluationResult* outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& intermediateEvaluationResult) const
+{
+    if (!resolvedValue.isDynamic
+        || resolvedValue.asDynamicValue.symbolClasses || resolvedValue.asDynamicValue.symbolClassTemplates)
+        return resolvedValue.asConstantValue;
+
+    const auto attributeNode = _program->getAttributeNode(resolvedValue.asDynamicValue.attribute.get());
+    if (attributeNode == MapStyleProgram::InvalidIndex)
+    {
+        return evaluateConstantValue(
+            mapObject,
+            dataType,
+            resolvedValue,
+            inputValues,
+            outResultStorage,
+            intermediateEvaluationResult);
+    }
+
+    return evaluateCompiledAttribute(
+        mapObject,
+        dataType,
+        attributeNode,
+        inputValues,
+        outResultStorage,
+        intermediateEvaluationResult);
+}
+
+bool OsmAnd::MapStyleEvaluator_P::matchesAdditionalCondition(
+    const MapObject* const mapObject,
+    const uint32_t additionalCondition) const
+{
+    if (_lastAttributeMapping != mapObject->attributeMapping)
+    {
+        _lastAttributeMapping = mapObject->attributeMapping;
+        _lastMappedAdditionalConditions = _program->getMappedAdditionalConditions(_lastAttributeMapping);
+    }
+
+    // Mappings created ad hoc are matched by strings, that's cheaper than resolving them
+    const auto& condition = _program->additionalConditions[additionalCondition];
+    if (!_lastMappedAdditionalConditions)
+    {
+        const auto matches = mapObject->containsAttribute(&condition.tag, &condition.value, true);
+        return condition.isNegated ? !matches : matches;
+    }
+
+    const auto& matchingAttributeIds = _lastMappedAdditionalConditions->matchingAttributeIds[additionalCondition];
+    const auto matchingAttributeIdsCount = static_cast<uint32_t>(matchingAttributeIds.size());
+    bool matches = false;
+    for (const auto attributeId : constOf(mapObject->additionalAttributeIds))
+    {
+        if (attributeId < matchingAttributeIdsCount && matchingAttributeIds.testBit(attributeId))
+        {
+            matches = true;
+            break;
+        }
+    }
+
+    return condition.isNegated ? !matches : matches;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluateCompiled(
+    const MapObject* const mapObject,
+    const uint32_t nodeIndex,
+    const std::shared_ptr<const InputValues>& inputValues,
+    bool& outDisabled,
+    IntermediateEvaluationResult* const outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    const auto& program = *_program;
+    const auto& node = program.nodes[nodeIndex];
+
+    const auto evaluateOperand =
+        [this, mapObject, &program, &inputValues, outResultStorage, &constantEvaluationResult]
+        (const uint32_t operandIndex) -> MapStyleConstantValue
+        {
+            const auto& operand = program.operands[operandIndex];
+            if (operand.attributeNode == MapStyleProgram::InvalidIndex)
+                return operand.value.asConstantValue;
+
+            return evaluateCompiledAttribute(
+                mapObject,
+                operand.dataType,
+                operand.attributeNode,
+                inputValues,
+                outResultStorage,
+                constantEvaluationResult);
+        };
+
+    // All conditions have to match
+    const auto pConditionsEnd = program.conditions.constData() + node.conditionsOffset + node.conditionsCount;
+    for (auto pCondition = program.conditions.constData() + node.conditionsOffset; pCondition != pConditionsEnd; ++pCondition)
+    {
+        const auto& condition = *pCondition;
+        const auto constantRuleValue = evaluateOperand(condition.operand);
+
+        const auto pInputValue = inputValues->getRef(condition.valueDefId);
+        const auto inputValue = pInputValue ? *pInputValue : InputValue();
+
+        bool evaluationResult = false;
+        switch (condition.kind)
+        {
+            case MapStyleProgram::ConditionKind::MinZoom:
+                assert(!constantRuleValue.isComplex);
+                evaluationResult = (constantRuleValue.asSimple.asInt <= inputValue.asInt);
+                break;
+            case MapStyleProgram::ConditionKind::MaxZoom:
+                assert(!constantRuleValue.isComplex);
+                evaluationResult = (constantRuleValue.asSimple.asInt >= inputValue.asInt);
+                break;
+            case MapStyleProgram::ConditionKind::Additional:
+                if (mapObject && condition.additionalCondition != MapStyleProgram::InvalidIndex)
+                    evaluationResult = matchesAdditionalCondition(mapObject, condition.additionalCondition);
+                else if (!mapObject)
+                    evaluationResult = constantRuleValue.asSimple.asInt == inputValue.asInt;
+                else
+                {
+                    assert(!constantRuleValue.isComplex);
+                    const auto valueString = owner->mapStyle->getStringById(constantRuleValue.asSimple.asUInt);
+                    auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
+                    auto notSignIdx = valueString.indexOf(QLatin1Char('!'));
+                    if (notSignIdx == 0)
+                    {
+                        const auto& tagRef = valueString.midRef(notSignIdx + 1);
+                        const auto& valueRef = QStringRef();
+                        evaluationResult = !mapObject->containsAttribute(tagRef, valueRef, true);
+                    }
+                    else if (equalSignIdx >= 0)
+                    {
+                        const auto& tagRef = valueString.midRef(0, equalSignIdx);
+                        const auto& valueRef = valueString.midRef(equalSignIdx + 1);
+                        evaluationResult = mapObject->containsAttribute(tagRef, valueRef, true);
+                    }
+                    else
+                        evaluationResult = mapObject->containsTag(valueString, true);
+                }
+                break;
+            case MapStyleProgram::ConditionKind::Test:
+                evaluationResult = (inputValue.asInt == 1);
+                break;
+            case MapStyleProgram::ConditionKind::Float:
+                evaluationResult = qFuzzyCompare(
+                    constantRuleValue.isComplex
+                        ? constantRuleValue.asComplex.asFloat.evaluate(owner->ptScaleFactor)
+                        : constantRuleValue.asSimple.asFloat,
+                    inputValue.asFloat);
+                break;
+            case MapStyleProgram::ConditionKind::Integer:
+                evaluationResult = (inputValue.asInt == (constantRuleValue.isComplex
+                    ? constantRuleValue.asComplex.asInt.evaluate(owner->ptScaleFactor)
+                    : constantRuleValue.asSimple.asInt));
+                break;
+        }
+
+        if (!evaluationResult)
+            return false;
+    }
+
+    // In case rule sets "disable", stop processing
+    if (node.disableOperand != MapStyleProgram::InvalidIndex)
+    {
+        const auto disableValue = evaluateOperand(node.disableOperand);
+
+        assert(!disableValue.isComplex);
+        if (disableValue.asSimple.asUInt != 0)
+        {
+            outDisabled = true;
+            return false;
+        }
+    }
+
+    // In case rule doesn't have any enabled class in "rClass", stop processing
+    if (node.classOperand != MapStyleProgram::InvalidIndex
+        && !isAnySymbolClassEnabled(mapObject, program.operands[node.classOperand].value, inputValues))
+    {
+        return false;
+    }
+
+    const auto fillResult =
+        [&program, &node, outResultStorage]
+        (const bool allowOverride)
+        {
+            const auto pOutputsEnd = program.outputs.constData() + node.outputsOffset + node.outputsCount;
+            for (auto pOutput = program.outputs.constData() + node.outputsOffset; pOutput != pOutputsEnd; ++pOutput)
+            {
+                if (!allowOverride && outResultStorage->contains(pOutput->valueDefId))
+                    continue;
+                outResultStorage->set(pOutput->valueDefId, program.values[pOutput->value]);
+            }
+        };
+
+    if (outResultStorage && !node.isSwitch)
+        fillResult(true);
+
+    bool atLeastOneConditionalMatched = false;
+    const auto pSubnodes = program.subnodes.constData();
+    for (auto idx = node.oneOfConditionalSubnodesOffset,
+        endIdx = node.oneOfConditionalSubnodesOffset + node.oneOfConditionalSubnodesCount; idx < endIdx; idx++)
+    {
+        const auto evaluationResult = evaluateCompiled(
+            mapObject,
+            pSubnodes[idx],
+            inputValues,
+            outDisabled,
+            outResultStorage,
+            constantEvaluationResult);
+
+        if (evaluationResult)
+        {
+            atLeastOneConditionalMatched = true;
+            break;
+        }
+    }
+    if (!atLeastOneConditionalMatched && node.isSwitch)
+        return false;
+
+    if (outResultStorage && node.isSwitch)
+    {
+        // Fill values from <switch> keeping values previously set by <case>
+        fillResult(false);
+    }
+
+    for (auto idx = node.applySubnodesOffset, endIdx = node.applySubnodesOffset + node.applySubnodesCount;
+        idx < endIdx; idx++)
+    {
+        evaluateCompiled(
+            mapObject,
+            pSubnodes[idx],
+            inputValues,
+            outDisabled,
+            outResultStorage,
+            constantEvaluationResult);
+    }
+
+    if (outDisabled)
+        return false;
+
+    return true;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::isAnySymbolClassEnabled(
+    const MapObject* const mapObject,
+    const IMapStyle::Value& classValue,
+    const std::shared_ptr<const InputValues>& inputValues) const
+{
+    bool atLeastOneClassEnabled = false;
+    if (classValue.asDynamicValue.symbolClasses)
+    {
+        const auto& symbolClasses = *classValue.asDynamicValue.symbolClasses;
+        for (const auto& symbolClass : symbolClasses)
+        {
+            const auto& symbolClassDefId = owner->mapStyle->getValueDefinitionIdByNameId(symbolClass->getNameId());
+            if (symbolClassDefId > -1)
+            {
+                InputValue symbolClassValue;
+                if (inputValues->get(symbolClassDefId, symbolClassValue))
+                {
+                    if (symbolClassValue.asUInt != 0)
+                    {
+                        atLeastOneClassEnabled = true;
+                        break;
+                    }
+                }
+                else if (symbolClass->getDefaultSetting())
+                {
+                    atLeastOneClassEnabled = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (!atLeastOneClassEnabled && classValue.asDynamicValue.symbolClassTemplates)
+    {
+        const auto& symbolClassTemplates = *classValue.asDynamicValue.symbolClassTemplates;
+        for (const auto& symbolClassTemplateId : symbolClassTemplates)
+        {
+            const auto& symbolClassTemplate = owner->mapStyle->getStringById(symbolClassTemplateId);
+            const auto splitPosition = symbolClassTemplate.indexOf(QLatin1Char('$'));
+            const auto& classNameHeadPart = symbolClassTemplate.left(splitPosition - 1);
+            const auto& classNameTagName = symbolClassTemplate.mid(splitPosition + 1);
+            const auto& valueDefId = owner->mapStyle->getValueDefinitionIdByName(classNameTagName);
+            QString classNameTailPart;
+            InputValue inputValue;
+            if (valueDefId > -1 && inputValues->get(valueDefId, inputValue))
+                classNameTailPart = owner->mapStyle->getStringById(inputValue.asUInt);
+            else if (mapObject)
+                classNameTailPart = mapObject->getResolvedAttribute(QStringRef(&classNameTagName));
+
+            const auto& className = classNameTailPart.isEmpty() ? classNameHeadPart : classNameHeadPart + QLatin1Char('.') + classNameTailPart;
+            const auto& symbolClassDefId = owner->mapStyle->getValueDefinitionIdByName(className);
+            if (symbolClassDefId > -1)
+            {
+                InputValue symbolClassValue;
+                if (inputValues->get(symbolClassDefId, symbolClassValue))
+                {
+                    if (symbolClassValue.asUInt != 0)
+                    {
+                        atLeastOneClassEnabled = true;
+                        break;
+                    }
+                }
+                else
+                {
+                    const auto& symbolClass = owner->mapStyle->getSymbolClass(className);
+                    if (symbolClass && symbolClass->getDefaultSetting())
+                    {
+                        atLeastOneClassEnabled = true;
+                        break;
+                    }
+                }
+            }
+
+        }
+    }
+    return atLeastOneClassEnabled;
+}
+
 void OsmAnd::MapStyleEvaluator_P::fillResultFromRuleNode(
     const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
     IntermediateEvaluationResult& outResultStorage,
@@ -412,7 +787,8 @@ void OsmAnd::MapStyleEvaluator_P::postprocessEvaluationResult(
     const std::shared_ptr<const InputValues>& inputValues,
     IntermediateEvaluationResult& intermediateResult,
     MapStyleEvaluationResult& outResultStorage,
-    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult,
+    const bool useProgram) const
 {
     for (const auto idx : intermediateResult.getSetKeysRef())
     {
@@ -422,13 +798,21 @@ void OsmAnd::MapStyleEvaluator_P::postprocessEvaluationResult(
         const auto valueDefId = static_cast<IMapStyle::ValueDefinitionId>(idx);
         const auto& valueDef = owner->mapStyle->getValueDefinitionRefById(valueDefId);
 
-        const auto constantRuleValue = evaluateConstantValue(
-            mapObject,
-            valueDef->dataType,
-            *pValue,
-            inputValues,
-            &intermediateResult,
-            constantEvaluationResult);
+        const auto constantRuleValue = useProgram
+            ? evaluateCompiledConstantValue(
+                mapObject,
+                valueDef->dataType,
+                *pValue,
+                inputValues,
+                &intermediateResult,
+                constantEvaluationResult)
+            : evaluateConstantValue(
+                mapObject,
+                valueDef->dataType,
+                *pValue,
+                inputValues,
+                &intermediateResult,
+                constantEvaluationResult);
 
         QVariant postprocessedValue;
         switch (valueDef->dataType)
@@ -523,53 +907,62 @@ void OsmAnd::MapStyleEvaluator_P::setStringIdValue(
 bool OsmAnd::MapStyleEvaluator_P::evaluate(
     const std::shared_ptr<const MapObject>& mapObject,
     const MapStyleRulesetType rulesetType,
-    MapStyleEvaluationResult* const outResultStorage) const
+    MapStyleEvaluationResult* const outResultStorage,
+    const bool useProgram) const
 {
-    //////////////////////////////////////////////////////////////////////////
-    //if ((mapObject->id >> 1) == 266877135u)
-    //{
-    //    int i = 5;
-    //}
-    //////////////////////////////////////////////////////////////////////////
-
     const auto& ruleset = owner->mapStyle->getRuleset(rulesetType);
+    const auto compiledRuleset = _program
+        ? &_program->rulesets[static_cast<unsigned int>(rulesetType)]
+        : nullptr;
 
     _constantIntermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
 
+    const auto evaluateRule =
+        [this, &mapObject, useProgram, &ruleset, compiledRuleset, outResultStorage, &constantEvaluationResult]
+        (const IMapStyle::StringId tagStringId, const IMapStyle::StringId valueStringId) -> bool
+        {
+            if (useProgram && compiledRuleset)
+            {
+                return evaluate(
+                    mapObject,
+                    *compiledRuleset,
+                    tagStringId,
+                    valueStringId,
+                    outResultStorage,
+                    constantEvaluationResult);
+            }
+
+            return evaluate(
+                mapObject,
+                ruleset,
+                tagStringId,
+                valueStringId,
+                outResultStorage,
+                constantEvaluationResult);
+        };
+
     if (_inputValues->contains(_builtinValueDefs->id_INPUT_TAG) && _inputValues->contains(_builtinValueDefs->id_INPUT_VALUE))
     {
-        const auto evaluationResult = evaluate(
-            mapObject,
-            ruleset,
+        const auto evaluationResult = evaluateRule(
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
-            _inputValues->getRef(_builtinValueDefs->id_INPUT_VALUE)->asUInt,
-            outResultStorage,
-            constantEvaluationResult);
+            _inputValues->getRef(_builtinValueDefs->id_INPUT_VALUE)->asUInt);
         if (evaluationResult)
             return true;
     }
 
     if (_inputValues->contains(_builtinValueDefs->id_INPUT_TAG))
     {
-        const auto evaluationResult = evaluate(
-            mapObject,
-            ruleset,
+        const auto evaluationResult = evaluateRule(
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
-            ResolvedMapStyle::EmptyStringId,
-            outResultStorage,
-            constantEvaluationResult);
+            ResolvedMapStyle::EmptyStringId);
         if (evaluationResult)
             return true;
     }
 
-    const auto evaluationResult = evaluate(
-        mapObject,
-        ruleset,
-        ResolvedMapStyle::EmptyStringId,
+    const auto evaluationResult = evaluateRule(
         ResolvedMapStyle::EmptyStringId,
-        outResultStorage,
-        constantEvaluationResult);
+        ResolvedMapStyle::EmptyStringId);
     if (evaluationResult)
         return true;
 
@@ -578,7 +971,8 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 
 bool OsmAnd::MapStyleEvaluator_P::evaluate(
     const std::shared_ptr<const IMapStyle::IAttribute>& attribute,
-    MapStyleEvaluationResult* const outResultStorage) const
+    MapStyleEvaluationResult* const outResultStorage,
+    const bool useProgram) const
 {
     if (outResultStorage)
         _intermediateEvaluationResult->clear();
@@ -586,14 +980,27 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     _constantIntermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
 
+    const auto attributeNode = useProgram
+        ? _program->getAttributeNode(attribute.get())
+        : MapStyleProgram::InvalidIndex;
+    const auto compiled = (attributeNode != MapStyleProgram::InvalidIndex);
+
     bool wasDisabled = false;
-    const auto success = evaluate(
-        nullptr,
-        attribute->getRootNodeRef(),
-        _inputValues,
-        wasDisabled,
-        _intermediateEvaluationResult.get(),
-        constantEvaluationResult);
+    const auto success = compiled
+        ? evaluateCompiled(
+            nullptr,
+            attributeNode,
+            _inputValues,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult)
+        : evaluate(
+            nullptr,
+            attribute->getRootNodeRef(),
+            _inputValues,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult);
     if (!success || wasDisabled)
         return false;
 
@@ -604,8 +1011,24 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
             _inputValues,
             *_intermediateEvaluationResult,
             *outResultStorage,
-            constantEvaluationResult);
+            constantEvaluationResult,
+            compiled);
     }
 
     return true;
 }
+
+bool OsmAnd::MapStyleEvaluator_P::evaluate(
+    const std::shared_ptr<const MapObject>& mapObject,
+    const MapStyleRulesetType rulesetType,
+    MapStyleEvaluationResult* const outResultStorage) const
+{
+    return evaluate(mapObject, rulesetType, outResultStorage, _program != nullptr);
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluate(
+    const std::shared_ptr<const IMapStyle::IAttribute>& attribute,
+    MapStyleEvaluationResult* const outResultStorage) const
+{
+    return evaluate(attribute, outResultStorage, _program != nullptr);
+}
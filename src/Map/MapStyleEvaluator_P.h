@@ -13,12 +13,13 @@
 #include "PrivateImplementation.h"
 #include "MapStyleConstantValue.h"
 #include "IMapStyle.h"
+#include "MapObject.h"
+#include "MapStyleProgram.h"
 
 namespace OsmAnd
 {
     class MapStyleEvaluationResult;
     class MapStyleBuiltinValueDefinitions;
-    class MapObject;
 
     class MapStyleEvaluator;
     class MapStyleEvaluator_P Q_DECL_FINAL
@@ -39,6 +40,13 @@ namespace OsmAnd
     private:
         const std::shared_ptr<const MapStyleBuiltinValueDefinitions> _builtinValueDefs;
 
+        // Compiled rule trees, if map style provides them. Rule trees are evaluated directly otherwise
+        std::shared_ptr<const MapStyleProgram> _program;
+
+        // Objects being evaluated mostly share same attribute mapping, so last one is remembered
+        mutable std::shared_ptr<const MapObject::AttributeMapping> _lastAttributeMapping;
+        mutable std::shared_ptr<const MapStyleProgram::MappedAdditionalConditions> _lastMappedAdditionalConditions;
+
         typedef ArrayMap<InputValue> InputValues;
         std::shared_ptr<InputValues> _inputValues;
         std::shared_ptr<InputValues> _inputValuesShadow;
@@ -75,6 +83,57 @@ namespace OsmAnd
             MapStyleEvaluationResult* const outResultStorage,
             OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
 
+        bool isAnySymbolClassEnabled(
+            const MapObject* const mapObject,
+            const IMapStyle::Value& symbolClassValue,
+            const std::shared_ptr<const InputValues>& inputValues) const;
+
+        MapStyleConstantValue evaluateCompiledAttribute(
+            const MapObject* const mapObject,
+            const MapStyleValueDataType dataType,
+            const uint32_t attributeNode,
+            const std::shared_ptr<const InputValues>& inputValues,
+            IntermediateEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& intermediateEvaluationResult) const;
+
+        MapStyleConstantValue evaluateCompiledConstantValue(
+            const MapObject* const mapObject,
+            const MapStyleValueDataType dataType,
+            const IMapStyle::Value& resolvedValue,
+            const std::shared_ptr<const InputValues>& inputValues,
+            IntermediateEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& intermediateEvaluationResult) const;
+
+        bool matchesAdditionalCondition(
+            const MapObject* const mapObject,
+            const uint32_t additionalCondition) const;
+
+        bool evaluateCompiled(
+            const MapObject* const mapObject,
+            const uint32_t nodeIndex,
+            const std::shared_ptr<const InputValues>& inputValues,
+            bool& outDisabled,
+            IntermediateEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
+        bool evaluate(
+            const std::shared_ptr<const MapObject>& mapObject,
+            const QHash<TagValueId, uint32_t>& compiledRuleset,
+            const IMapStyle::StringId tagStringId,
+            const IMapStyle::StringId valueStringId,
+            MapStyleEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
+        bool evaluate(
+            const std::shared_ptr<const MapObject>& mapObject,
+            const MapStyleRulesetType rulesetType,
+            MapStyleEvaluationResult* const outResultStorage,
+            const bool useProgram) const;
+        bool evaluate(
+            const std::shared_ptr<const IMapStyle::IAttribute>& attribute,
+            MapStyleEvaluationResult* const outResultStorage,
+            const bool useProgram) const;
+
         void fillResultFromRuleNode(
             const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
             IntermediateEvaluationResult& outResultStorage,
@@ -85,7 +144,8 @@ namespace OsmAnd
             const std::shared_ptr<const InputValues>& inputValues,
             IntermediateEvaluationResult& intermediateResult,
             MapStyleEvaluationResult& outResultStorage,
-            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult,
+            const bool useProgram) const;
     protected:
         MapStyleEvaluator_P(MapStyleEvaluator* owner);
     public:
@@ -102,6 +162,9 @@ namespace OsmAnd
         void setStringValue(const IMapStyle::ValueDefinitionId valueDefId, const QString& value);
         void setStringIdValue(const IMapStyle::ValueDefinitionId valueDefId, const IMapStyle::StringId value);
 
+        bool isProgramEnabled() const;
+        void setProgramEnabled(const bool enabled);
+
         bool evaluate(
             const std::shared_ptr<const MapObject>& mapObject,
             const MapStyleRulesetType rulesetType,
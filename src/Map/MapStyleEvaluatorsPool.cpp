@@ -0,0 +1,117 @@
+#include "MapStyleEvaluatorsPool.h"
+
+#include "QtCommon.h"
+
+#include "MapPresentationEnvironment.h"
+#include "MapPresentationEnvironment_P.h"
+#include "MapStyleBuiltinValueDefinitions.h"
+
+OsmAnd::MapStyleEvaluatorsContext::MapStyleEvaluatorsContext(
+    const MapPresentationEnvironment_P& env,
+    const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings,
+    const ZoomLevel zoom_,
+    const ZoomLevel detailedZoom_,
+    const std::shared_ptr<MapStyleEvaluationResultsCache>& evaluationResultsCache_)
+    : zoom(zoom_)
+    , detailedZoom(detailedZoom_)
+    , evaluationResultsCache(evaluationResultsCache_)
+    , orderEvaluator(env.owner->mapStyle, env.owner->displayDensityFactor * env.owner->mapScaleFactor)
+    , polygonEvaluator(env.owner->mapStyle, env.owner->displayDensityFactor * env.owner->mapScaleFactor)
+    , polylineEvaluator(env.owner->mapStyle, env.owner->displayDensityFactor * env.owner->mapScaleFactor)
+    , pointEvaluator(env.owner->mapStyle, env.owner->displayDensityFactor * env.owner->mapScaleFactor)
+    , textEvaluator(env.owner->mapStyle, env.owner->displayDensityFactor * env.owner->symbolsScaleFactor)
+{
+    const auto& builtinValueDefs = env.owner->styleBuiltinValueDefs;
+
+    // Initialize shared settings for order evaluation
+    env.applyTo(orderEvaluator, settings);
+    orderEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+    orderEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+    // Initialize shared settings for polygon evaluation
+    env.applyTo(polygonEvaluator, settings);
+    polygonEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+    polygonEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+    // Initialize shared settings for polyline evaluation
+    env.applyTo(polylineEvaluator, settings);
+    polylineEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, detailedZoom);
+    polylineEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, detailedZoom);
+
+    // Initialize shared settings for point evaluation
+    env.applyTo(pointEvaluator, settings);
+    pointEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+    pointEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+    // Initialize shared settings for text evaluation
+    env.applyTo(textEvaluator, settings);
+    textEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+    textEvaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+}
+
+OsmAnd::MapStyleEvaluatorsContext::~MapStyleEvaluatorsContext()
+{
+}
+
+OsmAnd::MapStyleEvaluatorsPool::MapStyleEvaluatorsPool(
+    const MapPresentationEnvironment_P& env,
+    const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings)
+    : _env(env)
+    , _settings(settings)
+    , evaluationResultsCache(new MapStyleEvaluationResultsCache(env.owner->mapStyle))
+{
+}
+
+OsmAnd::MapStyleEvaluatorsPool::~MapStyleEvaluatorsPool()
+{
+    for (const auto& idleContexts : constOf(_idleContexts))
+        qDeleteAll(idleContexts);
+}
+
+std::shared_ptr<OsmAnd::MapStyleEvaluatorsContext> OsmAnd::MapStyleEvaluatorsPool::obtainContext(
+    const ZoomLevel zoom,
+    const ZoomLevel detailedZoom) const
+{
+    const auto key = (static_cast<uint32_t>(zoom) << 8) | static_cast<uint32_t>(detailedZoom);
+
+    MapStyleEvaluatorsContext* context = nullptr;
+    {
+        QMutexLocker scopedLocker(&_idleContextsMutex);
+
+        const auto itIdleContexts = _idleContexts.find(key);
+        if (itIdleContexts != _idleContexts.end() && !itIdleContexts->isEmpty())
+            context = itIdleContexts->takeLast();
+    }
+    if (!context)
+        context = new MapStyleEvaluatorsContext(_env, _settings, zoom, detailedZoom, evaluationResultsCache);
+
+    const std::weak_ptr<const MapStyleEvaluatorsPool> weakPool(shared_from_this());
+    return std::shared_ptr<MapStyleEvaluatorsContext>(
+        context,
+        [weakPool]
+        (MapStyleEvaluatorsContext* const context)
+        {
+            if (const auto pool = weakPool.lock())
+                pool->release(context);
+            else
+                delete context;
+        });
+}
+
+void OsmAnd::MapStyleEvaluatorsPool::release(MapStyleEvaluatorsContext* const context) const
+{
+    const auto key = (static_cast<uint32_t>(context->zoom) << 8) | static_cast<uint32_t>(context->detailedZoom);
+
+    {
+        QMutexLocker scopedLocker(&_idleContextsMutex);
+
+        auto& idleContexts = _idleContexts[key];
+        if (idleContexts.size() < MaxIdleContextsPerZoom)
+        {
+            idleContexts.push_back(context);
+            return;
+        }
+    }
+
+    delete context;
+}
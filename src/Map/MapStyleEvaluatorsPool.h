@@ -0,0 +1,85 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_EVALUATORS_POOL_H_
+#define _OSMAND_CORE_MAP_STYLE_EVALUATORS_POOL_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "MapStyleConstantValue.h"
+#include "MapStyleEvaluator.h"
+#include "MapStyleEvaluationResultsCache.h"
+
+namespace OsmAnd
+{
+    class MapPresentationEnvironment_P;
+
+    // Evaluators used by primitiviser, with settings and zoom already applied. Context is used by single
+    // thread at a time, per-object inputs are overwritten before each evaluation.
+    class MapStyleEvaluatorsContext Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleEvaluatorsContext);
+    private:
+    protected:
+    public:
+        MapStyleEvaluatorsContext(
+            const MapPresentationEnvironment_P& env,
+            const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings,
+            const ZoomLevel zoom,
+            const ZoomLevel detailedZoom,
+            const std::shared_ptr<MapStyleEvaluationResultsCache>& evaluationResultsCache);
+        ~MapStyleEvaluatorsContext();
+
+        const ZoomLevel zoom;
+        const ZoomLevel detailedZoom;
+        const std::shared_ptr<MapStyleEvaluationResultsCache> evaluationResultsCache;
+
+        MapStyleEvaluator orderEvaluator;
+        MapStyleEvaluator polygonEvaluator;
+        MapStyleEvaluator polylineEvaluator;
+        MapStyleEvaluator pointEvaluator;
+        MapStyleEvaluator textEvaluator;
+    };
+
+    // Idle evaluators contexts prepared for settings of environment. Pool is replaced on settings change,
+    // contexts borrowed from previous one are destroyed once returned.
+    class MapStyleEvaluatorsPool Q_DECL_FINAL : public std::enable_shared_from_this<MapStyleEvaluatorsPool>
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleEvaluatorsPool);
+    public:
+        enum {
+            // Roughly number of threads that primitivise tiles of same zoom concurrently
+            MaxIdleContextsPerZoom = 8,
+        };
+
+    private:
+        const MapPresentationEnvironment_P& _env;
+        const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > _settings;
+
+        mutable QMutex _idleContextsMutex;
+        mutable QHash< uint32_t, QList<MapStyleEvaluatorsContext*> > _idleContexts;
+
+        void release(MapStyleEvaluatorsContext* const context) const;
+    protected:
+    public:
+        MapStyleEvaluatorsPool(
+            const MapPresentationEnvironment_P& env,
+            const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings);
+        ~MapStyleEvaluatorsPool();
+
+        const std::shared_ptr<MapStyleEvaluationResultsCache> evaluationResultsCache;
+
+        // Context is returned to pool when last reference to it is released
+        std::shared_ptr<MapStyleEvaluatorsContext> obtainContext(
+            const ZoomLevel zoom,
+            const ZoomLevel detailedZoom) const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_EVALUATORS_POOL_H_)
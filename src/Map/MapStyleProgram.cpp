@@ -0,0 +1,403 @@
+#include "MapStyleProgram.h"
+
+#include "stdlib_common.h"
+#include <algorithm>
+
+#include "QtCommon.h"
+
+#include "MapStyleBuiltinValueDefinitions.h"
+#include "MapStyleValueDefinition.h"
+#include "ObfMapSectionInfo.h"
+#include "ObfRoutingSectionInfo.h"
+
+OsmAnd::MapStyleProgram::MapStyleProgram(const IMapStyle& mapStyle)
+    : _builtinValueDefs(MapStyleBuiltinValueDefinitions::get())
+    , _mappedAdditionalConditionsPurgeThreshold(MinMappedAdditionalConditionsPurgeThreshold)
+{
+    for (auto rulesetTypeIdx = 0u; rulesetTypeIdx < MapStyleRulesetTypesCount; rulesetTypeIdx++)
+    {
+        const auto& ruleset = mapStyle.getRuleset(static_cast<MapStyleRulesetType>(rulesetTypeIdx));
+        auto& compiledRuleset = rulesets[rulesetTypeIdx];
+        compiledRuleset.reserve(ruleset.size());
+
+        for (const auto& ruleEntry : rangeOf(constOf(ruleset)))
+            compiledRuleset.insert(ruleEntry.key(), compileNode(mapStyle, ruleEntry.value()->getRootNodeRef()));
+    }
+
+    for (const auto& attribute : constOf(mapStyle.getAttributes()))
+        compileAttribute(mapStyle, attribute);
+
+    resolveMapObjectDependencies();
+
+    // Lookups by tree nodes are needed only while compiling
+    _compiledNodes.clear();
+    _compiledNodes.squeeze();
+    _compiledAdditionalConditions.clear();
+    _compiledAdditionalConditions.squeeze();
+
+    nodes.squeeze();
+    conditions.squeeze();
+    outputs.squeeze();
+    subnodes.squeeze();
+    operands.squeeze();
+    values.squeeze();
+    additionalConditions.squeeze();
+}
+
+OsmAnd::MapStyleProgram::~MapStyleProgram()
+{
+}
+
+uint32_t OsmAnd::MapStyleProgram::compileNode(
+    const IMapStyle& mapStyle,
+    const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode)
+{
+    // Same tree node may be referenced from several places
+    const auto citCompiledNode = _compiledNodes.constFind(ruleNode.get());
+    if (citCompiledNode != _compiledNodes.cend())
+        return *citCompiledNode;
+
+    // Reserve node first, so that nodes referencing themselves via attributes terminate
+    const auto nodeIndex = static_cast<uint32_t>(nodes.size());
+    _compiledNodes.insert(ruleNode.get(), nodeIndex);
+    nodes.push_back(Node());
+
+    Node node;
+    node.isSwitch = ruleNode->getIsSwitch();
+    node.disableOperand = InvalidIndex;
+    node.classOperand = InvalidIndex;
+    node.dependsOnMapObject = false;
+
+    QVector<Condition> nodeConditions;
+    QVector<Output> nodeOutputs;
+    const auto& ruleNodeValues = ruleNode->getValuesRef();
+    for (const auto& ruleValueEntry : rangeOf(constOf(ruleNodeValues)))
+    {
+        const auto valueDefId = ruleValueEntry.key();
+        const auto& valueDef = mapStyle.getValueDefinitionRefById(valueDefId);
+        const auto& value = ruleValueEntry.value();
+
+        if (valueDef->valueClass == MapStyleValueDefinition::Class::Input)
+        {
+            Condition condition;
+            condition.valueDefId = valueDefId;
+            if (valueDefId == _builtinValueDefs->id_INPUT_MINZOOM)
+                condition.kind = ConditionKind::MinZoom;
+            else if (valueDefId == _builtinValueDefs->id_INPUT_MAXZOOM)
+                condition.kind = ConditionKind::MaxZoom;
+            else if (valueDefId == _builtinValueDefs->id_INPUT_ADDITIONAL)
+                condition.kind = ConditionKind::Additional;
+            else if (valueDefId == _builtinValueDefs->id_INPUT_TEST)
+                condition.kind = ConditionKind::Test;
+            else if (valueDef->dataType == MapStyleValueDataType::Float)
+                condition.kind = ConditionKind::Float;
+            else
+                condition.kind = ConditionKind::Integer;
+            condition.operand = compileOperand(mapStyle, value, valueDef->dataType);
+            condition.additionalCondition = InvalidIndex;
+            if (condition.kind == ConditionKind::Additional && !value.isDynamic)
+            {
+                condition.additionalCondition =
+                    compileAdditionalCondition(mapStyle, value.asConstantValue.asSimple.asUInt);
+            }
+            nodeConditions.push_back(condition);
+        }
+        else if (valueDef->valueClass == MapStyleValueDefinition::Class::Output)
+        {
+            Output output;
+            output.valueDefId = valueDefId;
+            output.value = static_cast<uint32_t>(values.size());
+            output.attributeNode = InvalidIndex;
+            if (value.isDynamic && value.asDynamicValue.attribute
+                && !value.asDynamicValue.symbolClasses && !value.asDynamicValue.symbolClassTemplates)
+            {
+                output.attributeNode = compileAttribute(mapStyle, value.asDynamicValue.attribute);
+            }
+            values.push_back(value);
+            nodeOutputs.push_back(output);
+
+            if (valueDefId == _builtinValueDefs->id_OUTPUT_DISABLE)
+                node.disableOperand = compileOperand(mapStyle, value, valueDef->dataType);
+            else if (valueDefId == _builtinValueDefs->id_OUTPUT_CLASS)
+                node.classOperand = compileOperand(mapStyle, value, valueDef->dataType);
+        }
+    }
+
+    // Order of conditions doesn't affect result, so cheapest and most selective ones are tested first
+    const auto getConditionCost =
+        [this]
+        (const Condition& condition) -> int
+        {
+            const auto& operand = operands[condition.operand];
+            if (operand.attributeNode != InvalidIndex)
+                return 3;
+            if (condition.kind == ConditionKind::Additional)
+                return 2;
+            if (condition.kind == ConditionKind::MinZoom || condition.kind == ConditionKind::MaxZoom)
+                return 0;
+            return 1;
+        };
+    std::stable_sort(nodeConditions.begin(), nodeConditions.end(),
+        [&getConditionCost]
+        (const Condition& l, const Condition& r) -> bool
+        {
+            return getConditionCost(l) < getConditionCost(r);
+        });
+
+    node.conditionsOffset = static_cast<uint32_t>(conditions.size());
+    node.conditionsCount = static_cast<uint32_t>(nodeConditions.size());
+    conditions << nodeConditions;
+
+    node.outputsOffset = static_cast<uint32_t>(outputs.size());
+    node.outputsCount = static_cast<uint32_t>(nodeOutputs.size());
+    outputs << nodeOutputs;
+
+    // Subnodes are compiled first, so that indices of each node's subnodes are contiguous
+    QVector<uint32_t> oneOfConditionalSubnodes;
+    for (const auto& subnode : constOf(ruleNode->getOneOfConditionalSubnodesRef()))
+        oneOfConditionalSubnodes.push_back(compileNode(mapStyle, subnode));
+    QVector<uint32_t> applySubnodes;
+    for (const auto& subnode : constOf(ruleNode->getApplySubnodesRef()))
+        applySubnodes.push_back(compileNode(mapStyle, subnode));
+
+    node.oneOfConditionalSubnodesOffset = static_cast<uint32_t>(subnodes.size());
+    node.oneOfConditionalSubnodesCount = static_cast<uint32_t>(oneOfConditionalSubnodes.size());
+    subnodes << oneOfConditionalSubnodes;
+
+    node.applySubnodesOffset = static_cast<uint32_t>(subnodes.size());
+    node.applySubnodesCount = static_cast<uint32_t>(applySubnodes.size());
+    subnodes << applySubnodes;
+
+    nodes[nodeIndex] = node;
+
+    return nodeIndex;
+}
+
+uint32_t OsmAnd::MapStyleProgram::compileOperand(
+    const IMapStyle& mapStyle,
+    const IMapStyle::Value& value,
+    const MapStyleValueDataType dataType)
+{
+    Operand operand;
+    operand.value = value;
+    operand.dataType = dataType;
+    operand.attributeNode = InvalidIndex;
+    if (value.isDynamic && value.asDynamicValue.attribute
+        && !value.asDynamicValue.symbolClasses && !value.asDynamicValue.symbolClassTemplates)
+    {
+        operand.attributeNode = compileAttribute(mapStyle, value.asDynamicValue.attribute);
+    }
+
+    const auto operandIndex = static_cast<uint32_t>(operands.size());
+    operands.push_back(operand);
+    return operandIndex;
+}
+
+uint32_t OsmAnd::MapStyleProgram::compileAttribute(
+    const IMapStyle& mapStyle,
+    const std::shared_ptr<const IMapStyle::IAttribute>& attribute)
+{
+    const auto citCompiledAttribute = _compiledAttributes.constFind(attribute.get());
+    if (citCompiledAttribute != _compiledAttributes.cend())
+        return *citCompiledAttribute;
+
+    const auto nodeIndex = compileNode(mapStyle, attribute->getRootNodeRef());
+    _compiledAttributes.insert(attribute.get(), nodeIndex);
+    return nodeIndex;
+}
+
+void OsmAnd::MapStyleProgram::resolveMapObjectDependencies()
+{
+    // Map object is looked at directly by "additional" conditions and by "rClass" templates
+    for (auto& node : nodes)
+    {
+        for (auto idx = node.conditionsOffset; idx < node.conditionsOffset + node.conditionsCount; idx++)
+        {
+            if (conditions[idx].kind == ConditionKind::Additional)
+                node.dependsOnMapObject = true;
+        }
+        if (node.classOperand != InvalidIndex && operands[node.classOperand].value.asDynamicValue.symbolClassTemplates)
+            node.dependsOnMapObject = true;
+    }
+
+    // Propagate through referenced attributes and subnodes until nothing changes, since attributes
+    // may be referenced in any order and even recursively
+    const auto dependsOnMapObject =
+        [this]
+        (const uint32_t nodeIndex) -> bool
+        {
+            return nodeIndex != InvalidIndex && nodes[nodeIndex].dependsOnMapObject;
+        };
+    bool wasChanged = true;
+    while (wasChanged)
+    {
+        wasChanged = false;
+        for (auto& node : nodes)
+        {
+            if (node.dependsOnMapObject)
+                continue;
+
+            bool nodeDependsOnMapObject = false;
+            for (auto idx = node.conditionsOffset; idx < node.conditionsOffset + node.conditionsCount; idx++)
+                nodeDependsOnMapObject = nodeDependsOnMapObject || dependsOnMapObject(operands[conditions[idx].operand].attributeNode);
+            for (auto idx = node.outputsOffset; idx < node.outputsOffset + node.outputsCount; idx++)
+                nodeDependsOnMapObject = nodeDependsOnMapObject || dependsOnMapObject(outputs[idx].attributeNode);
+            if (node.disableOperand != InvalidIndex)
+                nodeDependsOnMapObject = nodeDependsOnMapObject || dependsOnMapObject(operands[node.disableOperand].attributeNode);
+            const auto subnodesCount = node.oneOfConditionalSubnodesCount + node.applySubnodesCount;
+            for (auto idx = node.oneOfConditionalSubnodesOffset; idx < node.oneOfConditionalSubnodesOffset + subnodesCount; idx++)
+                nodeDependsOnMapObject = nodeDependsOnMapObject || dependsOnMapObject(subnodes[idx]);
+
+            if (nodeDependsOnMapObject)
+            {
+                node.dependsOnMapObject = true;
+                wasChanged = true;
+            }
+        }
+    }
+}
+
+bool OsmAnd::MapStyleProgram::dependsOnMapObject(
+    const MapStyleRulesetType rulesetType,
+    const IMapStyle::StringId tagStringId,
+    const IMapStyle::StringId valueStringId) const
+{
+    const auto& ruleset = rulesets[static_cast<unsigned int>(rulesetType)];
+    const TagValueId rulesIds[] = {
+        TagValueId::compose(tagStringId, valueStringId),
+        TagValueId::compose(tagStringId, IMapStyle::EmptyStringId),
+        TagValueId::compose(IMapStyle::EmptyStringId, IMapStyle::EmptyStringId),
+    };
+    for (const auto& ruleId : rulesIds)
+    {
+        const auto citRuleNode = ruleset.constFind(ruleId);
+        if (citRuleNode != ruleset.cend() && nodes[*citRuleNode].dependsOnMapObject)
+            return true;
+    }
+
+    return false;
+}
+
+uint32_t OsmAnd::MapStyleProgram::getAttributeNode(const IMapStyle::IAttribute* const attribute) const
+{
+    const auto citCompiledAttribute = _compiledAttributes.constFind(attribute);
+    if (citCompiledAttribute == _compiledAttributes.cend())
+        return InvalidIndex;
+    return *citCompiledAttribute;
+}
+
+uint32_t OsmAnd::MapStyleProgram::compileAdditionalCondition(
+    const IMapStyle& mapStyle,
+    const IMapStyle::StringId valueStringId)
+{
+    const auto citAdditionalCondition = _compiledAdditionalConditions.constFind(valueStringId);
+    if (citAdditionalCondition != _compiledAdditionalConditions.cend())
+        return *citAdditionalCondition;
+
+    const auto valueString = mapStyle.getStringById(valueStringId);
+    AdditionalCondition additionalCondition;
+    additionalCondition.isNegated = false;
+    const auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
+    if (valueString.startsWith(QLatin1Char('!')))
+    {
+        additionalCondition.tag = valueString.mid(1);
+        additionalCondition.isNegated = true;
+    }
+    else if (equalSignIdx >= 0)
+    {
+        additionalCondition.tag = valueString.left(equalSignIdx);
+        additionalCondition.value = valueString.mid(equalSignIdx + 1);
+    }
+    else
+        additionalCondition.tag = valueString;
+
+    const auto additionalConditionIndex = static_cast<uint32_t>(additionalConditions.size());
+    additionalConditions.push_back(additionalCondition);
+    _compiledAdditionalConditions.insert(valueStringId, additionalConditionIndex);
+    return additionalConditionIndex;
+}
+
+std::shared_ptr<const OsmAnd::MapStyleProgram::MappedAdditionalConditions>
+OsmAnd::MapStyleProgram::getMappedAdditionalConditions(
+    const std::shared_ptr<const MapObject::AttributeMapping>& attributeMapping) const
+{
+    if (!isLongLivedAttributeMapping(attributeMapping))
+        return nullptr;
+
+    // Mapping that was destroyed may have been replaced by a new one at the same address
+    {
+        QReadLocker scopedLocker(&_mappedAdditionalConditionsLock);
+
+        const auto citMappedAdditionalConditions = _mappedAdditionalConditions.constFind(attributeMapping.get());
+        if (citMappedAdditionalConditions != _mappedAdditionalConditions.cend()
+            && (*citMappedAdditionalConditions)->attributeMapping.lock() == attributeMapping)
+        {
+            return *citMappedAdditionalConditions;
+        }
+    }
+
+    const std::shared_ptr<MappedAdditionalConditions> newMappedAdditionalConditions(new MappedAdditionalConditions());
+    newMappedAdditionalConditions->attributeMapping = attributeMapping;
+    newMappedAdditionalConditions->matchingAttributeIds.resize(additionalConditions.size());
+    for (auto additionalConditionIdx = 0; additionalConditionIdx < additionalConditions.size(); additionalConditionIdx++)
+    {
+        const auto& additionalCondition = additionalConditions[additionalConditionIdx];
+        auto& matchingAttributeIds = newMappedAdditionalConditions->matchingAttributeIds[additionalConditionIdx];
+
+        const auto citTagsGroup = attributeMapping->encodeMap.constFind(&additionalCondition.tag);
+        if (citTagsGroup == attributeMapping->encodeMap.cend())
+            continue;
+
+        const auto setMatchingAttributeId =
+            [&matchingAttributeIds]
+            (const uint32_t attributeId)
+            {
+                if (attributeId >= static_cast<uint32_t>(matchingAttributeIds.size()))
+                    matchingAttributeIds.resize(attributeId + 1);
+                matchingAttributeIds.setBit(attributeId);
+            };
+
+        if (additionalCondition.value.isEmpty())
+        {
+            for (const auto attributeId : constOf(*citTagsGroup))
+                setMatchingAttributeId(attributeId);
+        }
+        else
+        {
+            const auto citAttributeId = citTagsGroup->constFind(&additionalCondition.value);
+            if (citAttributeId != citTagsGroup->cend())
+                setMatchingAttributeId(*citAttributeId);
+        }
+    }
+
+    QWriteLocker scopedLocker(&_mappedAdditionalConditionsLock);
+
+    // Drop entries of mappings that no longer exist
+    if (_mappedAdditionalConditions.size() >= _mappedAdditionalConditionsPurgeThreshold)
+    {
+        auto itEntry = mutableIteratorOf(_mappedAdditionalConditions);
+        while (itEntry.hasNext())
+        {
+            const auto& entry = itEntry.next();
+            if (entry.value()->attributeMapping.expired())
+                itEntry.remove();
+        }
+        _mappedAdditionalConditionsPurgeThreshold = qMax(
+            static_cast<int>(MinMappedAdditionalConditionsPurgeThreshold),
+            _mappedAdditionalConditions.size() * 2);
+    }
+
+    _mappedAdditionalConditions.insert(attributeMapping.get(), newMappedAdditionalConditions);
+    return newMappedAdditionalConditions;
+}
+
+bool OsmAnd::MapStyleProgram::isLongLivedAttributeMapping(
+    const std::shared_ptr<const MapObject::AttributeMapping>& attributeMapping)
+{
+    if (!attributeMapping)
+        return false;
+
+    return attributeMapping == MapObject::defaultAttributeMapping
+        || std::dynamic_pointer_cast<const ObfMapSectionAttributeMapping>(attributeMapping)
+        || std::dynamic_pointer_cast<const ObfRoutingSectionAttributeMapping>(attributeMapping);
+}
@@ -0,0 +1,166 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_PROGRAM_H_
+#define _OSMAND_CORE_MAP_STYLE_PROGRAM_H_
+
+#include "stdlib_common.h"
+#include <array>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QVector>
+#include <QBitArray>
+#include <QReadWriteLock>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "MapCommonTypes.h"
+#include "MapStyleConstantValue.h"
+#include "IMapStyle.h"
+#include "MapObject.h"
+
+namespace OsmAnd
+{
+    class MapStyleBuiltinValueDefinitions;
+
+    // Rule trees of a map style lowered into flat arrays. Each rule node becomes a record that references
+    // contiguous ranges of conditions, outputs and subnodes, so evaluation doesn't need to walk QHash-es
+    // of rule values nor to look up value definitions.
+    class MapStyleProgram Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleProgram);
+    public:
+        enum : uint32_t {
+            InvalidIndex = std::numeric_limits<uint32_t>::max(),
+
+            // Entries of destroyed mappings are dropped once cache grows to this size, then to twice the size left
+            MinMappedAdditionalConditionsPurgeThreshold = 16,
+        };
+
+        enum class ConditionKind : uint8_t
+        {
+            MinZoom,
+            MaxZoom,
+            Additional,
+            Test,
+            Float,
+            Integer,
+        };
+
+        // Rule value that is either constant or has to be evaluated from attribute at runtime
+        struct Operand
+        {
+            IMapStyle::Value value;
+            MapStyleValueDataType dataType;
+            // Index of compiled root node of attribute, if value is dynamic
+            uint32_t attributeNode;
+        };
+
+        struct Condition
+        {
+            IMapStyle::ValueDefinitionId valueDefId;
+            ConditionKind kind;
+            uint32_t operand;
+            // Index in additionalConditions for constant "additional" condition, InvalidIndex otherwise
+            uint32_t additionalCondition;
+        };
+
+        // "additional" condition parsed from "tag=value", "tag" or "!tag" form
+        struct AdditionalCondition
+        {
+            QString tag;
+            // Empty value matches any value of tag
+            QString value;
+            bool isNegated;
+        };
+
+        // Additional conditions resolved against specific attribute mapping: i-th bit array
+        // marks attribute identifiers that satisfy i-th additional condition
+        struct MappedAdditionalConditions
+        {
+            std::weak_ptr<const MapObject::AttributeMapping> attributeMapping;
+            QVector<QBitArray> matchingAttributeIds;
+        };
+
+        struct Output
+        {
+            IMapStyle::ValueDefinitionId valueDefId;
+            uint32_t value;
+            // Index of compiled root node of attribute, if value is dynamic
+            uint32_t attributeNode;
+        };
+
+        struct Node
+        {
+            bool isSwitch;
+            // Ranges are [offset, offset + count)
+            uint32_t conditionsOffset;
+            uint32_t conditionsCount;
+            uint32_t outputsOffset;
+            uint32_t outputsCount;
+            uint32_t oneOfConditionalSubnodesOffset;
+            uint32_t oneOfConditionalSubnodesCount;
+            uint32_t applySubnodesOffset;
+            uint32_t applySubnodesCount;
+            // Operand of "disable" or InvalidIndex
+            uint32_t disableOperand;
+            // Operand of "rClass" or InvalidIndex
+            uint32_t classOperand;
+            // Evaluation of node or anything it references may look at map object itself,
+            // so result isn't defined by input values alone
+            bool dependsOnMapObject;
+        };
+
+    private:
+        const std::shared_ptr<const MapStyleBuiltinValueDefinitions> _builtinValueDefs;
+
+        QHash<const IMapStyle::IRuleNode*, uint32_t> _compiledNodes;
+        QHash<const IMapStyle::IAttribute*, uint32_t> _compiledAttributes;
+        QHash<IMapStyle::StringId, uint32_t> _compiledAdditionalConditions;
+
+        mutable QReadWriteLock _mappedAdditionalConditionsLock;
+        mutable QHash< const MapObject::AttributeMapping*, std::shared_ptr<const MappedAdditionalConditions> >
+            _mappedAdditionalConditions;
+        mutable int _mappedAdditionalConditionsPurgeThreshold;
+
+        uint32_t compileNode(const IMapStyle& mapStyle, const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode);
+        uint32_t compileOperand(
+            const IMapStyle& mapStyle,
+            const IMapStyle::Value& value,
+            const MapStyleValueDataType dataType);
+        uint32_t compileAttribute(const IMapStyle& mapStyle, const std::shared_ptr<const IMapStyle::IAttribute>& attribute);
+        uint32_t compileAdditionalCondition(const IMapStyle& mapStyle, const IMapStyle::StringId valueStringId);
+        void resolveMapObjectDependencies();
+    protected:
+    public:
+        MapStyleProgram(const IMapStyle& mapStyle);
+        ~MapStyleProgram();
+
+        QVector<Node> nodes;
+        QVector<Condition> conditions;
+        QVector<Output> outputs;
+        QVector<uint32_t> subnodes;
+        QVector<Operand> operands;
+        QVector<IMapStyle::Value> values;
+        QVector<AdditionalCondition> additionalConditions;
+
+        std::array< QHash<TagValueId, uint32_t>, MapStyleRulesetTypesCount > rulesets;
+
+        uint32_t getAttributeNode(const IMapStyle::IAttribute* const attribute) const;
+
+        // Checks rules that evaluation of given tag and value may reach in ruleset
+        bool dependsOnMapObject(
+            const MapStyleRulesetType rulesetType,
+            const IMapStyle::StringId tagStringId,
+            const IMapStyle::StringId valueStringId) const;
+
+        // Resolved once per long-lived attribute mapping and kept until either mapping or program is gone.
+        // Mappings created for few objects only are not resolved, nullptr is returned for them
+        std::shared_ptr<const MappedAdditionalConditions> getMappedAdditionalConditions(
+            const std::shared_ptr<const MapObject::AttributeMapping>& attributeMapping) const;
+
+        // Mappings of OBF sections and default one live as long as data they describe
+        static bool isLongLivedAttributeMapping(const std::shared_ptr<const MapObject::AttributeMapping>& attributeMapping);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_PROGRAM_H_)
@@ -0,0 +1,97 @@
+#include "RasterizedTextsCache.h"
+
+#include "QtCommon.h"
+
+#include "HashUtilities.h"
+
+OsmAnd::RasterizedTextsCache::RasterizedTextsCache()
+    : _imagesBytes(0)
+{
+}
+
+OsmAnd::RasterizedTextsCache::~RasterizedTextsCache()
+{
+}
+
+size_t OsmAnd::RasterizedTextsCache::getImageBytes(const sk_sp<const SkImage>& image)
+{
+    return image ? static_cast<size_t>(image->width()) * image->height() * 4 : 0;
+}
+
+std::shared_ptr<const OsmAnd::RasterizedTextsCache::RasterizedText> OsmAnd::RasterizedTextsCache::obtain(
+    const Key& key) const
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    return _rasterizedTexts.value(key);
+}
+
+void OsmAnd::RasterizedTextsCache::insert(
+    const Key& key,
+    const std::shared_ptr<const RasterizedText>& rasterizedText)
+{
+    const auto imageBytes = getImageBytes(rasterizedText->image);
+    if (imageBytes > MaxImagesBytes)
+        return;
+
+    QMutexLocker scopedLocker(&_mutex);
+
+    // Same caption may have been rasterized concurrently by other tile
+    if (_rasterizedTexts.contains(key))
+        return;
+
+    while (!_keys.isEmpty() && _imagesBytes + imageBytes > MaxImagesBytes)
+    {
+        const auto evictedRasterizedText = _rasterizedTexts.take(_keys.dequeue());
+        if (evictedRasterizedText)
+            _imagesBytes -= getImageBytes(evictedRasterizedText->image);
+    }
+
+    _rasterizedTexts.insert(key, rasterizedText);
+    _keys.enqueue(key);
+    _imagesBytes += imageBytes;
+}
+
+OsmAnd::RasterizedTextsCache::Key::Key()
+    : environmentId(0)
+    , scaleFactor(1.0f)
+    , withGlyphsWidth(false)
+{
+}
+
+bool OsmAnd::RasterizedTextsCache::Key::operator==(const Key& that) const
+{
+    return
+        environmentId == that.environmentId &&
+        text == that.text &&
+        backgroundImagesIds == that.backgroundImagesIds &&
+        scaleFactor == that.scaleFactor &&
+        withGlyphsWidth == that.withGlyphsWidth &&
+        style == that.style;
+}
+
+bool OsmAnd::RasterizedTextsCache::Key::operator!=(const Key& that) const
+{
+    return !(*this == that);
+}
+
+uint OsmAnd::qHash(const RasterizedTextsCache::Key& key, uint seed) Q_DECL_NOTHROW
+{
+    const uint flags =
+        (static_cast<uint>(key.style.textAlignment) << 3) |
+        (static_cast<uint>(key.withGlyphsWidth) << 2) |
+        (static_cast<uint>(key.style.bold) << 1) |
+        static_cast<uint>(key.style.italic);
+
+    auto hash = ::qHash(key.text, seed);
+    hash = qHashCombine(hash, key.environmentId);
+    for (const auto backgroundImageId : key.backgroundImagesIds)
+        hash = qHashCombine(hash, backgroundImageId);
+    hash = qHashCombine(hash, flags);
+    hash = qHashCombine(hash, key.style.size);
+    hash = qHashCombine(hash, key.scaleFactor);
+    hash = qHashCombine(hash, key.style.color.argb);
+    hash = qHashCombine(hash, key.style.haloColor.argb);
+    hash = qHashCombine(hash, (key.style.wrapWidth << 8) ^ (key.style.maxLines << 4) ^ key.style.haloRadius);
+    return hash;
+}
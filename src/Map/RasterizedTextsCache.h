@@ -0,0 +1,84 @@
+#ifndef _OSMAND_CORE_RASTERIZED_TEXTS_CACHE_H_
+#define _OSMAND_CORE_RASTERIZED_TEXTS_CACHE_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkImage.h>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "TextRasterizer.h"
+
+namespace OsmAnd
+{
+    // Images of captions rasterized by symbol rasterizer. Same captions with same style repeat across
+    // tiles, so images are shared by reference with rasterized symbols of all of them. Evicted images stay
+    // alive as long as symbols that use them.
+    class RasterizedTextsCache Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(RasterizedTextsCache);
+    public:
+        enum {
+            MaxImagesBytes = 16 * 1024 * 1024,
+        };
+
+        struct Key
+        {
+            Key();
+
+            // Same caption and style may look different in other environment. Unique identifier of environment
+            // is used, since address of destroyed one may be reused by new environment
+            unsigned int environmentId;
+            QString text;
+            // Background is identified by unique identifiers of images it's made of, so icons
+            // reloaded after change of environment settings give new key
+            QVector<uint32_t> backgroundImagesIds;
+            float scaleFactor;
+            bool withGlyphsWidth;
+            TextRasterizer::Style style;
+
+            bool operator==(const Key& that) const;
+            bool operator!=(const Key& that) const;
+        };
+
+        struct RasterizedText
+        {
+            sk_sp<const SkImage> image;
+            QVector<SkScalar> glyphsWidth;
+            float extraTopSpace;
+            float extraBottomSpace;
+            float lineSpacing;
+            float fontAscent;
+        };
+
+    private:
+        mutable QMutex _mutex;
+        QHash< Key, std::shared_ptr<const RasterizedText> > _rasterizedTexts;
+        // Oldest entries are in front
+        QQueue<Key> _keys;
+        size_t _imagesBytes;
+
+        static size_t getImageBytes(const sk_sp<const SkImage>& image);
+    protected:
+    public:
+        RasterizedTextsCache();
+        ~RasterizedTextsCache();
+
+        std::shared_ptr<const RasterizedText> obtain(const Key& key) const;
+        void insert(const Key& key, const std::shared_ptr<const RasterizedText>& rasterizedText);
+    };
+
+    uint qHash(const RasterizedTextsCache::Key& key, uint seed = 0) Q_DECL_NOTHROW;
+}
+
+#endif // !defined(_OSMAND_CORE_RASTERIZED_TEXTS_CACHE_H_)
@@ -2,6 +2,7 @@
 
 #include "Logging.h"
 #include "MapStyleBuiltinValueDefinitions.h"
+#include "MapStyleProgram.h"
 #include "MapStyleValueDefinition.h"
 #include "QKeyValueIterator.h"
 #include "QtCommon.h"
@@ -588,6 +589,9 @@ bool OsmAnd::ResolvedMapStyle_P::resolve()
     if (!mergeAndResolveRulesets())
         return false;
 
+    // Lower resolved rule trees to program, that's what evaluators actually execute
+    _program.reset(new MapStyleProgram(*owner));
+
     return true;
 }
 
@@ -704,3 +708,8 @@ QString OsmAnd::ResolvedMapStyle_P::getStringById(const StringId id) const
         return QString::null;
     return _stringsForwardLUT[id];
 }
+
+std::shared_ptr<const OsmAnd::MapStyleProgram> OsmAnd::ResolvedMapStyle_P::getProgram() const
+{
+    return _program;
+}
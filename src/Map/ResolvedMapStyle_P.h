@@ -20,6 +20,7 @@
 namespace OsmAnd
 {
     class MapStyleValueDefinition;
+    class MapStyleProgram;
 
     class ResolvedMapStyle;
     class ResolvedMapStyle_P Q_DECL_FINAL
@@ -87,6 +88,7 @@ namespace OsmAnd
         QHash<StringId, std::shared_ptr<const IMapStyle::IAttribute> > _attributes;
         QHash<StringId, std::shared_ptr<const IMapStyle::ISymbolClass> > _symbolClasses;
         std::array< QHash<TagValueId, std::shared_ptr<const IMapStyle::IRule> >, MapStyleRulesetTypesCount> _rulesets;
+        std::shared_ptr<const MapStyleProgram> _program;
     public:
         virtual ~ResolvedMapStyle_P();
 
@@ -119,6 +121,8 @@ namespace OsmAnd
 
         QString getStringById(const StringId id) const;
 
+        std::shared_ptr<const MapStyleProgram> getProgram() const;
+
     friend class OsmAnd::ResolvedMapStyle;
     };
 }
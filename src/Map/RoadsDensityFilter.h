@@ -0,0 +1,110 @@
+#ifndef _OSMAND_CORE_ROADS_DENSITY_FILTER_H_
+#define _OSMAND_CORE_ROADS_DENSITY_FILTER_H_
+
+#include "stdlib_common.h"
+#include <limits>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtGlobal>
+#include <QVector>
+#include <QHash>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "Common.h"
+#include "CommonTypes.h"
+
+namespace OsmAnd
+{
+    // Rejects roads that only pass through cells of density zoom which are already crowded by other roads
+    struct RoadsDensityFilter Q_DECL_FINAL
+    {
+        // Road density counters are kept in flat grid unless it's larger than this (in cells)
+        enum {
+            MaxDensityGridCells = 65536,
+        };
+
+        // Roads are walked back to front, so that roads closer to the end are kept first. Returns flags of
+        // rejected roads. If allowDensityGrid is false, counters are always kept in hash
+        inline static QVector<bool> findRejectedRoads(
+            const QVector< const QVector<PointI>* >& roadsPoints31,
+            const int densityZoom,
+            const uint32_t densityLimitPerCell,
+            const bool allowDensityGrid = true)
+        {
+            const auto shift = MaxZoomLevel - densityZoom;
+            QVector<bool> isRejected(roadsPoints31.size(), false);
+            if (roadsPoints31.isEmpty())
+                return isRejected;
+
+            // Find cells points of roads fall into
+            PointI minCell(std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max());
+            PointI maxCell(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min());
+            for (const auto pPoints31 : constOf(roadsPoints31))
+            {
+                const auto pointsCount = pPoints31->size();
+                auto pPoint = pPoints31->constData();
+                for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+                {
+                    const auto x = pPoint->x >> shift;
+                    const auto y = pPoint->y >> shift;
+                    minCell.x = qMin(minCell.x, x);
+                    minCell.y = qMin(minCell.y, y);
+                    maxCell.x = qMax(maxCell.x, x);
+                    maxCell.y = qMax(maxCell.y, y);
+                }
+            }
+
+            // Roads rarely extend far beyond the tile, so counters are kept in flat grid that covers all cells of
+            // road points. Hash is used only if such grid would be too large
+            const auto gridWidth = static_cast<int64_t>(maxCell.x) - minCell.x + 1;
+            const auto gridHeight = static_cast<int64_t>(maxCell.y) - minCell.y + 1;
+            const auto useDensityGrid = allowDensityGrid
+                && maxCell.x >= minCell.x
+                && gridWidth * gridHeight <= MaxDensityGridCells;
+            QVector<uint32_t> densityGrid;
+            QHash<uint64_t, uint32_t> densityMap;
+            if (useDensityGrid)
+                densityGrid.fill(0, static_cast<int>(gridWidth * gridHeight));
+
+            for (auto roadIdx = roadsPoints31.size() - 1; roadIdx >= 0; roadIdx--)
+            {
+                const auto pPoints31 = roadsPoints31[roadIdx];
+
+                auto accept = false;
+                uint64_t prevId = 0;
+                const auto pointsCount = pPoints31->size();
+                auto pPoint = pPoints31->constData();
+                for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+                {
+                    const auto x = pPoint->x >> shift;
+                    const auto y = pPoint->y >> shift;
+                    const uint64_t id = (static_cast<uint64_t>(x) << densityZoom) | y;
+                    if (prevId == id)
+                        continue;
+                    prevId = id;
+
+                    auto& density = useDensityGrid
+                        ? densityGrid[static_cast<int>((y - minCell.y) * gridWidth + (x - minCell.x))]
+                        : densityMap[id];
+                    if (density < densityLimitPerCell)
+                    {
+                        accept = true;
+                        density++;
+                    }
+                }
+                if (!accept)
+                    isRejected[roadIdx] = true;
+            }
+
+            return isRejected;
+        }
+
+    private:
+        RoadsDensityFilter();
+        ~RoadsDensityFilter();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ROADS_DENSITY_FILTER_H_)
@@ -20,6 +20,7 @@
 #include "QCachingIterator.h"
 #include "Stopwatch.h"
 #include "SkiaUtilities.h"
+#include "RasterizedTextsCache.h"
 #include "Utilities.h"
 #include "Logging.h"
 
@@ -129,13 +130,7 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                     }
                 }
 
-                sk_sp<const SkImage> backgroundImage;
-                if (backgroundLayers.size() == 1)
-                    backgroundImage = backgroundLayers.first();
-                else
-                    backgroundImage = SkiaUtilities::mergeImages(backgroundLayers);
                 style
-                    .setBackgroundImage(backgroundImage)
                     .setBold(textSymbol->isBold)
                     .setItalic(textSymbol->isItalic)
                     .setColor(textSymbol->color)
@@ -148,21 +143,49 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                         .setHaloRadius(textSymbol->shadowRadius);
                 }
 
-                float lineSpacing;
-                float fontAscent;
-                float symbolExtraTopSpace;
-                float symbolExtraBottomSpace;
-                QVector<SkScalar> glyphsWidth;
-                const auto rasterizedText = owner->textRasterizer->rasterize(
-                    textSymbol->value,
-                    style,
-                    textSymbol->drawOnPath ? &glyphsWidth : nullptr,
-                    &symbolExtraTopSpace,
-                    &symbolExtraBottomSpace,
-                    &lineSpacing,
-                    &fontAscent);
-                if (!rasterizedText)
-                    continue;
+                RasterizedTextsCache::Key rasterizedTextKey;
+                rasterizedTextKey.environmentId = env->uniqueId;
+                rasterizedTextKey.text = textSymbol->value;
+                rasterizedTextKey.backgroundImagesIds.reserve(backgroundLayers.size());
+                for (const auto& backgroundLayer : constOf(backgroundLayers))
+                    rasterizedTextKey.backgroundImagesIds.push_back(backgroundLayer->uniqueID());
+                rasterizedTextKey.scaleFactor = textSymbol->scaleFactor;
+                rasterizedTextKey.withGlyphsWidth = textSymbol->drawOnPath;
+                rasterizedTextKey.style = style;
+
+                auto cachedRasterizedText = _rasterizedTextsCache.obtain(rasterizedTextKey);
+                if (!cachedRasterizedText)
+                {
+                    sk_sp<const SkImage> backgroundImage;
+                    if (backgroundLayers.size() == 1)
+                        backgroundImage = backgroundLayers.first();
+                    else
+                        backgroundImage = SkiaUtilities::mergeImages(backgroundLayers);
+                    style.setBackgroundImage(backgroundImage);
+
+                    const std::shared_ptr<RasterizedTextsCache::RasterizedText> newRasterizedText(
+                        new RasterizedTextsCache::RasterizedText());
+                    newRasterizedText->image = owner->textRasterizer->rasterize(
+                        textSymbol->value,
+                        style,
+                        textSymbol->drawOnPath ? &newRasterizedText->glyphsWidth : nullptr,
+                        &newRasterizedText->extraTopSpace,
+                        &newRasterizedText->extraBottomSpace,
+                        &newRasterizedText->lineSpacing,
+                        &newRasterizedText->fontAscent);
+                    if (!newRasterizedText->image)
+                        continue;
+
+                    _rasterizedTextsCache.insert(rasterizedTextKey, newRasterizedText);
+                    cachedRasterizedText = newRasterizedText;
+                }
+
+                const auto& rasterizedText = cachedRasterizedText->image;
+                const auto& glyphsWidth = cachedRasterizedText->glyphsWidth;
+                const auto lineSpacing = cachedRasterizedText->lineSpacing;
+                const auto fontAscent = cachedRasterizedText->fontAscent;
+                const auto symbolExtraTopSpace = cachedRasterizedText->extraTopSpace;
+                const auto symbolExtraBottomSpace = cachedRasterizedText->extraBottomSpace;
 
 #if OSMAND_DUMP_SYMBOLS
                 {
@@ -191,7 +214,7 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                     const std::shared_ptr<RasterizedOnPathSymbol> rasterizedSymbol(new RasterizedOnPathSymbol(
                         group,
                         textSymbol));
-                    rasterizedSymbol->image = qMove(rasterizedText);
+                    rasterizedSymbol->image = rasterizedText;
                     rasterizedSymbol->order = textSymbol->order;
                     rasterizedSymbol->contentType = RasterizedSymbol::ContentType::Text;
                     rasterizedSymbol->content = textSymbol->baseValue;
@@ -20,6 +20,7 @@
 #include "MapCommonTypes.h"
 #include "MapPrimitiviser.h"
 #include "SymbolRasterizer.h"
+#include "RasterizedTextsCache.h"
 
 namespace OsmAnd
 {
@@ -37,6 +38,7 @@ namespace OsmAnd
         typedef MapPrimitiviser::TextSymbol::Placement TextSymbolPlacement;
 
     private:
+        mutable RasterizedTextsCache _rasterizedTextsCache;
     protected:
         SymbolRasterizer_P(SymbolRasterizer* const owner);
     public:
@@ -423,6 +423,11 @@ void OsmAnd::NetworkRouteContext::loadRouteSegmentIntersectingTile(int32_t x, in
     return _p->loadRouteSegmentIntersectingTile(x, y, routeKey, map);
 }
 
+void OsmAnd::NetworkRouteContext::loadTiles(const QList<int64_t>& tileIds)
+{
+    _p->loadTiles(tileIds);
+}
+
 int64_t OsmAnd::NetworkRouteContext::getTileId(int32_t x31, int32_t y31, int shiftR) const
 {
     return _p->getTileId(x31, y31, shiftR);
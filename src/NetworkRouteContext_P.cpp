@@ -1,10 +1,13 @@
 #include "NetworkRouteContext_P.h"
 #include "NetworkRouteContext.h"
 
+#include <QMutex>
+
 #include "Road.h"
 #include "IObfsCollection.h"
 #include "ObfDataInterface.h"
 #include "Utilities.h"
+#include "QRunnableFunctor.h"
 
 OsmAnd::NetworkRouteContext_P::NetworkRouteContext_P(NetworkRouteContext* const owner_)
     : owner(owner_)
@@ -23,6 +26,15 @@ QHash<OsmAnd::NetworkRouteKey, QList<std::shared_ptr<OsmAnd::NetworkRouteSegment
     int32_t right = area31.right() >> ZOOM_TO_LOAD_TILES_SHIFT_R;
     int32_t top = area31.top() >> ZOOM_TO_LOAD_TILES_SHIFT_R;
     int32_t bottom = area31.bottom() >> ZOOM_TO_LOAD_TILES_SHIFT_R;
+    QList<int64_t> tileIds;
+    for (int32_t x = left; x <= right; x++)
+    {
+        for (int32_t y = top; y <= bottom; y++)
+        {
+            tileIds.append(getTileId(x << ZOOM_TO_LOAD_TILES_SHIFT_L, y << ZOOM_TO_LOAD_TILES_SHIFT_L));
+        }
+    }
+    loadTiles(tileIds);
     for (int32_t x = left; x <= right; x++)
     {
         for (int32_t y = top; y <= bottom; y++)
@@ -66,6 +78,53 @@ OsmAnd::NetworkRouteContext_P::NetworkRoutesTile OsmAnd::NetworkRouteContext_P::
     return *iterator;
 }
 
+void OsmAnd::NetworkRouteContext_P::loadTiles(const QList<int64_t>& tileIds)
+{
+    QList<int64_t> tileIdsToLoad;
+    QSet<int64_t> queuedTileIds;
+    for (const auto tileId : constOf(tileIds))
+    {
+        if (indexedTiles.contains(tileId) || queuedTileIds.contains(tileId))
+        {
+            continue;
+        }
+        queuedTileIds.insert(tileId);
+        tileIdsToLoad.append(tileId);
+    }
+    if (tileIdsToLoad.isEmpty())
+    {
+        return;
+    }
+    if (tileIdsToLoad.size() == 1)
+    {
+        const auto tileId = tileIdsToLoad.first();
+        indexedTiles.insert(tileId, loadTile(getXFromTileId(tileId), getYFromTileId(tileId), tileId));
+        return;
+    }
+
+    // Tiles are independent from each other, so read them concurrently and index afterwards
+    QMutex loadedTilesMutex;
+    QList<NetworkRoutesTile> loadedTiles;
+    for (const auto tileId : constOf(tileIdsToLoad))
+    {
+        _tilesLoadingThreadPool.start(new QRunnableFunctor(
+            [this, tileId, &loadedTiles, &loadedTilesMutex]
+            (const QRunnableFunctor* const runnable)
+            {
+                const auto tile = loadTile(getXFromTileId(tileId), getYFromTileId(tileId), tileId);
+
+                QMutexLocker scopedLocker(&loadedTilesMutex);
+                loadedTiles.append(tile);
+            }));
+    }
+    _tilesLoadingThreadPool.waitForDone();
+
+    for (const auto& tile : constOf(loadedTiles))
+    {
+        indexedTiles.insert(tile.tileId, tile);
+    }
+}
+
 int64_t OsmAnd::NetworkRouteContext_P::getTileId(int32_t x31, int32_t y31)
 {
     return getTileId(x31, y31, ZOOM_TO_LOAD_TILES_SHIFT_R);
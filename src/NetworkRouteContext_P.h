@@ -6,6 +6,7 @@
 #include "QtExtensions.h"
 #include <QList>
 #include <QHash>
+#include <QThreadPool>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -51,7 +52,10 @@ private:
     };
     
     QHash<int64_t, NetworkRoutesTile> indexedTiles;
+    QThreadPool _tilesLoadingThreadPool;
     
+    void loadTiles(const QList<int64_t>& tileIds);
+
     QHash<NetworkRouteKey, QList< std::shared_ptr<NetworkRouteSegment>>> loadRouteSegmentsBbox(AreaI area, NetworkRouteKey * rKey);
     void loadRouteSegmentIntersectingTile(int32_t x, int32_t y, const NetworkRouteKey * routeKey,
                               QHash<NetworkRouteKey, QList<std::shared_ptr<NetworkRouteSegment>>> & map);
@@ -97,35 +97,53 @@ QList<std::shared_ptr<OsmAnd::NetworkRouteSegment>> OsmAnd::NetworkRouteSelector
     int64_t end = owner->rCtx->getTileId(segment->robj->points31[segment->end].x, segment->robj->points31[segment->end].y);
     queue.append(start);
     queue.append(end);
-    while (!queue.isEmpty() && !isCancelled())
+    while (!queue.isEmpty())
     {
-        int64_t tileID = queue.at(queue.size() - 1);
-        queue.removeAt(queue.size() - 1);
-        if (visitedTiles.contains(tileID))
+        // Whole frontier of not visited tiles is loaded at once, so tiles are read concurrently
+        QList<int64_t> frontier;
+        for (int64_t tileID : constOf(queue))
         {
-            continue;
+            if (visitedTiles.contains(tileID))
+            {
+                continue;
+            }
+            visitedTiles.insert(tileID);
+            frontier.append(tileID);
         }
-        visitedTiles.insert(tileID);
-        QHash<NetworkRouteKey, QList<std::shared_ptr<OsmAnd::NetworkRouteSegment>>> tiles;
-        int32_t xTile = owner->rCtx->getXFromTileId(tileID);
-        int32_t yTile = owner->rCtx->getYFromTileId(tileID);
-        owner->rCtx->loadRouteSegmentIntersectingTile(xTile, yTile, &rkey, tiles);
-        auto it = tiles.find(rkey);
-        if (it == tiles.end())
+        queue.clear();
+        if (isCancelled())
         {
-            continue;
+            break;
         }
-        auto loaded = *it;
-        // stop exploring if no route key even intersects tile (dont check loaded.size() == 0 special case)]
-        for (auto &loadedSegment : loaded)
+        owner->rCtx->loadTiles(frontier);
+        if (isCancelled())
         {
-            if (!objIds.contains(loadedSegment->robj->id.id))
+            break;
+        }
+
+        for (int64_t tileID : constOf(frontier))
+        {
+            QHash<NetworkRouteKey, QList<std::shared_ptr<OsmAnd::NetworkRouteSegment>>> tiles;
+            int32_t xTile = owner->rCtx->getXFromTileId(tileID);
+            int32_t yTile = owner->rCtx->getYFromTileId(tileID);
+            owner->rCtx->loadRouteSegmentIntersectingTile(xTile, yTile, &rkey, tiles);
+            auto it = tiles.find(rkey);
+            if (it == tiles.end())
             {
-                objIds.insert(loadedSegment->robj->id.id);
-                result.append(loadedSegment);
+                continue;
             }
+            auto loaded = *it;
+            // stop exploring if no route key even intersects tile (dont check loaded.size() == 0 special case)]
+            for (auto &loadedSegment : loaded)
+            {
+                if (!objIds.contains(loadedSegment->robj->id.id))
+                {
+                    objIds.insert(loadedSegment->robj->id.id);
+                    result.append(loadedSegment);
+                }
+            }
+            addEnclosedTiles(queue, tileID);
         }
-        addEnclosedTiles(queue, tileID);
     }
     return result;
 }
@@ -397,7 +415,8 @@ QList<std::shared_ptr<OsmAnd::NetworkRouteSelector_P::NetworkRouteSegmentChain>>
         double min = rad + 1;
         const auto &s = start ? chain->start : chain->getLast();
         const auto &last = ch->getLast();
-        for (int i = 0; i < s->robj->points31.size(); i++)
+        // only fact that some points are within radius matters, so stop at first such pair
+        for (int i = 0; i < s->robj->points31.size() && min > rad; i++)
         {
             for (int j = 0; j < last->robj->points31.size(); j++)
             {
@@ -407,6 +426,10 @@ QList<std::shared_ptr<OsmAnd::NetworkRouteSelector_P::NetworkRouteSegmentChain>>
                 if (m < min)
                 {
                     min = m;
+                    if (min <= rad)
+                    {
+                        break;
+                    }
                 }
             }
         }
@@ -459,14 +482,24 @@ QList<std::shared_ptr<OsmAnd::NetworkRouteSelector_P::NetworkRouteSegmentChain>>
     else
     {
         PointI point = owner->rCtx->getPointFromLong(pnt);
-        QMapIterator<int64_t, QList<std::shared_ptr<NetworkRouteSegmentChain>>> it(chains);
-        while (it.hasNext())
+        // keys are ordered by x31 first, so only strip of keys within radius by x31 has to be checked
+        auto it = chains.begin();
+        auto itEnd = chains.end();
+        const double metersPerX31 = OsmAnd::Utilities::distance31(point.x, point.y, point.x + 1024, point.y) / 1024.0;
+        if (metersPerX31 > 0)
+        {
+            const int64_t dx = static_cast<int64_t>(radius / metersPerX31) + 1;
+            const int32_t minX = static_cast<int32_t>(qMax<int64_t>(0, point.x - dx));
+            const int32_t maxX = static_cast<int32_t>(qMin<int64_t>(std::numeric_limits<int32_t>::max() - 1, point.x + dx));
+            it = chains.lowerBound(owner->rCtx->convertPointToLong(minX, 0));
+            itEnd = chains.lowerBound(owner->rCtx->convertPointToLong(maxX + 1, 0));
+        }
+        for (; it != itEnd; ++it)
         {
-            auto e = it.next();
-            PointI point2 = owner->rCtx->getPointFromLong(e.key());
+            PointI point2 = owner->rCtx->getPointFromLong(it.key());
             if (OsmAnd::Utilities::distance31(point.x, point.y, point2.x, point2.y) < radius)
             {
-                for (const std::shared_ptr<NetworkRouteSegmentChain> &c : e.value())
+                for (const std::shared_ptr<NetworkRouteSegmentChain> &c : it.value())
                 {
                     if (!exclude || c != exclude)
                     {
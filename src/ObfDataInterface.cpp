@@ -1363,7 +1363,7 @@ bool OsmAnd::ObfDataInterface::getTransportRoutes(
     const ObfTransportSectionReader::TransportRouteVisitorFunction visitor /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
 {
-    QHash<uint32_t, std::shared_ptr<TransportRoute>> result;
+    QHash<uint32_t, std::shared_ptr<const TransportRoute>> result;
     QHash<const int, QList<uint32_t>> groupPoints;
     QHash<const int, std::shared_ptr<const ObfReader>> readers;
     QHash<const int, std::shared_ptr<const ObfTransportSectionInfo>> sections;
@@ -1400,15 +1400,13 @@ bool OsmAnd::ObfDataInterface::getTransportRoutes(
         auto section = sections[sectionId];
         auto pointers = entry.value();
         qSort(pointers);
-        auto stringTable = std::make_shared<ObfSectionInfo::StringTable>();
         for (const auto& filePointer : pointers)
         {
-            auto transportRoute = OsmAnd::ObfTransportSectionReader::getTransportRoute(reader, section, filePointer, stringTable.get(), false);
-            result[filePointer] = transportRoute;
+            if (queryController && queryController->isAborted())
+                return false;
+
+            result[filePointer] = OsmAnd::ObfTransportSectionReader::obtainTransportRoute(reader, section, filePointer);
         }
-        OsmAnd::ObfTransportSectionReader::initializeStringTable(reader, section, stringTable.get());
-        for (auto r : result.values())
-            OsmAnd::ObfTransportSectionReader::initializeNames(false, stringTable.get(), r);
     }
 
     for (const auto transportRoute : result.values())
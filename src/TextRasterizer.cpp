@@ -58,6 +58,11 @@ bool OsmAnd::TextRasterizer::rasterize(
         outFontAscent);
 }
 
+void OsmAnd::TextRasterizer::getShapingCacheStatistics(unsigned int& outHits, unsigned int& outMisses) const
+{
+    _p->getShapingCacheStatistics(outHits, outMisses);
+}
+
 static std::shared_ptr<const OsmAnd::TextRasterizer> s_defaultTextRasterizer;
 std::shared_ptr<const OsmAnd::TextRasterizer> OsmAnd::TextRasterizer::getDefault()
 {
@@ -12,6 +12,7 @@
 
 #include "ICU.h"
 #include "CoreResourcesEmbeddedBundle.h"
+#include "HashUtilities.h"
 
 //#define OSMAND_LOG_CHARACTERS_WITHOUT_GLYPHS 1
 #ifndef OSMAND_LOG_CHARACTERS_WITHOUT_GLYPHS
@@ -41,14 +42,6 @@ QVector<OsmAnd::TextRasterizer_P::LinePaint> OsmAnd::TextRasterizer_P::evaluateP
     SkPaint paint = _defaultPaint;
     paint.setColor(style.color.toSkColor());
 
-    // Prepare default font
-    SkFont skFont = _defaultFont;
-    skFont.setSize(style.size);
-
-    // NOTE: It's not optimal to create a shared HB font w/o typeface in order to hold only scale
-    // NOTE: See hb_ot_font_set_funcs() implementation
-    const auto hbFontScale = qRound(style.size * HB_FONT_SCALE_FACTOR);
-
     // Transform text style to font style
     const SkFontStyle fontStyle(
         style.bold ? SkFontStyle::kBold_Weight : SkFontStyle::kNormal_Weight,
@@ -138,16 +131,11 @@ QVector<OsmAnd::TextRasterizer_P::LinePaint> OsmAnd::TextRasterizer_P::evaluateP
                 pTextPaint->text = QStringRef(lineRef.string(), position, charSize);
                 pTextPaint->paint = paint;
                 pTextPaint->typeface = typeface;
-                pTextPaint->skFont = skFont;
-                pTextPaint->skFont.setTypeface(typeface->skTypeface);
-                pTextPaint->hbFont = std::shared_ptr<hb_font_t>(
-                    hb_font_create(typeface->hbFace.get()),
-                    hb_font_destroy
-                );
-                hb_font_set_scale(pTextPaint->hbFont.get(), hbFontScale, hbFontScale);
-
-                SkFontMetrics metrics;
-                pTextPaint->skFont.getMetrics(&metrics);
+                const auto fontFace = obtainFontFace(typeface, style.size, style.bold);
+                pTextPaint->skFont = fontFace->skFont;
+                pTextPaint->hbFont = fontFace->hbFont;
+
+                const auto& metrics = fontFace->metrics;
                 pTextPaint->height = pTextPaint->skFont.getSize() * 1.2f;
                 linePaint.maxFontHeight = qMax(linePaint.maxFontHeight, pTextPaint->height);
                 linePaint.minFontHeight = qMin(linePaint.minFontHeight, pTextPaint->height);
@@ -158,9 +146,6 @@ QVector<OsmAnd::TextRasterizer_P::LinePaint> OsmAnd::TextRasterizer_P::evaluateP
                 linePaint.maxFontBottom = qMax(linePaint.maxFontBottom, metrics.fBottom);
                 linePaint.minFontBottom = qMin(linePaint.minFontBottom, metrics.fBottom);
                 linePaint.fontAscent = metrics.fAscent;
-
-                if (style.bold && typeface->skTypeface->fontStyle().weight() <= SkFontStyle::kNormal_Weight)
-                    pTextPaint->skFont.setEmbolden(true);
             }
             else
             {
@@ -175,10 +160,69 @@ QVector<OsmAnd::TextRasterizer_P::LinePaint> OsmAnd::TextRasterizer_P::evaluateP
     return linePaints;
 }
 
-OsmAnd::TextRasterizer_P::GlyphBlock OsmAnd::TextRasterizer_P::preparePart(const TextPaint& textPaint,
-    const QString& text, bool rtl,const std::shared_ptr<hb_buffer_t>& hbBuffer, SkPoint& origin) const
+std::shared_ptr<const OsmAnd::TextRasterizer_P::FontFace> OsmAnd::TextRasterizer_P::obtainFontFace(
+    const std::shared_ptr<const ITypefaceFinder::Typeface>& typeface,
+    const float size,
+    const bool bold) const
 {
-    GlyphBlock glyphBlock;
+    FontFaceKey key;
+    key.typeface = typeface.get();
+    key.size = size;
+    key.bold = bold;
+
+    QMutexLocker scopedLocker(&_fontFacesMutex);
+
+    const auto citFontFace = _fontFaces.constFind(key);
+    if (citFontFace != _fontFaces.cend())
+        return *citFontFace;
+
+    const std::shared_ptr<FontFace> fontFace(new FontFace());
+    fontFace->typeface = typeface;
+
+    fontFace->skFont = _defaultFont;
+    fontFace->skFont.setSize(size);
+    fontFace->skFont.setTypeface(typeface->skTypeface);
+    fontFace->skFont.getMetrics(&fontFace->metrics);
+    if (bold && typeface->skTypeface->fontStyle().weight() <= SkFontStyle::kNormal_Weight)
+        fontFace->skFont.setEmbolden(true);
+
+    // Font is only read by shaping once set up, so it can be shared between threads
+    const auto hbFontScale = qRound(size * HB_FONT_SCALE_FACTOR);
+    fontFace->hbFont = std::shared_ptr<hb_font_t>(
+        hb_font_create(typeface->hbFace.get()),
+        hb_font_destroy
+    );
+    hb_font_set_scale(fontFace->hbFont.get(), hbFontScale, hbFontScale);
+    hb_font_make_immutable(fontFace->hbFont.get());
+
+    insertIntoBoundedCache(_fontFaces, MaxFontFacesCount, key, std::shared_ptr<const FontFace>(fontFace));
+
+    return fontFace;
+}
+
+std::shared_ptr<const OsmAnd::TextRasterizer_P::ShapedText> OsmAnd::TextRasterizer_P::shapeText(
+    const TextPaint& textPaint,
+    const QString& text,
+    bool rtl,
+    const std::shared_ptr<hb_buffer_t>& hbBuffer) const
+{
+    ShapingKey key;
+    key.typeface = textPaint.typeface.get();
+    hb_font_get_scale(textPaint.hbFont.get(), &key.hbFontScale, nullptr);
+    key.rtl = rtl;
+    key.text = text;
+
+    {
+        QReadLocker scopedLocker(&_shapedTextsLock);
+
+        const auto citShapedText = _shapedTexts.constFind(key);
+        if (citShapedText != _shapedTexts.cend())
+        {
+            _shapingCacheHits.fetchAndAddRelaxed(1);
+            return *citShapedText;
+        }
+    }
+    _shapingCacheMisses.fetchAndAddRelaxed(1);
 
     hb_buffer_reset(hbBuffer.get());
     hb_buffer_add_utf16(hbBuffer.get(), reinterpret_cast<const uint16_t*>(text.constData()), text.size(), 0, -1);
@@ -187,15 +231,15 @@ OsmAnd::TextRasterizer_P::GlyphBlock OsmAnd::TextRasterizer_P::preparePart(const
 
     hb_shape(textPaint.hbFont.get(), hbBuffer.get(), nullptr, 0);
 
-    const auto glyphsCount = hb_buffer_get_length(hbBuffer.get());
-    if (glyphsCount == 0)
-        return glyphBlock;
+    const std::shared_ptr<ShapedText> shapedText(new ShapedText());
+    shapedText->typeface = textPaint.typeface;
+    shapedText->advance = SkPoint::Make(0.0f, 0.0f);
 
+    const auto glyphsCount = hb_buffer_get_length(hbBuffer.get());
     const auto pGlyphInfos = hb_buffer_get_glyph_infos(hbBuffer.get(), nullptr);
     const auto pGlyphPositions = hb_buffer_get_glyph_positions(hbBuffer.get(), nullptr);
-
-    SkTextBlobBuilder textBlobBuilder;
-    const auto textBlobRunBuffer = textBlobBuilder.allocRunPos(textPaint.skFont, glyphsCount);
+    shapedText->glyphs.reserve(glyphsCount);
+    shapedText->offsets.reserve(glyphsCount);
     for (auto glyphIdx = 0u; glyphIdx < glyphsCount; glyphIdx++)
     {
         auto codepoint = pGlyphInfos[glyphIdx].codepoint;
@@ -205,9 +249,7 @@ OsmAnd::TextRasterizer_P::GlyphBlock OsmAnd::TextRasterizer_P::preparePart(const
         {
             codepoint = citReplacementCodepoint->second;
         }
-
-        textBlobRunBuffer.glyphs[glyphIdx] = codepoint;
-        glyphBlock.codepoints.push_back(codepoint);
+        shapedText->glyphs.push_back(codepoint);
 
         const auto advance = SkPoint::Make(
             static_cast<float>(pGlyphPositions[glyphIdx].x_advance) / HB_FONT_SCALE_FACTOR,
@@ -217,9 +259,39 @@ OsmAnd::TextRasterizer_P::GlyphBlock OsmAnd::TextRasterizer_P::preparePart(const
             static_cast<float>(pGlyphPositions[glyphIdx].x_offset) / HB_FONT_SCALE_FACTOR,
             -static_cast<float>(pGlyphPositions[glyphIdx].y_offset) / HB_FONT_SCALE_FACTOR
         );
-        textBlobRunBuffer.points()[glyphIdx] = origin + offset;
-        origin += advance;
+        shapedText->offsets.push_back(shapedText->advance + offset);
+        shapedText->advance += advance;
     }
+
+    {
+        QWriteLocker scopedLocker(&_shapedTextsLock);
+
+        // Captions repeat a lot across tiles, so cache rarely reaches the limit
+        insertIntoBoundedCache(_shapedTexts, MaxShapedTextsCount, key, std::shared_ptr<const ShapedText>(shapedText));
+    }
+
+    return shapedText;
+}
+
+OsmAnd::TextRasterizer_P::GlyphBlock OsmAnd::TextRasterizer_P::preparePart(const TextPaint& textPaint,
+    const QString& text, bool rtl,const std::shared_ptr<hb_buffer_t>& hbBuffer, SkPoint& origin) const
+{
+    GlyphBlock glyphBlock;
+
+    const auto shapedText = shapeText(textPaint, text, rtl, hbBuffer);
+    const auto glyphsCount = shapedText->glyphs.size();
+    if (glyphsCount == 0)
+        return glyphBlock;
+
+    SkTextBlobBuilder textBlobBuilder;
+    const auto textBlobRunBuffer = textBlobBuilder.allocRunPos(textPaint.skFont, glyphsCount);
+    for (auto glyphIdx = 0; glyphIdx < glyphsCount; glyphIdx++)
+    {
+        textBlobRunBuffer.glyphs[glyphIdx] = shapedText->glyphs[glyphIdx];
+        textBlobRunBuffer.points()[glyphIdx] = origin + shapedText->offsets[glyphIdx];
+    }
+    origin += shapedText->advance;
+    glyphBlock.codepoints = shapedText->glyphs;
     glyphBlock.textBlob = textBlobBuilder.make();
 
     return glyphBlock;
@@ -711,3 +783,42 @@ bool OsmAnd::TextRasterizer_P::rasterize(
 
     return true;
 }
+
+void OsmAnd::TextRasterizer_P::getShapingCacheStatistics(unsigned int& outHits, unsigned int& outMisses) const
+{
+    outHits = static_cast<unsigned int>(_shapingCacheHits.loadAcquire());
+    outMisses = static_cast<unsigned int>(_shapingCacheMisses.loadAcquire());
+}
+
+bool OsmAnd::TextRasterizer_P::FontFaceKey::operator==(const FontFaceKey& that) const
+{
+    return
+        typeface == that.typeface &&
+        size == that.size &&
+        bold == that.bold;
+}
+
+uint OsmAnd::qHash(const TextRasterizer_P::FontFaceKey& key, uint seed) Q_DECL_NOTHROW
+{
+    auto hash = ::qHash(reinterpret_cast<quintptr>(key.typeface), seed);
+    hash = qHashCombine(hash, key.size);
+    hash = qHashCombine(hash, key.bold);
+    return hash;
+}
+
+bool OsmAnd::TextRasterizer_P::ShapingKey::operator==(const ShapingKey& that) const
+{
+    return
+        typeface == that.typeface &&
+        hbFontScale == that.hbFontScale &&
+        rtl == that.rtl &&
+        text == that.text;
+}
+
+uint OsmAnd::qHash(const TextRasterizer_P::ShapingKey& key, uint seed) Q_DECL_NOTHROW
+{
+    auto hash = ::qHash(key.text, seed);
+    hash = qHashCombine(hash, reinterpret_cast<quintptr>(key.typeface));
+    hash = qHashCombine(hash, (key.hbFontScale << 1) | (key.rtl ? 1 : 0));
+    return hash;
+}
@@ -8,12 +8,17 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
 #include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
 #include <SkCanvas.h>
 #include <SkPaint.h>
 #include <SkFont.h>
+#include <SkFontMetrics.h>
 #include <SkTextBlob.h>
 #include "restore_internal_warnings.h"
 
@@ -39,6 +44,31 @@ namespace OsmAnd
 
         static constexpr auto HB_FONT_SCALE_FACTOR = 64.0f;
 
+        enum {
+            MaxShapedTextsCount = 4096,
+            MaxFontFacesCount = 256,
+        };
+
+        struct FontFaceKey
+        {
+            const ITypefaceFinder::Typeface* typeface;
+            float size;
+            bool bold;
+
+            bool operator==(const FontFaceKey& that) const;
+        };
+
+        // Shaping depends only on typeface, font scale, direction and text itself
+        struct ShapingKey
+        {
+            const ITypefaceFinder::Typeface* typeface;
+            int hbFontScale;
+            bool rtl;
+            QString text;
+
+            bool operator==(const ShapingKey& that) const;
+        };
+
     private:
         SkPaint _defaultPaint;
         SkFont _defaultFont;
@@ -98,6 +128,38 @@ namespace OsmAnd
             SkScalar maxBoundsTop;
             SkScalar width;
         };
+
+        // Fonts and metrics of typeface at given size, shared by text paints of all texts
+        struct FontFace
+        {
+            std::shared_ptr<const ITypefaceFinder::Typeface> typeface;
+            SkFont skFont;
+            std::shared_ptr<hb_font_t> hbFont;
+            SkFontMetrics metrics;
+        };
+        mutable QMutex _fontFacesMutex;
+        mutable QHash< FontFaceKey, std::shared_ptr<const FontFace> > _fontFaces;
+        std::shared_ptr<const FontFace> obtainFontFace(
+            const std::shared_ptr<const ITypefaceFinder::Typeface>& typeface,
+            const float size,
+            const bool bold) const;
+
+        // Glyphs with replacements already applied, positions are relative to origin of the part
+        struct ShapedText
+        {
+            // Retained to keep typeface address used in key valid
+            std::shared_ptr<const ITypefaceFinder::Typeface> typeface;
+            QVector<SkGlyphID> glyphs;
+            QVector<SkPoint> offsets;
+            SkPoint advance;
+        };
+        mutable QReadWriteLock _shapedTextsLock;
+        mutable QHash< ShapingKey, std::shared_ptr<const ShapedText> > _shapedTexts;
+        mutable QAtomicInt _shapingCacheHits;
+        mutable QAtomicInt _shapingCacheMisses;
+        std::shared_ptr<const ShapedText> shapeText(const TextPaint& textPaint, const QString& text, bool rtl,
+            const std::shared_ptr<hb_buffer_t>& hbBuffer) const;
+
         QVector<LinePaint> evaluatePaints(const QVector<QStringRef>& lineRefs, const Style& style) const;
         GlyphBlock preparePart(const TextPaint& textPaint, const QString& text, bool rtl,
             const std::shared_ptr<hb_buffer_t>& hbBuffer, SkPoint& origin) const;
@@ -160,8 +222,13 @@ namespace OsmAnd
             float* const outLineSpacing,
             float* const outFontAscent) const;
 
+        void getShapingCacheStatistics(unsigned int& outHits, unsigned int& outMisses) const;
+
     friend class OsmAnd::TextRasterizer;
     };
+
+    uint qHash(const TextRasterizer_P::FontFaceKey& key, uint seed = 0) Q_DECL_NOTHROW;
+    uint qHash(const TextRasterizer_P::ShapingKey& key, uint seed = 0) Q_DECL_NOTHROW;
 }
 
 #endif // !defined(_OSMAND_CORE_TEXT_RASTERIZER_P_H_)
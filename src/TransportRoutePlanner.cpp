@@ -0,0 +1,71 @@
+#include "TransportRoutePlanner.h"
+#include "TransportRoutePlanner_P.h"
+
+#include "TransportStop.h"
+#include "TransportRoute.h"
+
+OsmAnd::TransportRoutePlanner::TransportRoutePlanner(
+    const std::shared_ptr<const IObfsCollection>& obfsCollection_,
+    const Settings& settings_ /*= Settings()*/)
+    : _p(new TransportRoutePlanner_P(this))
+    , obfsCollection(obfsCollection_)
+    , settings(settings_)
+{
+}
+
+OsmAnd::TransportRoutePlanner::~TransportRoutePlanner()
+{
+}
+
+QList<OsmAnd::TransportRoutePlanner::Journey> OsmAnd::TransportRoutePlanner::planJourneys(
+    const PointI origin31,
+    const PointI destination31,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/) const
+{
+    return _p->planJourneys(origin31, destination31, queryController);
+}
+
+OsmAnd::TransportRoutePlanner::Settings::Settings()
+    : walkSpeed(1.4f)
+    , maxAccessDistance(1000.0f)
+    , maxTransferDistance(300.0f)
+    , maxTransfers(4)
+    , boardingTime(300.0f)
+    , stopDwellTime(30.0f)
+    , defaultSpeed(25.0f)
+{
+    speeds.insert(QLatin1String("bus"), 25.0f);
+    speeds.insert(QLatin1String("trolleybus"), 22.0f);
+    speeds.insert(QLatin1String("share_taxi"), 30.0f);
+    speeds.insert(QLatin1String("tram"), 20.0f);
+    speeds.insert(QLatin1String("light_rail"), 35.0f);
+    speeds.insert(QLatin1String("subway"), 40.0f);
+    speeds.insert(QLatin1String("monorail"), 35.0f);
+    speeds.insert(QLatin1String("train"), 60.0f);
+    speeds.insert(QLatin1String("ferry"), 20.0f);
+    speeds.insert(QLatin1String("funicular"), 10.0f);
+}
+
+OsmAnd::TransportRoutePlanner::Settings::~Settings()
+{
+}
+
+OsmAnd::TransportRoutePlanner::Leg::Leg()
+    : departureTime(0.0f)
+    , arrivalTime(0.0f)
+{
+}
+
+OsmAnd::TransportRoutePlanner::Leg::~Leg()
+{
+}
+
+OsmAnd::TransportRoutePlanner::Journey::Journey()
+    : arrivalTime(0.0f)
+    , ridesCount(0)
+{
+}
+
+OsmAnd::TransportRoutePlanner::Journey::~Journey()
+{
+}
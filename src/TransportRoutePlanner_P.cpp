@@ -0,0 +1,639 @@
+#include "TransportRoutePlanner_P.h"
+#include "TransportRoutePlanner.h"
+
+#include "QtCommon.h"
+#include <QSet>
+#include <QMap>
+#include <QSemaphore>
+
+#include "IObfsCollection.h"
+#include "ObfDataInterface.h"
+#include "ObfReader.h"
+#include "ObfInfo.h"
+#include "ObfTransportSectionInfo.h"
+#include "ObfTransportSectionReader.h"
+#include "TransportStop.h"
+#include "TransportRoute.h"
+#include "TransportStopsInAreaSearch.h"
+#include "IQueryController.h"
+#include "QRunnableFunctor.h"
+#include "QKeyValueIterator.h"
+#include "Stopwatch.h"
+#include "Utilities.h"
+#include "Logging.h"
+
+OsmAnd::TransportRoutePlanner_P::TransportRoutePlanner_P(TransportRoutePlanner* const owner_)
+    : owner(owner_)
+{
+}
+
+OsmAnd::TransportRoutePlanner_P::~TransportRoutePlanner_P()
+{
+    _threadPool.waitForDone();
+}
+
+QList<OsmAnd::TransportRoutePlanner::Journey> OsmAnd::TransportRoutePlanner_P::planJourneys(
+    const PointI origin31,
+    const PointI destination31,
+    const std::shared_ptr<const IQueryController>& queryController) const
+{
+    QList<TransportRoutePlanner::Journey> journeys;
+    const auto& settings = owner->settings;
+    const auto Infinity = std::numeric_limits<float>::infinity();
+
+    auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(settings.maxAccessDistance, origin31);
+    bbox31.enlargeToInclude((AreaI)Utilities::boundingBox31FromAreaInMeters(settings.maxAccessDistance, destination31));
+
+    // Walking all the way is a journey without rides
+    auto bestTargetTime = Infinity;
+    const auto directDistance = static_cast<float>(Utilities::distance31(origin31, destination31));
+    if (directDistance <= settings.maxAccessDistance)
+    {
+        TransportRoutePlanner::Leg leg;
+        leg.start31 = origin31;
+        leg.end31 = destination31;
+        leg.arrivalTime = directDistance / settings.walkSpeed;
+
+        TransportRoutePlanner::Journey journey;
+        journey.arrivalTime = leg.arrivalTime;
+        journey.legs.push_back(leg);
+        journeys.push_back(journey);
+
+        bestTargetTime = journey.arrivalTime;
+    }
+
+    const auto network = obtainNetwork(bbox31, queryController);
+    if (!network)
+        return journeys;
+    const auto stopsCount = network->stops.size();
+
+    QList< std::pair<uint32_t, float> > accessStops;
+    network->findStops(origin31, settings.maxAccessDistance, accessStops);
+    QList< std::pair<uint32_t, float> > egressStops;
+    network->findStops(destination31, settings.maxAccessDistance, egressStops);
+    if (accessStops.isEmpty() || egressStops.isEmpty())
+        return journeys;
+
+    // Round k holds earliest arrival times using at most k rides
+    QVector< QVector<float> > arrivalTimes;
+    QVector< QVector<Label> > labels;
+    QVector< QVector<float> > rideArrivalTimes;
+    QVector< QVector<Ride> > rides;
+    QVector<float> bestArrivalTimes(stopsCount, Infinity);
+    QVector<bool> markedStopsFlags(stopsCount, false);
+    QVector<uint32_t> markedStops;
+
+    arrivalTimes.push_back(QVector<float>(stopsCount, Infinity));
+    labels.push_back(QVector<Label>(stopsCount, { LabelKind::Inherited, 0 }));
+    rideArrivalTimes.push_back(QVector<float>());
+    rides.push_back(QVector<Ride>());
+    for (const auto& accessStop : constOf(accessStops))
+    {
+        const auto time = accessStop.second / settings.walkSpeed;
+        arrivalTimes[0][accessStop.first] = time;
+        labels[0][accessStop.first] = { LabelKind::Access, 0 };
+        bestArrivalTimes[accessStop.first] = time;
+        markedStops.push_back(accessStop.first);
+    }
+
+    QVector<int32_t> patternsFirstPositions(network->patternsRoutes.size(), -1);
+    const auto roundsCount = static_cast<int>(settings.maxTransfers) + 1;
+    for (auto round = 1; round <= roundsCount && !markedStops.isEmpty(); round++)
+    {
+        if (queryController && queryController->isAborted())
+            return journeys;
+
+        // Collect patterns passing marked stops, along with earliest marked position in each
+        QVector<uint32_t> patterns;
+        for (const auto stop : constOf(markedStops))
+        {
+            for (auto idx = network->stopsPatternsOffsets[stop], end = network->stopsPatternsOffsets[stop + 1]; idx < end; idx++)
+            {
+                const auto pattern = network->stopsPatterns[idx];
+                const auto position = static_cast<int32_t>(network->stopsPatternsPositions[idx]);
+                auto& firstPosition = patternsFirstPositions[pattern];
+                if (firstPosition < 0)
+                {
+                    patterns.push_back(pattern);
+                    firstPosition = position;
+                }
+                else if (position < firstPosition)
+                    firstPosition = position;
+            }
+        }
+        std::sort(patterns.begin(), patterns.end());
+
+        QVector<Candidate> candidates;
+        const auto& previousArrivalTimes = arrivalTimes[round - 1];
+        if (patterns.size() < ParallelScanPatternsThreshold)
+        {
+            scanPatterns(
+                *network,
+                patterns,
+                patternsFirstPositions,
+                previousArrivalTimes,
+                bestArrivalTimes,
+                bestTargetTime,
+                candidates);
+        }
+        else
+        {
+            // Patterns are independent within a round, so chunks of them are scanned concurrently
+            const auto chunksCount = (patterns.size() + PatternsPerScanTask - 1) / PatternsPerScanTask;
+            QVector< QVector<Candidate> > chunksCandidates(chunksCount);
+            QSemaphore chunksDone;
+            for (auto chunkIndex = 0; chunkIndex < chunksCount; chunkIndex++)
+            {
+                const auto chunkPatterns = patterns.mid(chunkIndex * PatternsPerScanTask, PatternsPerScanTask);
+                auto& chunkCandidates = chunksCandidates[chunkIndex];
+                _threadPool.start(new QRunnableFunctor(
+                    [this, chunkPatterns, &chunkCandidates, &chunksDone, &network, &patternsFirstPositions,
+                        &previousArrivalTimes, &bestArrivalTimes, bestTargetTime]
+                    (const QRunnableFunctor* const runnable)
+                    {
+                        scanPatterns(
+                            *network,
+                            chunkPatterns,
+                            patternsFirstPositions,
+                            previousArrivalTimes,
+                            bestArrivalTimes,
+                            bestTargetTime,
+                            chunkCandidates);
+                        chunksDone.release();
+                    }));
+            }
+            chunksDone.acquire(chunksCount);
+
+            for (const auto& chunkCandidates : constOf(chunksCandidates))
+                candidates += chunkCandidates;
+        }
+        for (const auto pattern : constOf(patterns))
+            patternsFirstPositions[pattern] = -1;
+
+        arrivalTimes.push_back(arrivalTimes[round - 1]);
+        labels.push_back(QVector<Label>(stopsCount, { LabelKind::Inherited, 0 }));
+        rideArrivalTimes.push_back(QVector<float>(stopsCount, Infinity));
+        rides.push_back(QVector<Ride>(stopsCount));
+        auto& roundArrivalTimes = arrivalTimes[round];
+        auto& roundLabels = labels[round];
+        auto& roundRideArrivalTimes = rideArrivalTimes[round];
+        auto& roundRides = rides[round];
+
+        // Candidates are in order of patterns, so ties are resolved same way regardless of threads
+        QVector<uint32_t> reachedStops;
+        for (const auto& candidate : constOf(candidates))
+        {
+            auto& rideArrivalTime = roundRideArrivalTimes[candidate.stop];
+            if (candidate.arrivalTime >= rideArrivalTime)
+                continue;
+
+            if (rideArrivalTime == Infinity)
+                reachedStops.push_back(candidate.stop);
+            rideArrivalTime = candidate.arrivalTime;
+            roundRides[candidate.stop] = { candidate.pattern, candidate.boardIndex, candidate.alightIndex };
+        }
+
+        markedStops.clear();
+        for (const auto stop : constOf(reachedStops))
+        {
+            const auto time = roundRideArrivalTimes[stop];
+            if (time >= bestArrivalTimes[stop] || time >= bestTargetTime)
+                continue;
+
+            roundArrivalTimes[stop] = time;
+            roundLabels[stop] = { LabelKind::Ride, 0 };
+            bestArrivalTimes[stop] = time;
+            markedStops.push_back(stop);
+            markedStopsFlags[stop] = true;
+        }
+
+        // Transfers start only from stops reached by ride in this round
+        const auto rideMarkedStopsCount = markedStops.size();
+        for (auto markedIndex = 0; markedIndex < rideMarkedStopsCount; markedIndex++)
+        {
+            const auto stop = markedStops[markedIndex];
+            for (auto idx = network->transfersOffsets[stop], end = network->transfersOffsets[stop + 1]; idx < end; idx++)
+            {
+                const auto target = network->transfersTargets[idx];
+                const auto time = roundRideArrivalTimes[stop] + network->transfersDistances[idx] / settings.walkSpeed;
+                if (time >= bestArrivalTimes[target] || time >= bestTargetTime)
+                    continue;
+
+                roundArrivalTimes[target] = time;
+                roundLabels[target] = { LabelKind::Transfer, stop };
+                bestArrivalTimes[target] = time;
+                if (!markedStopsFlags[target])
+                {
+                    markedStops.push_back(target);
+                    markedStopsFlags[target] = true;
+                }
+            }
+        }
+        for (const auto stop : constOf(markedStops))
+            markedStopsFlags[stop] = false;
+
+        // Journey with this many rides is kept only if it arrives earlier than ones with fewer rides
+        auto roundBestTargetTime = Infinity;
+        auto roundEgressStop = 0u;
+        auto roundEgressDistance = 0.0f;
+        for (const auto& egressStop : constOf(egressStops))
+        {
+            const auto time = roundArrivalTimes[egressStop.first] + egressStop.second / settings.walkSpeed;
+            if (time < roundBestTargetTime)
+            {
+                roundBestTargetTime = time;
+                roundEgressStop = egressStop.first;
+                roundEgressDistance = egressStop.second;
+            }
+        }
+        if (roundBestTargetTime >= bestTargetTime)
+            continue;
+        bestTargetTime = roundBestTargetTime;
+
+        TransportRoutePlanner::Journey journey;
+        journey.arrivalTime = roundBestTargetTime;
+
+        TransportRoutePlanner::Leg egressLeg;
+        egressLeg.fromStop = network->stops[roundEgressStop];
+        egressLeg.start31 = network->stopsPositions31[roundEgressStop];
+        egressLeg.end31 = destination31;
+        egressLeg.departureTime = roundArrivalTimes[roundEgressStop];
+        egressLeg.arrivalTime = roundBestTargetTime;
+        journey.legs.prepend(egressLeg);
+
+        auto stop = roundEgressStop;
+        auto labelRound = round;
+        for (;;)
+        {
+            while (labelRound > 0 && labels[labelRound][stop].kind == LabelKind::Inherited)
+                labelRound--;
+            const auto& label = labels[labelRound][stop];
+
+            if (labelRound == 0)
+            {
+                TransportRoutePlanner::Leg accessLeg;
+                accessLeg.toStop = network->stops[stop];
+                accessLeg.start31 = origin31;
+                accessLeg.end31 = network->stopsPositions31[stop];
+                accessLeg.arrivalTime = arrivalTimes[0][stop];
+                journey.legs.prepend(accessLeg);
+                break;
+            }
+
+            auto alightStop = stop;
+            if (label.kind == LabelKind::Transfer)
+            {
+                alightStop = label.transferFrom;
+
+                TransportRoutePlanner::Leg transferLeg;
+                transferLeg.fromStop = network->stops[alightStop];
+                transferLeg.toStop = network->stops[stop];
+                transferLeg.start31 = network->stopsPositions31[alightStop];
+                transferLeg.end31 = network->stopsPositions31[stop];
+                transferLeg.departureTime = rideArrivalTimes[labelRound][alightStop];
+                transferLeg.arrivalTime = arrivalTimes[labelRound][stop];
+                journey.legs.prepend(transferLeg);
+            }
+
+            const auto& ride = rides[labelRound][alightStop];
+            const auto boardStop = network->patternsStops[ride.boardIndex];
+
+            TransportRoutePlanner::Leg rideLeg;
+            rideLeg.route = network->patternsRoutes[ride.pattern];
+            rideLeg.fromStop = network->stops[boardStop];
+            rideLeg.toStop = network->stops[alightStop];
+            rideLeg.start31 = network->stopsPositions31[boardStop];
+            rideLeg.end31 = network->stopsPositions31[alightStop];
+            rideLeg.arrivalTime = rideArrivalTimes[labelRound][alightStop];
+            rideLeg.departureTime = rideLeg.arrivalTime -
+                (network->patternsTimes[ride.alightIndex] - network->patternsTimes[ride.boardIndex]);
+            journey.legs.prepend(rideLeg);
+            journey.ridesCount++;
+
+            stop = boardStop;
+            labelRound--;
+        }
+
+        journeys.push_back(journey);
+    }
+
+    return journeys;
+}
+
+void OsmAnd::TransportRoutePlanner_P::scanPatterns(
+    const Network& network,
+    const QVector<uint32_t>& patterns,
+    const QVector<int32_t>& patternsFirstPositions,
+    const QVector<float>& previousArrivalTimes,
+    const QVector<float>& bestArrivalTimes,
+    const float targetBound,
+    QVector<Candidate>& outCandidates) const
+{
+    const auto Infinity = std::numeric_limits<float>::infinity();
+    const auto boardingTime = owner->settings.boardingTime;
+
+    for (const auto pattern : constOf(patterns))
+    {
+        auto boarded = false;
+        auto boardTime = 0.0f;
+        auto boardIndex = 0u;
+        const auto end = network.patternsOffsets[pattern + 1];
+        for (auto idx = network.patternsOffsets[pattern] + patternsFirstPositions[pattern]; idx < end; idx++)
+        {
+            const auto stop = network.patternsStops[idx];
+            if (boarded)
+            {
+                const auto arrivalTime = boardTime + (network.patternsTimes[idx] - network.patternsTimes[boardIndex]);
+                if (arrivalTime < bestArrivalTimes[stop] && arrivalTime < targetBound)
+                    outCandidates.push_back({ stop, arrivalTime, pattern, boardIndex, idx });
+            }
+
+            // Board here if vehicle boarded earlier can't be caught yet or this is faster
+            const auto previousArrivalTime = previousArrivalTimes[stop];
+            if (previousArrivalTime == Infinity)
+                continue;
+            const auto departureTime = previousArrivalTime + boardingTime;
+            if (!boarded || departureTime < boardTime + (network.patternsTimes[idx] - network.patternsTimes[boardIndex]))
+            {
+                boarded = true;
+                boardTime = departureTime;
+                boardIndex = idx;
+            }
+        }
+    }
+}
+
+std::shared_ptr<const OsmAnd::TransportRoutePlanner_P::Network> OsmAnd::TransportRoutePlanner_P::obtainNetwork(
+    const AreaI bbox31,
+    const std::shared_ptr<const IQueryController>& queryController) const
+{
+    const auto dataInterface = owner->obfsCollection->obtainDataInterface(
+        &bbox31,
+        MinZoomLevel,
+        MaxZoomLevel,
+        ObfDataTypesMask().set(ObfDataType::Transport));
+
+    // Areas of transport sections are in coordinates of transport stops zoom
+    const auto shift = 31 - TransportStopsInAreaSearch::TRANSPORT_STOP_ZOOM;
+    const AreaI stopsBBox(bbox31.top() >> shift, bbox31.left() >> shift, bbox31.bottom() >> shift, bbox31.right() >> shift);
+    struct SectionEntry
+    {
+        SectionId id;
+        std::shared_ptr<const ObfTransportSectionInfo> section;
+        std::shared_ptr<const ObfReader> reader;
+    };
+    QList<SectionEntry> sectionsEntries;
+    for (const auto& obfReader : constOf(dataInterface->obfReaders))
+    {
+        if (queryController && queryController->isAborted())
+            return nullptr;
+
+        const auto& obfInfo = obfReader->obtainInfo();
+        for (const auto& transportSection : constOf(obfInfo->transportSections))
+        {
+            if (transportSection->stopsLength == 0)
+                continue;
+            if (!transportSection->area31.contains(stopsBBox) &&
+                !transportSection->area31.intersects(stopsBBox) &&
+                !stopsBBox.contains(transportSection->area31))
+            {
+                continue;
+            }
+
+            const SectionId sectionId(obfReader->obfFile->filePath, transportSection->offset);
+            sectionsEntries.push_back({ sectionId, transportSection.shared_ptr(), obfReader });
+        }
+    }
+    if (sectionsEntries.isEmpty())
+        return nullptr;
+
+    // Same sections give same network regardless of order of readers or of OBF reloads
+    std::sort(sectionsEntries.begin(), sectionsEntries.end(),
+        []
+        (const SectionEntry& l, const SectionEntry& r) -> bool
+        {
+            return l.id < r.id;
+        });
+
+    QList<SectionId> sectionsIds;
+    QList< std::shared_ptr<const ObfTransportSectionInfo> > sections;
+    QList< std::shared_ptr<const ObfReader> > readers;
+    for (const auto& sectionEntry : constOf(sectionsEntries))
+    {
+        sectionsIds.push_back(sectionEntry.id);
+        sections.push_back(sectionEntry.section);
+        readers.push_back(sectionEntry.reader);
+    }
+
+    {
+        QMutexLocker scopedLocker(&_networksMutex);
+
+        for (const auto& network : constOf(_networks))
+        {
+            if (network->sectionsIds == sectionsIds)
+                return network;
+        }
+    }
+
+    const auto network = buildNetwork(dataInterface, sectionsIds, readers, sections);
+
+    {
+        QMutexLocker scopedLocker(&_networksMutex);
+
+        _networks.push_back(network);
+        while (_networks.size() > MaxCachedNetworksCount)
+            _networks.removeFirst();
+    }
+
+    return network;
+}
+
+std::shared_ptr<const OsmAnd::TransportRoutePlanner_P::Network> OsmAnd::TransportRoutePlanner_P::buildNetwork(
+    const std::shared_ptr<ObfDataInterface>& dataInterface,
+    const QList<SectionId>& sectionsIds,
+    const QList< std::shared_ptr<const ObfReader> >& readers,
+    const QList< std::shared_ptr<const ObfTransportSectionInfo> >& sections) const
+{
+    const Stopwatch buildStopwatch(true);
+    const auto& settings = owner->settings;
+
+    const std::shared_ptr<Network> network(new Network());
+    network->sectionsIds = sectionsIds;
+
+    // Same stop or route may be present in several sections, they are identified by ID
+    QHash<uint64_t, uint32_t> stopsIndices;
+    const auto obtainStopIndex =
+        [network, &stopsIndices]
+        (const std::shared_ptr<const TransportStop>& stop) -> uint32_t
+        {
+            const auto citStopIndex = stopsIndices.constFind(stop->id.id);
+            if (citStopIndex != stopsIndices.cend())
+                return *citStopIndex;
+
+            const auto stopIndex = static_cast<uint32_t>(network->stops.size());
+            network->stops.push_back(stop);
+            network->stopsPositions31.push_back(Utilities::convertLatLonTo31(stop->location));
+            stopsIndices.insert(stop->id.id, stopIndex);
+            return stopIndex;
+        };
+
+    QSet<uint64_t> routesIds;
+    network->patternsOffsets.push_back(0);
+    for (auto sectionIndex = 0; sectionIndex < sections.size(); sectionIndex++)
+    {
+        const auto& reader = readers[sectionIndex];
+        const auto& section = sections[sectionIndex];
+
+        QList< std::shared_ptr<const TransportStop> > sectionStops;
+        ObfTransportSectionReader::searchTransportStops(reader, section, &sectionStops);
+
+        // References to routes are offsets in OBF file, route may be stored in another transport section of it,
+        // same as ObfDataInterface::getTransportRoutes() resolves them
+        const auto obfInfo = reader->obtainInfo();
+        QMap< uint32_t, std::shared_ptr<const ObfTransportSectionInfo> > routesSections;
+        for (const auto& stop : constOf(sectionStops))
+        {
+            obtainStopIndex(stop);
+            for (const auto routeOffset : constOf(stop->referencesToRoutes))
+            {
+                if (routesSections.contains(routeOffset))
+                    continue;
+
+                const auto routeSection = dataInterface->getTransportSectionInfo(obfInfo->transportSections, routeOffset);
+                if (routeSection)
+                    routesSections.insert(routeOffset, routeSection);
+            }
+        }
+
+        for (const auto& routeSectionEntry : rangeOf(constOf(routesSections)))
+        {
+            const auto route = ObfTransportSectionReader::obtainTransportRoute(
+                reader,
+                routeSectionEntry.value(),
+                routeSectionEntry.key());
+            if (!route || route->forwardStops.size() < 2 || routesIds.contains(route->id.id))
+                continue;
+            routesIds.insert(route->id.id);
+
+            const auto speed = getPatternSpeed(route);
+            network->patternsRoutes.push_back(route);
+
+            auto time = 0.0f;
+            for (auto stopPosition = 0; stopPosition < route->forwardStops.size(); stopPosition++)
+            {
+                const auto stopIndex = obtainStopIndex(route->forwardStops[stopPosition]);
+                if (stopPosition > 0)
+                {
+                    const auto previousStopIndex = network->patternsStops.last();
+                    const auto distance = Utilities::distance31(
+                        network->stopsPositions31[previousStopIndex],
+                        network->stopsPositions31[stopIndex]);
+                    time += static_cast<float>(distance / speed) + settings.stopDwellTime;
+                }
+
+                network->patternsStops.push_back(stopIndex);
+                network->patternsTimes.push_back(time);
+            }
+            network->patternsOffsets.push_back(network->patternsStops.size());
+        }
+    }
+    const auto stopsCount = network->stops.size();
+    const auto patternsCount = network->patternsRoutes.size();
+
+    // Patterns by stop
+    network->stopsPatternsOffsets.fill(0, stopsCount + 1);
+    for (const auto stopIndex : constOf(network->patternsStops))
+        network->stopsPatternsOffsets[stopIndex + 1]++;
+    for (auto stopIndex = 0; stopIndex < stopsCount; stopIndex++)
+        network->stopsPatternsOffsets[stopIndex + 1] += network->stopsPatternsOffsets[stopIndex];
+    network->stopsPatterns.resize(network->patternsStops.size());
+    network->stopsPatternsPositions.resize(network->patternsStops.size());
+    auto stopsPatternsInsertPositions = network->stopsPatternsOffsets;
+    for (auto patternIndex = 0; patternIndex < patternsCount; patternIndex++)
+    {
+        const auto begin = network->patternsOffsets[patternIndex];
+        for (auto idx = begin, end = network->patternsOffsets[patternIndex + 1]; idx < end; idx++)
+        {
+            const auto position = stopsPatternsInsertPositions[network->patternsStops[idx]]++;
+            network->stopsPatterns[position] = patternIndex;
+            network->stopsPatternsPositions[position] = idx - begin;
+        }
+    }
+
+    // Stops ordered by x31
+    network->stopsByX.resize(stopsCount);
+    for (auto stopIndex = 0; stopIndex < stopsCount; stopIndex++)
+        network->stopsByX[stopIndex] = stopIndex;
+    std::sort(network->stopsByX.begin(), network->stopsByX.end(),
+        [network]
+        (const uint32_t l, const uint32_t r) -> bool
+        {
+            return network->stopsPositions31[l].x < network->stopsPositions31[r].x;
+        });
+    network->stopsByXKeys.reserve(stopsCount);
+    for (const auto stopIndex : constOf(network->stopsByX))
+        network->stopsByXKeys.push_back(network->stopsPositions31[stopIndex].x);
+
+    // Transfers between nearby stops
+    network->transfersOffsets.reserve(stopsCount + 1);
+    network->transfersOffsets.push_back(0);
+    QList< std::pair<uint32_t, float> > nearbyStops;
+    for (auto stopIndex = 0; stopIndex < stopsCount; stopIndex++)
+    {
+        nearbyStops.clear();
+        network->findStops(network->stopsPositions31[stopIndex], settings.maxTransferDistance, nearbyStops);
+        for (const auto& nearbyStop : constOf(nearbyStops))
+        {
+            if (nearbyStop.first == static_cast<uint32_t>(stopIndex))
+                continue;
+
+            network->transfersTargets.push_back(nearbyStop.first);
+            network->transfersDistances.push_back(nearbyStop.second);
+        }
+        network->transfersOffsets.push_back(network->transfersTargets.size());
+    }
+
+    LogPrintf(LogSeverityLevel::Debug,
+        "Transport network of %d sections: %d stops, %d patterns, %d transfers, built in %fs",
+        sections.size(),
+        stopsCount,
+        patternsCount,
+        network->transfersTargets.size(),
+        buildStopwatch.elapsed());
+
+    return network;
+}
+
+float OsmAnd::TransportRoutePlanner_P::getPatternSpeed(const std::shared_ptr<const TransportRoute>& route) const
+{
+    const auto& settings = owner->settings;
+
+    auto speed = settings.speeds.value(route->type, settings.defaultSpeed);
+    if (speed <= 0.0f)
+        speed = settings.defaultSpeed;
+
+    // km/h to m/s
+    return speed / 3.6f;
+}
+
+void OsmAnd::TransportRoutePlanner_P::Network::findStops(
+    const PointI point31,
+    const float radius,
+    QList< std::pair<uint32_t, float> >& outStops) const
+{
+    const auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(radius, point31);
+
+    const auto begin = stopsByXKeys.cbegin();
+    const auto end = stopsByXKeys.cend();
+    for (auto itKey = std::lower_bound(begin, end, bbox31.left()); itKey != end && *itKey <= bbox31.right(); ++itKey)
+    {
+        const auto stopIndex = stopsByX[itKey - begin];
+        const auto& position31 = stopsPositions31[stopIndex];
+        if (position31.y < bbox31.top() || position31.y > bbox31.bottom())
+            continue;
+
+        const auto distance = static_cast<float>(Utilities::distance31(point31, position31));
+        if (distance <= radius)
+            outStops.push_back({ stopIndex, distance });
+    }
+}
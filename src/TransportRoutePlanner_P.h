@@ -0,0 +1,143 @@
+#ifndef _OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_P_H_
+#define _OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QMutex>
+#include <QThreadPool>
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+#include "TransportRoutePlanner.h"
+
+namespace OsmAnd
+{
+    class ObfReader;
+    class ObfTransportSectionInfo;
+    class ObfDataInterface;
+
+    class TransportRoutePlanner;
+    class TransportRoutePlanner_P Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(TransportRoutePlanner_P);
+    private:
+        // Rounds that have to scan fewer patterns are processed by calling thread only
+        static const int ParallelScanPatternsThreshold = 256;
+        static const int PatternsPerScanTask = 128;
+        static const int MaxCachedNetworksCount = 4;
+
+        // Path of OBF file and offset of section in it, these stay same when OBF is reloaded
+        typedef std::pair<QString, uint32_t> SectionId;
+
+        // Stops and route patterns of a set of transport sections, in flat arrays indexed by stop and pattern
+        struct Network
+        {
+            // Sorted
+            QList<SectionId> sectionsIds;
+
+            QVector< std::shared_ptr<const TransportStop> > stops;
+            QVector<PointI> stopsPositions31;
+            // Stops ordered by x31, to find stops near a point
+            QVector<uint32_t> stopsByX;
+            QVector<int32_t> stopsByXKeys;
+
+            // Transfers of i-th stop are [transfersOffsets[i], transfersOffsets[i+1])
+            QVector<uint32_t> transfersOffsets;
+            QVector<uint32_t> transfersTargets;
+            QVector<float> transfersDistances;
+
+            // Stops of i-th pattern are [patternsOffsets[i], patternsOffsets[i+1]) in patternsStops,
+            // patternsTimes holds ride time in seconds from first stop of pattern
+            QVector< std::shared_ptr<const TransportRoute> > patternsRoutes;
+            QVector<uint32_t> patternsOffsets;
+            QVector<uint32_t> patternsStops;
+            QVector<float> patternsTimes;
+
+            // Patterns passing i-th stop are [stopsPatternsOffsets[i], stopsPatternsOffsets[i+1]),
+            // each with position of stop in that pattern
+            QVector<uint32_t> stopsPatternsOffsets;
+            QVector<uint32_t> stopsPatterns;
+            QVector<uint32_t> stopsPatternsPositions;
+
+            void findStops(
+                const PointI point31,
+                const float radius,
+                QList< std::pair<uint32_t, float> >& outStops) const;
+        };
+
+        struct Candidate
+        {
+            uint32_t stop;
+            float arrivalTime;
+            uint32_t pattern;
+            // Indices in patternsStops
+            uint32_t boardIndex;
+            uint32_t alightIndex;
+        };
+
+        enum class LabelKind : uint8_t
+        {
+            Inherited,
+            Access,
+            Ride,
+            Transfer,
+        };
+
+        struct Label
+        {
+            LabelKind kind;
+            // Stop where transfer started
+            uint32_t transferFrom;
+        };
+
+        struct Ride
+        {
+            uint32_t pattern;
+            // Indices in patternsStops
+            uint32_t boardIndex;
+            uint32_t alightIndex;
+        };
+
+        mutable QMutex _networksMutex;
+        mutable QList< std::shared_ptr<const Network> > _networks;
+        mutable QThreadPool _threadPool;
+
+        std::shared_ptr<const Network> obtainNetwork(
+            const AreaI bbox31,
+            const std::shared_ptr<const IQueryController>& queryController) const;
+        std::shared_ptr<const Network> buildNetwork(
+            const std::shared_ptr<ObfDataInterface>& dataInterface,
+            const QList<SectionId>& sectionsIds,
+            const QList< std::shared_ptr<const ObfReader> >& readers,
+            const QList< std::shared_ptr<const ObfTransportSectionInfo> >& sections) const;
+        void scanPatterns(
+            const Network& network,
+            const QVector<uint32_t>& patterns,
+            const QVector<int32_t>& patternsFirstPositions,
+            const QVector<float>& previousArrivalTimes,
+            const QVector<float>& bestArrivalTimes,
+            const float targetBound,
+            QVector<Candidate>& outCandidates) const;
+        float getPatternSpeed(const std::shared_ptr<const TransportRoute>& route) const;
+    protected:
+        TransportRoutePlanner_P(TransportRoutePlanner* const owner);
+    public:
+        ~TransportRoutePlanner_P();
+
+        ImplementationInterface<TransportRoutePlanner> owner;
+
+        QList<TransportRoutePlanner::Journey> planJourneys(
+            const PointI origin31,
+            const PointI destination31,
+            const std::shared_ptr<const IQueryController>& queryController) const;
+
+    friend class OsmAnd::TransportRoutePlanner;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TRANSPORT_ROUTE_PLANNER_P_H_)
@@ -0,0 +1,180 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/FunctorQueryController.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <cmath>
+#include <memory>
+
+#include "IsochroneGraph.h"
+
+using namespace OsmAnd;
+
+class TestIsochroneGraph : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void addRoad(IsochroneGraph& graph, const PointI& from31, const PointI& to31, const float time, const bool oneway);
+    static IsochroneGraph createGraph();
+private slots:
+    void reachabilityAtLimit_data();
+    void reachabilityAtLimit();
+    void partiallyReachedEdges();
+    void nearestSeedWins();
+    void seedsBeyondLimit();
+    void abort();
+};
+
+void TestIsochroneGraph::addRoad(
+    IsochroneGraph& graph,
+    const PointI& from31,
+    const PointI& to31,
+    const float time,
+    const bool oneway)
+{
+    const auto fromIndex = graph.obtainPointIndex(from31);
+    const auto toIndex = graph.obtainPointIndex(to31);
+    graph.edges[fromIndex].push_back({ toIndex, time });
+    if (!oneway)
+        graph.edges[toIndex].push_back({ fromIndex, time });
+}
+
+IsochroneGraph TestIsochroneGraph::createGraph()
+{
+    //  A --10-- B --10-- C --10-- D
+    //           |
+    //           5 (one-way from B to E)
+    //           v
+    //           E --30-- F
+    IsochroneGraph graph;
+    addRoad(graph, PointI(0, 0), PointI(1000, 0), 10.0f, false);
+    addRoad(graph, PointI(1000, 0), PointI(2000, 0), 10.0f, false);
+    addRoad(graph, PointI(2000, 0), PointI(3000, 0), 10.0f, false);
+    addRoad(graph, PointI(1000, 0), PointI(1000, 1000), 5.0f, true);
+    addRoad(graph, PointI(1000, 1000), PointI(1000, 4000), 30.0f, false);
+    return graph;
+}
+
+void TestIsochroneGraph::reachabilityAtLimit_data()
+{
+    QTest::addColumn<float>("timeLimit");
+    QTest::addColumn<int>("seedX31");
+    QTest::addColumn<int>("seedY31");
+    QTest::addColumn<int>("reachedPointsCount");
+
+    // Points reached exactly at the limit are reached, anything later is not
+    QTest::newRow("seed only") << 0.0f << 0 << 0 << 1;
+    QTest::newRow("just before B") << 9.99f << 0 << 0 << 1;
+    QTest::newRow("exactly B") << 10.0f << 0 << 0 << 2;
+    QTest::newRow("exactly C and E") << 20.0f << 0 << 0 << 4;
+    QTest::newRow("exactly D") << 30.0f << 0 << 0 << 5;
+    QTest::newRow("exactly F") << 45.0f << 0 << 0 << 6;
+    QTest::newRow("against one-way") << 1000.0f << 1000 << 4000 << 2;
+}
+
+void TestIsochroneGraph::reachabilityAtLimit()
+{
+    QFETCH(float, timeLimit);
+    QFETCH(int, seedX31);
+    QFETCH(int, seedY31);
+    QFETCH(int, reachedPointsCount);
+
+    auto graph = createGraph();
+    const auto pointsCount = graph.points31.size();
+    const auto seedIndex = graph.obtainPointIndex(PointI(seedX31, seedY31));
+    QCOMPARE(graph.points31.size(), pointsCount);
+
+    const auto arrivalTimes = graph.expand({ { seedIndex, 0.0f } }, timeLimit, nullptr);
+    QCOMPARE(arrivalTimes.size(), pointsCount);
+
+    auto count = 0;
+    for (const auto arrivalTime : arrivalTimes)
+    {
+        if (arrivalTime <= timeLimit)
+            count++;
+        else
+            QVERIFY(std::isinf(arrivalTime));
+    }
+    QCOMPARE(count, reachedPointsCount);
+}
+
+void TestIsochroneGraph::partiallyReachedEdges()
+{
+    auto graph = createGraph();
+    const auto a = graph.obtainPointIndex(PointI(0, 0));
+    const auto c = graph.obtainPointIndex(PointI(2000, 0));
+    const auto e = graph.obtainPointIndex(PointI(1000, 1000));
+
+    const auto d = graph.obtainPointIndex(PointI(3000, 0));
+
+    const auto timeLimit = 22.5f;
+    const auto arrivalTimes = graph.expand({ { a, 0.0f } }, timeLimit, nullptr);
+    QCOMPARE(arrivalTimes[c], 20.0f);
+    QCOMPARE(arrivalTimes[e], 15.0f);
+    QVERIFY(std::isinf(arrivalTimes[d]));
+
+    // A, B, C and E, then quarter of the way from C to D and quarter of the way from E to F
+    const auto reachedPoints = graph.collectReachedPoints(arrivalTimes, timeLimit);
+    QCOMPARE(reachedPoints.size(), 6);
+    QVERIFY(reachedPoints.contains(PointI(0, 0)));
+    QVERIFY(reachedPoints.contains(PointI(1000, 0)));
+    QVERIFY(reachedPoints.contains(PointI(2000, 0)));
+    QVERIFY(reachedPoints.contains(PointI(1000, 1000)));
+    QVERIFY(reachedPoints.contains(PointI(2250, 0)));
+    QVERIFY(reachedPoints.contains(PointI(1000, 1750)));
+
+    // Edge that ends at point reached exactly at the limit adds nothing partial
+    const auto exactArrivalTimes = graph.expand({ { a, 0.0f } }, 20.0f, nullptr);
+    const auto exactReachedPoints = graph.collectReachedPoints(exactArrivalTimes, 20.0f);
+    QVERIFY(!exactReachedPoints.contains(PointI(1500, 0)));
+    QVERIFY(exactReachedPoints.contains(PointI(2000, 0)));
+}
+
+void TestIsochroneGraph::nearestSeedWins()
+{
+    auto graph = createGraph();
+    const auto a = graph.obtainPointIndex(PointI(0, 0));
+    const auto b = graph.obtainPointIndex(PointI(1000, 0));
+    const auto c = graph.obtainPointIndex(PointI(2000, 0));
+    const auto d = graph.obtainPointIndex(PointI(3000, 0));
+
+    const auto arrivalTimes = graph.expand({ { a, 2.0f }, { d, 1.0f } }, 100.0f, nullptr);
+    QCOMPARE(arrivalTimes[a], 2.0f);
+    QCOMPARE(arrivalTimes[b], 12.0f);
+    QCOMPARE(arrivalTimes[c], 11.0f);
+    QCOMPARE(arrivalTimes[d], 1.0f);
+}
+
+void TestIsochroneGraph::seedsBeyondLimit()
+{
+    auto graph = createGraph();
+    const auto a = graph.obtainPointIndex(PointI(0, 0));
+
+    const auto arrivalTimes = graph.expand({ { a, 10.5f } }, 10.0f, nullptr);
+    for (const auto arrivalTime : arrivalTimes)
+        QVERIFY(std::isinf(arrivalTime));
+    QVERIFY(graph.collectReachedPoints(arrivalTimes, 10.0f).isEmpty());
+}
+
+void TestIsochroneGraph::abort()
+{
+    auto graph = createGraph();
+    const auto a = graph.obtainPointIndex(PointI(0, 0));
+    const auto b = graph.obtainPointIndex(PointI(1000, 0));
+
+    const std::shared_ptr<const IQueryController> queryController(new FunctorQueryController(
+        []
+        (const FunctorQueryController* const controller) -> bool
+        {
+            return true;
+        }));
+    const auto arrivalTimes = graph.expand({ { a, 0.0f } }, 100.0f, queryController);
+    QCOMPARE(arrivalTimes[a], 0.0f);
+    QVERIFY(std::isinf(arrivalTimes[b]));
+}
+
+QTEST_MAIN(TestIsochroneGraph)
+#include "TestIsochroneGraph.moc"
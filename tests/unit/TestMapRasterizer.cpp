@@ -0,0 +1,395 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Data/MapObject.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/ResolvedMapStyle.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/MapRasterizer.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <SkBitmap.h>
+#include <SkCanvas.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+using namespace OsmAnd;
+
+struct TestPolygon
+{
+    QString tagValue;
+    QRectF pixelRect;
+    bool clockwise;
+};
+typedef QList<TestPolygon> TestPolygons;
+Q_DECLARE_METATYPE(TestPolygons)
+
+// Low zoom tiles show small part of huge polygons and long roads, most of their vertices lie far outside of the tile
+class TestMapRasterizer : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        TileSize = 256,
+        RingVerticesCount = 16384,
+        RoadsCount = 8,
+        RoadVerticesCount = 4096,
+    };
+
+    std::shared_ptr<MapObject::AttributeMapping> attributeMapping;
+    std::shared_ptr<MapPresentationEnvironment> environment;
+    std::shared_ptr<MapPrimitiviser> primitiviser;
+    std::shared_ptr<MapRasterizer> rasterizer;
+
+    uint32_t obtainAttributeId(const QString& tagValue);
+    std::shared_ptr<MapObject> createMapObject(const QString& tagValue, const bool isArea);
+    QList< std::shared_ptr<const MapObject> > createMapObjects(const ZoomLevel zoom, const TileId tileId);
+    QList< std::shared_ptr<const MapObject> > createMapObjects(
+        const ZoomLevel zoom,
+        const TileId tileId,
+        const TestPolygons& polygons);
+    static TestPolygons createPolygonsGrid(
+        const QStringList& tagValues,
+        const int count,
+        const float size,
+        const float step,
+        const bool alternateWinding);
+    static bool equalPixels(const SkBitmap& bitmap, const SkBitmap& referenceBitmap);
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void rasterizeLowZoomTile_data();
+    void rasterizeLowZoomTile();
+    void batchedPolygonsMatchUnbatched_data();
+    void batchedPolygonsMatchUnbatched();
+};
+
+uint32_t TestMapRasterizer::obtainAttributeId(const QString& tagValue)
+{
+    const auto separatorIndex = tagValue.indexOf(QLatin1Char('='));
+    const auto tag = tagValue.left(separatorIndex);
+    const auto value = tagValue.mid(separatorIndex + 1);
+
+    uint32_t attributeId = 0;
+    if (attributeMapping->encodeTagValue(tag, value, &attributeId))
+        return attributeId;
+
+    ListMap< MapObject::AttributeMapping::TagValue >::KeyType maxKey = 0;
+    attributeMapping->decodeMap.findMaxKey(maxKey);
+    attributeId = static_cast<uint32_t>(maxKey) + 1;
+    attributeMapping->registerMapping(attributeId, tag, value);
+    return attributeId;
+}
+
+std::shared_ptr<MapObject> TestMapRasterizer::createMapObject(const QString& tagValue, const bool isArea)
+{
+    const std::shared_ptr<MapObject> mapObject(new MapObject());
+    mapObject->attributeMapping = attributeMapping;
+    mapObject->isArea = isArea;
+    mapObject->attributeIds.push_back(obtainAttributeId(tagValue));
+    return mapObject;
+}
+
+QList< std::shared_ptr<const MapObject> > TestMapRasterizer::createMapObjects(const ZoomLevel zoom, const TileId tileId)
+{
+    const auto tileSize31 = static_cast<double>(1u << (MaxZoomLevel - zoom));
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+    const auto centerX = static_cast<double>(tileBBox31.left()) + tileSize31 / 2.0;
+    const auto centerY = static_cast<double>(tileBBox31.top()) + tileSize31 / 2.0;
+    const auto toPoint31 =
+        [centerX, centerY, tileSize31]
+        (const double x, const double y) -> PointI
+        {
+            return PointI(
+                static_cast<int32_t>(centerX + x * tileSize31),
+                static_cast<int32_t>(centerY + y * tileSize31));
+        };
+
+    QList< std::shared_ptr<const MapObject> > mapObjects;
+
+    // Forest and lake with island, several tiles in radius and with wavy shores
+    for (const auto& tagValue : { QStringLiteral("landuse=forest"), QStringLiteral("natural=water") })
+    {
+        const auto mapObject = createMapObject(tagValue, true);
+        const auto radius = mapObjects.isEmpty() ? 4.0 : 2.5;
+        for (auto vertexIndex = 0; vertexIndex < RingVerticesCount; vertexIndex++)
+        {
+            const auto angle = 2.0 * M_PI * vertexIndex / RingVerticesCount;
+            const auto wave = radius * (1.0 + 0.05 * std::sin(angle * 97.0));
+            mapObject->points31.push_back(toPoint31(wave * std::cos(angle), wave * std::sin(angle)));
+        }
+        mapObject->points31.push_back(mapObject->points31.first());
+
+        QVector<PointI> innerRing;
+        for (auto vertexIndex = 0; vertexIndex < RingVerticesCount / 16; vertexIndex++)
+        {
+            const auto angle = -2.0 * M_PI * vertexIndex / (RingVerticesCount / 16);
+            innerRing.push_back(toPoint31(0.2 + 0.1 * std::cos(angle), 0.2 + 0.1 * std::sin(angle)));
+        }
+        innerRing.push_back(innerRing.first());
+        mapObject->innerPolygonsPoints31.push_back(innerRing);
+
+        mapObject->computeBBox31();
+        mapObject->computeGeometrySummary31();
+        mapObjects.push_back(mapObject);
+    }
+
+    // Roads that cross the tile, and continue far beyond it
+    for (auto roadIndex = 0; roadIndex < RoadsCount; roadIndex++)
+    {
+        const auto mapObject = createMapObject(
+            (roadIndex % 2) ? QStringLiteral("highway=primary") : QStringLiteral("highway=motorway"),
+            false);
+        const auto angle = M_PI * roadIndex / RoadsCount;
+        for (auto vertexIndex = 0; vertexIndex < RoadVerticesCount; vertexIndex++)
+        {
+            const auto along = 12.0 * vertexIndex / (RoadVerticesCount - 1) - 6.0;
+            const auto across = 0.02 * std::sin(along * 40.0);
+            mapObject->points31.push_back(toPoint31(
+                along * std::cos(angle) - across * std::sin(angle),
+                along * std::sin(angle) + across * std::cos(angle)));
+        }
+
+        mapObject->computeBBox31();
+        mapObjects.push_back(mapObject);
+    }
+
+    return mapObjects;
+}
+
+QList< std::shared_ptr<const MapObject> > TestMapRasterizer::createMapObjects(
+    const ZoomLevel zoom,
+    const TileId tileId,
+    const TestPolygons& polygons)
+{
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+    const auto pixelSize31 = static_cast<double>(1u << (MaxZoomLevel - zoom)) / TileSize;
+    const auto toPoint31 =
+        [tileBBox31, pixelSize31]
+        (const double x, const double y) -> PointI
+        {
+            return PointI(
+                tileBBox31.left() + static_cast<int32_t>(x * pixelSize31),
+                tileBBox31.top() + static_cast<int32_t>(y * pixelSize31));
+        };
+
+    QList< std::shared_ptr<const MapObject> > mapObjects;
+    for (const auto& polygon : polygons)
+    {
+        const auto mapObject = createMapObject(polygon.tagValue, true);
+        const auto& rect = polygon.pixelRect;
+        mapObject->points31.push_back(toPoint31(rect.left(), rect.top()));
+        if (polygon.clockwise)
+        {
+            mapObject->points31.push_back(toPoint31(rect.right(), rect.top()));
+            mapObject->points31.push_back(toPoint31(rect.right(), rect.bottom()));
+            mapObject->points31.push_back(toPoint31(rect.left(), rect.bottom()));
+        }
+        else
+        {
+            mapObject->points31.push_back(toPoint31(rect.left(), rect.bottom()));
+            mapObject->points31.push_back(toPoint31(rect.right(), rect.bottom()));
+            mapObject->points31.push_back(toPoint31(rect.right(), rect.top()));
+        }
+        mapObject->points31.push_back(mapObject->points31.first());
+
+        mapObject->computeBBox31();
+        mapObject->computeGeometrySummary31();
+        mapObjects.push_back(mapObject);
+    }
+
+    return mapObjects;
+}
+
+TestPolygons TestMapRasterizer::createPolygonsGrid(
+    const QStringList& tagValues,
+    const int count,
+    const float size,
+    const float step,
+    const bool alternateWinding)
+{
+    // Squares go row by row, tags and windings alternate between neighbours
+    TestPolygons polygons;
+    const auto columnsCount = qMax(1, static_cast<int>((TileSize - 8) / step));
+    for (auto index = 0; index < count; index++)
+    {
+        const auto column = index % columnsCount;
+        const auto row = index / columnsCount;
+
+        TestPolygon polygon;
+        polygon.tagValue = tagValues[index % tagValues.size()];
+        polygon.pixelRect = QRectF(4.0 + column * step, 4.0 + row * step, size, size);
+        polygon.clockwise = !alternateWinding || (index % 2 == 0);
+        polygons.push_back(polygon);
+    }
+    return polygons;
+}
+
+bool TestMapRasterizer::equalPixels(const SkBitmap& bitmap, const SkBitmap& referenceBitmap)
+{
+    return bitmap.width() == referenceBitmap.width() &&
+        bitmap.height() == referenceBitmap.height() &&
+        bitmap.computeByteSize() == referenceBitmap.computeByteSize() &&
+        memcmp(bitmap.getPixels(), referenceBitmap.getPixels(), referenceBitmap.computeByteSize()) == 0;
+}
+
+void TestMapRasterizer::initTestCase()
+{
+    OsmAnd::InitializeCore(CoreResourcesEmbeddedBundle::loadFromSharedResourcesBundle());
+
+    const std::shared_ptr<MapStylesCollection> stylesCollection(new MapStylesCollection());
+    const auto mapStyle = stylesCollection->getResolvedStyleByName(QLatin1String("default"));
+    QVERIFY(mapStyle);
+
+    attributeMapping.reset(new MapObject::AttributeMapping());
+    attributeMapping->verifyRequiredMappingRegistered();
+
+    environment.reset(new MapPresentationEnvironment(mapStyle));
+    primitiviser.reset(new MapPrimitiviser(environment));
+    rasterizer.reset(new MapRasterizer(environment));
+}
+
+void TestMapRasterizer::cleanupTestCase()
+{
+    rasterizer.reset();
+    primitiviser.reset();
+    environment.reset();
+    attributeMapping.reset();
+
+    OsmAnd::ReleaseCore();
+}
+
+void TestMapRasterizer::rasterizeLowZoomTile_data()
+{
+    QTest::addColumn<int>("zoom");
+
+    QTest::newRow("zoom 5") << 5;
+    QTest::newRow("zoom 7") << 7;
+    QTest::newRow("zoom 9") << 9;
+}
+
+void TestMapRasterizer::rasterizeLowZoomTile()
+{
+    QFETCH(int, zoom);
+
+    const auto zoomLevel = static_cast<ZoomLevel>(zoom);
+    const auto tilesPerSide = 1u << zoom;
+    const auto tileId = TileId::fromXY(tilesPerSide / 2 + 1, tilesPerSide / 2 - 2);
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoomLevel);
+
+    const auto primitivisedObjects = primitiviser->primitiviseWithSurface(
+        tileBBox31,
+        PointI(TileSize, TileSize),
+        zoomLevel,
+        zoomLevel,
+        tileId,
+        tileBBox31,
+        0,
+        MapSurfaceType::FullLand,
+        createMapObjects(zoomLevel, tileId));
+    QVERIFY(primitivisedObjects);
+    QVERIFY(!primitivisedObjects->isEmpty());
+
+    SkBitmap bitmap;
+    QVERIFY(bitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(TileSize, TileSize)));
+    SkCanvas canvas(bitmap);
+
+    QBENCHMARK
+    {
+        rasterizer->rasterize(tileBBox31, primitivisedObjects, canvas);
+    }
+}
+
+void TestMapRasterizer::batchedPolygonsMatchUnbatched_data()
+{
+    QTest::addColumn<TestPolygons>("polygons");
+
+    const QStringList buildings{ QStringLiteral("building=yes") };
+    const QStringList landuses{
+        QStringLiteral("landuse=forest"),
+        QStringLiteral("natural=water"),
+        QStringLiteral("building=yes") };
+
+    // Batches hold at most 32 polygons, so these go around that limit
+    QTest::newRow("disjoint buildings") << createPolygonsGrid(buildings, 12, 10.0f, 20.0f, false);
+    QTest::newRow("batch size minus one") << createPolygonsGrid(buildings, 31, 10.0f, 20.0f, false);
+    QTest::newRow("batch size") << createPolygonsGrid(buildings, 32, 10.0f, 20.0f, false);
+    QTest::newRow("batch size plus one") << createPolygonsGrid(buildings, 33, 10.0f, 20.0f, false);
+    QTest::newRow("several batches") << createPolygonsGrid(buildings, 100, 10.0f, 20.0f, true);
+
+    // Overlapping polygons of same style can't share path: opposite windings would cancel out
+    QTest::newRow("overlapping buildings") << createPolygonsGrid(buildings, 40, 18.0f, 12.0f, true);
+    QTest::newRow("touching buildings") << createPolygonsGrid(buildings, 40, 12.0f, 12.0f, false);
+
+    // Different styles get different order, and overlapping ones have to keep it
+    QTest::newRow("differing zOrder, disjoint") << createPolygonsGrid(landuses, 60, 10.0f, 20.0f, false);
+    QTest::newRow("differing zOrder, overlapping") << createPolygonsGrid(landuses, 60, 24.0f, 14.0f, true);
+}
+
+void TestMapRasterizer::batchedPolygonsMatchUnbatched()
+{
+    QFETCH(TestPolygons, polygons);
+
+    const auto zoom = ZoomLevel16;
+    const auto tileId = TileId::fromXY(35210, 21493);
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+    const auto mapObjects = createMapObjects(zoom, tileId, polygons);
+
+    const auto primitivise =
+        [this, zoom, tileId, tileBBox31, &mapObjects]
+        () -> std::shared_ptr<MapPrimitiviser::PrimitivisedObjects>
+        {
+            return primitiviser->primitiviseWithSurface(
+                tileBBox31,
+                PointI(TileSize, TileSize),
+                zoom,
+                zoom,
+                tileId,
+                tileBBox31,
+                0,
+                MapSurfaceType::FullLand,
+                mapObjects);
+        };
+
+    // All polygons at once, so that runs of them are drawn as batches
+    const auto primitivisedObjects = primitivise();
+    QVERIFY(primitivisedObjects);
+    primitivisedObjects->polylines.clear();
+    primitivisedObjects->points.clear();
+    QVERIFY(primitivisedObjects->polygons.size() > polygons.size() / 2);
+
+    SkBitmap batchedBitmap;
+    QVERIFY(batchedBitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(TileSize, TileSize)));
+    SkCanvas batchedCanvas(batchedBitmap);
+    rasterizer->rasterize(tileBBox31, primitivisedObjects, batchedCanvas);
+
+    // Polygon by polygon, in same order, so that each one is drawn alone
+    const auto singlePrimitivisedObjects = primitivise();
+    QVERIFY(singlePrimitivisedObjects);
+    singlePrimitivisedObjects->polylines.clear();
+    singlePrimitivisedObjects->points.clear();
+    const auto allPolygons = singlePrimitivisedObjects->polygons;
+    QCOMPARE(allPolygons.size(), primitivisedObjects->polygons.size());
+
+    SkBitmap unbatchedBitmap;
+    QVERIFY(unbatchedBitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(TileSize, TileSize)));
+    SkCanvas unbatchedCanvas(unbatchedBitmap);
+    singlePrimitivisedObjects->polygons.clear();
+    rasterizer->rasterize(tileBBox31, singlePrimitivisedObjects, unbatchedCanvas);
+    for (const auto& polygon : allPolygons)
+    {
+        singlePrimitivisedObjects->polygons = { polygon };
+        rasterizer->rasterize(tileBBox31, singlePrimitivisedObjects, unbatchedCanvas, false);
+    }
+
+    QVERIFY(equalPixels(batchedBitmap, unbatchedBitmap));
+}
+
+QTEST_MAIN(TestMapRasterizer)
+#include "TestMapRasterizer.moc"
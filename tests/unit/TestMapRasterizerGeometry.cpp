@@ -0,0 +1,240 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <SkMatrix.h>
+#include <SkPath.h>
+#include <SkPathMeasure.h>
+#include <SkPoint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "MapRasterizerGeometry.h"
+
+using namespace OsmAnd;
+
+typedef QVector< QVector<QPointF> > Contours;
+Q_DECLARE_METATYPE(Contours)
+
+class TestMapRasterizerGeometry : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<PointI> generatePoints31(const AreaI& area31, const int count);
+    static uint32_t bitsOf(const float value);
+    static bool fuzzyCompare(const SkMatrix& matrix, const SkMatrix& referenceMatrix);
+private slots:
+    void calculateVertices_data();
+    void calculateVertices();
+    void pathMeasure_data();
+    void pathMeasure();
+};
+
+QVector<PointI> TestMapRasterizerGeometry::generatePoints31(const AreaI& area31, const int count)
+{
+    // Corners of area and limits of 31 coordinates go first, then points spread over whole world
+    const auto maxCoordinate = std::numeric_limits<int32_t>::max();
+    const PointI specialPoints31[] = {
+        area31.topLeft,
+        area31.bottomRight,
+        PointI(0, 0),
+        PointI(maxCoordinate, maxCoordinate),
+        PointI(maxCoordinate - 1, 1),
+        PointI(1, maxCoordinate - 1),
+        PointI(area31.right(), area31.top()),
+        PointI(area31.left() / 2, maxCoordinate - area31.top() / 2),
+    };
+    const auto specialPointsCount = static_cast<int>(sizeof(specialPoints31) / sizeof(specialPoints31[0]));
+
+    QVector<PointI> points31;
+    points31.reserve(count);
+    uint32_t seed = 0x9e3779b9u;
+    for (auto pointIdx = 0; pointIdx < count; pointIdx++)
+    {
+        if (pointIdx < specialPointsCount)
+        {
+            points31.push_back(specialPoints31[pointIdx]);
+            continue;
+        }
+
+        seed = seed * 1664525u + 1013904223u;
+        const auto x = static_cast<int32_t>(seed & static_cast<uint32_t>(maxCoordinate));
+        seed = seed * 1664525u + 1013904223u;
+        const auto y = static_cast<int32_t>(seed & static_cast<uint32_t>(maxCoordinate));
+        points31.push_back(PointI(x, y));
+    }
+    return points31;
+}
+
+uint32_t TestMapRasterizerGeometry::bitsOf(const float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+bool TestMapRasterizerGeometry::fuzzyCompare(const SkMatrix& matrix, const SkMatrix& referenceMatrix)
+{
+    for (auto valueIdx = 0; valueIdx < 9; valueIdx++)
+    {
+        const auto value = matrix.get(valueIdx);
+        const auto referenceValue = referenceMatrix.get(valueIdx);
+        if (std::fabs(value - referenceValue) > 1.0e-4f * std::max(1.0f, std::fabs(referenceValue)))
+            return false;
+    }
+    return true;
+}
+
+void TestMapRasterizerGeometry::calculateVertices_data()
+{
+    QTest::addColumn<int>("zoom");
+    QTest::addColumn<int>("tileX");
+    QTest::addColumn<int>("tileY");
+    QTest::addColumn<int>("tileSize");
+    QTest::addColumn<int>("originX");
+    QTest::addColumn<int>("originY");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("no points") << 0 << 0 << 0 << 256 << 0 << 0 << 0;
+    QTest::newRow("single point") << 3 << 5 << 2 << 256 << 0 << 0 << 1;
+    QTest::newRow("even count") << 10 << 500 << 300 << 256 << 0 << 0 << 64;
+    QTest::newRow("odd count") << 10 << 500 << 300 << 256 << 0 << 0 << 63;
+    QTest::newRow("world tile") << 0 << 0 << 0 << 256 << 0 << 0 << 257;
+    QTest::newRow("last tile of world") << 19 << (1 << 19) - 1 << (1 << 19) - 1 << 256 << 0 << 0 << 17;
+    QTest::newRow("first tile of world") << 19 << 0 << 0 << 512 << 0 << 0 << 9;
+    QTest::newRow("overscaled tile") << 24 << 8000000 << 5000000 << 1000 << 0 << 0 << 33;
+    QTest::newRow("shifted pixel area") << 12 << 2048 << 1361 << 384 << -128 << 64 << 7;
+    QTest::newRow("tiles of metatile") << 6 << 32 << 20 << 1024 << 256 << 512 << 101;
+}
+
+void TestMapRasterizerGeometry::calculateVertices()
+{
+    QFETCH(int, zoom);
+    QFETCH(int, tileX);
+    QFETCH(int, tileY);
+    QFETCH(int, tileSize);
+    QFETCH(int, originX);
+    QFETCH(int, originY);
+    QFETCH(int, count);
+
+    const auto tileSize31 = static_cast<int64_t>(1) << (31 - zoom);
+    AreaI area31;
+    area31.top() = static_cast<int32_t>(tileY * tileSize31);
+    area31.left() = static_cast<int32_t>(tileX * tileSize31);
+    area31.bottom() = static_cast<int32_t>((tileY + 1) * tileSize31 - 1);
+    area31.right() = static_cast<int32_t>((tileX + 1) * tileSize31 - 1);
+    const PointD scaleDivisor31ToPixel(
+        static_cast<double>(tileSize31) / tileSize,
+        static_cast<double>(tileSize31) / tileSize);
+    const PointI pixelOrigin(originX, originY);
+
+    const auto points31 = generatePoints31(area31, count);
+    QVector<SkPoint> vertices(count);
+    MapRasterizerGeometry::calculateVertices(
+        area31,
+        scaleDivisor31ToPixel,
+        pixelOrigin,
+        points31.constData(),
+        count,
+        vertices.data());
+
+    for (auto pointIdx = 0; pointIdx < count; pointIdx++)
+    {
+        PointF vertex;
+        MapRasterizerGeometry::calculateVertex(area31, scaleDivisor31ToPixel, pixelOrigin, points31[pointIdx], vertex);
+
+        const auto context = QString("point %1 (%2, %3)")
+            .arg(pointIdx)
+            .arg(points31[pointIdx].x)
+            .arg(points31[pointIdx].y);
+        QVERIFY2(bitsOf(vertices[pointIdx].fX) == bitsOf(vertex.x), qPrintable(context));
+        QVERIFY2(bitsOf(vertices[pointIdx].fY) == bitsOf(vertex.y), qPrintable(context));
+    }
+}
+
+void TestMapRasterizerGeometry::pathMeasure_data()
+{
+    QTest::addColumn<Contours>("contours");
+    QTest::addColumn<bool>("closed");
+
+    QTest::newRow("empty path") << Contours{} << false;
+    QTest::newRow("single point") << Contours{ { QPointF(10, 10) } } << false;
+    QTest::newRow("single segment") << Contours{ { QPointF(0, 0), QPointF(100, 50) } } << false;
+    QTest::newRow("polyline") << Contours{
+        { QPointF(-20, 5), QPointF(40, 5), QPointF(40, 90), QPointF(300, 120), QPointF(250, -40) } } << false;
+    QTest::newRow("zero-length segments") << Contours{
+        { QPointF(0, 0), QPointF(0, 0), QPointF(50, 0), QPointF(50, 0), QPointF(50, 0), QPointF(50, 80), QPointF(50, 80) } } << false;
+    QTest::newRow("zero-length contour first") << Contours{
+        { QPointF(5, 5), QPointF(5, 5) },
+        { QPointF(10, 10), QPointF(110, 10), QPointF(110, 60) } } << false;
+    QTest::newRow("multiple contours") << Contours{
+        { QPointF(0, 0), QPointF(30, 40), QPointF(60, 0) },
+        { QPointF(500, 500), QPointF(600, 500) },
+        { QPointF(-100, -100), QPointF(-200, -300) } } << false;
+    QTest::newRow("closed contours") << Contours{
+        { QPointF(0, 0), QPointF(100, 0), QPointF(100, 100), QPointF(0, 100) },
+        { QPointF(200, 200), QPointF(300, 250) } } << true;
+    QTest::newRow("long road") << Contours{
+        { QPointF(-1024.5, 17.25), QPointF(-3.125, 18.5), QPointF(0.0625, 19), QPointF(2048.75, -511.5) } } << false;
+}
+
+void TestMapRasterizerGeometry::pathMeasure()
+{
+    QFETCH(Contours, contours);
+    QFETCH(bool, closed);
+
+    SkPath path;
+    for (const auto& contour : contours)
+    {
+        for (auto pointIdx = 0; pointIdx < contour.size(); pointIdx++)
+        {
+            const auto point = SkPoint::Make(
+                static_cast<float>(contour[pointIdx].x()),
+                static_cast<float>(contour[pointIdx].y()));
+            if (pointIdx == 0)
+                path.moveTo(point);
+            else
+                path.lineTo(point);
+        }
+        if (closed)
+            path.close();
+    }
+
+    const MapRasterizerGeometry::PathMeasure pathMeasure(path);
+    SkPathMeasure referencePathMeasure(path, false);
+
+    const auto length = pathMeasure.getLength();
+    const auto referenceLength = referencePathMeasure.getLength();
+    QVERIFY2(std::fabs(length - referenceLength) <= 1.0e-4f * std::max(1.0f, referenceLength),
+        qPrintable(QString("length %1, expected %2").arg(length).arg(referenceLength)));
+
+    // Ends of segments, points inside of them and distances beyond both ends of path
+    QVector<float> distances;
+    distances << -100.0f << -0.5f << 0.0f << referenceLength << referenceLength + 0.5f << referenceLength + 100.0f;
+    for (const auto& segment : pathMeasure.segments)
+        distances << segment.distance << segment.distance - 0.25f << segment.distance + 0.25f;
+    for (auto step = 1; step < 64; step++)
+        distances << referenceLength * step / 64.0f;
+
+    for (const auto distance : distances)
+    {
+        SkMatrix matrix;
+        const auto ok = pathMeasure.getMatrix(distance, matrix);
+        SkMatrix referenceMatrix;
+        const auto referenceOk = referencePathMeasure.getMatrix(distance, &referenceMatrix);
+
+        const auto context = QString("distance %1").arg(distance);
+        QVERIFY2(ok == referenceOk, qPrintable(context));
+        if (ok)
+            QVERIFY2(fuzzyCompare(matrix, referenceMatrix), qPrintable(context));
+    }
+}
+
+QTEST_MAIN(TestMapRasterizerGeometry)
+#include "TestMapRasterizerGeometry.moc"
@@ -0,0 +1,400 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Data/MapObject.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/ResolvedMapStyle.h>
+#include <OsmAndCore/Map/MapStyleEvaluator.h>
+#include <OsmAndCore/Map/MapStyleEvaluationResult.h>
+#include <OsmAndCore/Map/MapStyleBuiltinValueDefinitions.h>
+#include <OsmAndCore/Map/MapStyleConstantValue.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Data/BinaryMapObject.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfInfo.h>
+#include <OsmAndCore/Data/ObfMapSectionInfo.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/ObfDataInterface.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Compiled program of bundled style has to produce exactly what rule trees of that style produce
+class TestMapStyleProgram : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::shared_ptr<const ResolvedMapStyle> mapStyle;
+    std::shared_ptr<const MapStyleBuiltinValueDefinitions> builtinValueDefs;
+    std::shared_ptr<MapObject::AttributeMapping> attributeMapping;
+
+    static uint32_t obtainAttributeId(
+        const std::shared_ptr<MapObject::AttributeMapping>& attributeMapping,
+        const QString& tagValue);
+    static std::shared_ptr<MapObject> createMapObject(
+        const std::shared_ptr<MapObject::AttributeMapping>& attributeMapping,
+        const QStringList& tags,
+        const QStringList& additionalTags,
+        const bool isArea);
+    IMapStyle::StringId parseStringId(const QString& input, const int valueDefId) const;
+    void setupEvaluator(
+        MapStyleEvaluator& evaluator,
+        const std::shared_ptr<const MapObject>& mapObject,
+        const int zoom,
+        const int attributeIdIndex = 0) const;
+    void compareEvaluation(
+        MapStyleEvaluator& referenceEvaluator,
+        MapStyleEvaluator& programEvaluator,
+        const std::shared_ptr<const MapObject>& mapObject,
+        const MapStyleRulesetType rulesetType,
+        const int zoom,
+        const int attributeIdIndex = 0) const;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void evaluate_data();
+    void evaluate();
+    void sectionAttributeMapping_data();
+    void sectionAttributeMapping();
+    void attributes();
+    void obfTiles();
+};
+
+uint32_t TestMapStyleProgram::obtainAttributeId(
+    const std::shared_ptr<MapObject::AttributeMapping>& attributeMapping,
+    const QString& tagValue)
+{
+    const auto separatorIndex = tagValue.indexOf(QLatin1Char('='));
+    const auto tag = tagValue.left(separatorIndex);
+    const auto value = tagValue.mid(separatorIndex + 1);
+
+    uint32_t attributeId = 0;
+    if (attributeMapping->encodeTagValue(tag, value, &attributeId))
+        return attributeId;
+
+    ListMap< MapObject::AttributeMapping::TagValue >::KeyType maxKey = 0;
+    attributeMapping->decodeMap.findMaxKey(maxKey);
+    attributeId = static_cast<uint32_t>(maxKey) + 1;
+    attributeMapping->registerMapping(attributeId, tag, value);
+    return attributeId;
+}
+
+std::shared_ptr<MapObject> TestMapStyleProgram::createMapObject(
+    const std::shared_ptr<MapObject::AttributeMapping>& attributeMapping,
+    const QStringList& tags,
+    const QStringList& additionalTags,
+    const bool isArea)
+{
+    const std::shared_ptr<MapObject> mapObject(new MapObject());
+    mapObject->attributeMapping = attributeMapping;
+    mapObject->isArea = isArea;
+    for (const auto& tagValue : tags)
+        mapObject->attributeIds.push_back(obtainAttributeId(attributeMapping, tagValue));
+    for (const auto& tagValue : additionalTags)
+        mapObject->additionalAttributeIds.push_back(obtainAttributeId(attributeMapping, tagValue));
+    mapObject->points31 = { PointI(100000, 100000), PointI(200000, 100000), PointI(200000, 200000) };
+    if (isArea)
+        mapObject->points31.push_back(mapObject->points31.first());
+    mapObject->computeBBox31();
+    return mapObject;
+}
+
+IMapStyle::StringId TestMapStyleProgram::parseStringId(const QString& input, const int valueDefId) const
+{
+    MapStyleConstantValue parsedValue;
+    if (!mapStyle->parseValue(input, valueDefId, parsedValue))
+        return std::numeric_limits<IMapStyle::StringId>::max();
+    return parsedValue.asSimple.asUInt;
+}
+
+void TestMapStyleProgram::setupEvaluator(
+    MapStyleEvaluator& evaluator,
+    const std::shared_ptr<const MapObject>& mapObject,
+    const int zoom,
+    const int attributeIdIndex) const
+{
+    const auto& tagValue = mapObject->attributeMapping->decodeMap[mapObject->attributeIds[attributeIdIndex]];
+    evaluator.setStringIdValue(builtinValueDefs->id_INPUT_TAG, parseStringId(tagValue.tag, builtinValueDefs->id_INPUT_TAG));
+    evaluator.setStringIdValue(builtinValueDefs->id_INPUT_VALUE, parseStringId(tagValue.value, builtinValueDefs->id_INPUT_VALUE));
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_LAYER, 0);
+    evaluator.setBooleanValue(builtinValueDefs->id_INPUT_AREA, mapObject->isArea);
+    evaluator.setBooleanValue(builtinValueDefs->id_INPUT_POINT, mapObject->points31.size() == 1);
+    evaluator.setBooleanValue(builtinValueDefs->id_INPUT_CYCLE, mapObject->isClosedFigure());
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_TEXT_LENGTH, 8);
+    evaluator.setStringValue(builtinValueDefs->id_INPUT_NAME_TAG, QString());
+}
+
+void TestMapStyleProgram::compareEvaluation(
+    MapStyleEvaluator& referenceEvaluator,
+    MapStyleEvaluator& programEvaluator,
+    const std::shared_ptr<const MapObject>& mapObject,
+    const MapStyleRulesetType rulesetType,
+    const int zoom,
+    const int attributeIdIndex) const
+{
+    setupEvaluator(referenceEvaluator, mapObject, zoom, attributeIdIndex);
+    setupEvaluator(programEvaluator, mapObject, zoom, attributeIdIndex);
+
+    MapStyleEvaluationResult referenceResult(mapStyle->getValueDefinitionsCount());
+    const auto referenceSuccess = referenceEvaluator.evaluate(mapObject, rulesetType, &referenceResult);
+    MapStyleEvaluationResult programResult(mapStyle->getValueDefinitionsCount());
+    const auto programSuccess = programEvaluator.evaluate(mapObject, rulesetType, &programResult);
+
+    const auto context = QString("%1, type %2, ruleset %3, zoom %4")
+        .arg(mapObject->toString())
+        .arg(attributeIdIndex)
+        .arg(static_cast<int>(rulesetType))
+        .arg(zoom);
+    QVERIFY2(referenceSuccess == programSuccess, qPrintable(context));
+    QVERIFY2(referenceResult.getValues() == programResult.getValues(), qPrintable(context));
+}
+
+void TestMapStyleProgram::initTestCase()
+{
+    OsmAnd::InitializeCore(CoreResourcesEmbeddedBundle::loadFromSharedResourcesBundle());
+
+    const std::shared_ptr<MapStylesCollection> stylesCollection(new MapStylesCollection());
+    mapStyle = stylesCollection->getResolvedStyleByName(QLatin1String("default"));
+    QVERIFY(mapStyle);
+    QVERIFY(mapStyle->getProgram());
+
+    builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+
+    attributeMapping.reset(new MapObject::AttributeMapping());
+    attributeMapping->verifyRequiredMappingRegistered();
+}
+
+void TestMapStyleProgram::cleanupTestCase()
+{
+    mapStyle.reset();
+    attributeMapping.reset();
+
+    OsmAnd::ReleaseCore();
+}
+
+void TestMapStyleProgram::evaluate_data()
+{
+    QTest::addColumn<QStringList>("tags");
+    QTest::addColumn<QStringList>("additionalTags");
+    QTest::addColumn<bool>("isArea");
+
+    QTest::newRow("motorway") << QStringList{ "highway=motorway" } << QStringList{} << false;
+    QTest::newRow("primary bridge") << QStringList{ "highway=primary" } << QStringList{ "bridge=yes", "layer=1" } << false;
+    QTest::newRow("secondary tunnel") << QStringList{ "highway=secondary" } << QStringList{ "tunnel=yes" } << false;
+    QTest::newRow("residential oneway") << QStringList{ "highway=residential" } << QStringList{ "oneway=yes" } << false;
+    QTest::newRow("private service") << QStringList{ "highway=service" } << QStringList{ "access=private", "service=driveway" } << false;
+    QTest::newRow("track grade") << QStringList{ "highway=track" } << QStringList{ "tracktype=grade3", "surface=gravel" } << false;
+    QTest::newRow("footway") << QStringList{ "highway=footway" } << QStringList{ "surface=paving_stones" } << false;
+    QTest::newRow("cycleway") << QStringList{ "highway=cycleway" } << QStringList{} << false;
+    QTest::newRow("rail") << QStringList{ "railway=rail" } << QStringList{ "usage=main" } << false;
+    QTest::newRow("river") << QStringList{ "waterway=river" } << QStringList{} << false;
+    QTest::newRow("admin boundary") << QStringList{ "admin_level=4" } << QStringList{} << false;
+    QTest::newRow("building") << QStringList{ "building=yes" } << QStringList{ "building:levels=5" } << true;
+    QTest::newRow("forest") << QStringList{ "landuse=forest" } << QStringList{ "leaf_type=needleleaved" } << true;
+    QTest::newRow("park") << QStringList{ "leisure=park" } << QStringList{} << true;
+    QTest::newRow("water") << QStringList{ "natural=water" } << QStringList{ "water=lake" } << true;
+    QTest::newRow("parking") << QStringList{ "amenity=parking" } << QStringList{ "access=private" } << true;
+    QTest::newRow("restaurant") << QStringList{ "amenity=restaurant" } << QStringList{ "cuisine=pizza" } << false;
+    QTest::newRow("peak") << QStringList{ "natural=peak" } << QStringList{ "ele=1234" } << false;
+    QTest::newRow("city") << QStringList{ "place=city" } << QStringList{ "capital=yes" } << false;
+    QTest::newRow("unknown") << QStringList{ "nonexistent_tag=nonexistent_value" } << QStringList{} << false;
+}
+
+void TestMapStyleProgram::evaluate()
+{
+    QFETCH(QStringList, tags);
+    QFETCH(QStringList, additionalTags);
+    QFETCH(bool, isArea);
+
+    const auto mapObject = createMapObject(attributeMapping, tags, additionalTags, isArea);
+
+    MapStyleEvaluator referenceEvaluator(mapStyle, 1.0f);
+    referenceEvaluator.setProgramEnabled(false);
+    MapStyleEvaluator programEvaluator(mapStyle, 1.0f);
+    QVERIFY(!referenceEvaluator.isProgramEnabled());
+    QVERIFY(programEvaluator.isProgramEnabled());
+
+    const MapStyleRulesetType rulesetTypes[] = {
+        MapStyleRulesetType::Point,
+        MapStyleRulesetType::Polyline,
+        MapStyleRulesetType::Polygon,
+        MapStyleRulesetType::Text,
+        MapStyleRulesetType::Order,
+    };
+    for (const auto rulesetType : rulesetTypes)
+    {
+        for (auto zoom = static_cast<int>(MinZoomLevel); zoom <= static_cast<int>(MaxZoomLevel); zoom++)
+        {
+            compareEvaluation(referenceEvaluator, programEvaluator, mapObject, rulesetType, zoom);
+            if (QTest::currentTestFailed())
+                return;
+        }
+    }
+}
+
+void TestMapStyleProgram::sectionAttributeMapping_data()
+{
+    evaluate_data();
+}
+
+void TestMapStyleProgram::sectionAttributeMapping()
+{
+    QFETCH(QStringList, tags);
+    QFETCH(QStringList, additionalTags);
+    QFETCH(bool, isArea);
+
+    // Program resolves "additional" conditions into attribute id bitsets only for mappings of OBF sections,
+    // so same object is checked with such mapping and with mapping created ad hoc that is matched by strings.
+    // Mapping of section is complete before first evaluation, as it is when read from OBF
+    const std::shared_ptr<ObfMapSectionAttributeMapping> sectionAttributeMapping(new ObfMapSectionAttributeMapping());
+    const QStringList otherTags{ "bridge=no", "tunnel=culvert", "access=yes", "surface=asphalt", "layer=-1" };
+    for (const auto& tagValue : otherTags + tags + additionalTags)
+        obtainAttributeId(sectionAttributeMapping, tagValue);
+    sectionAttributeMapping->verifyRequiredMappingRegistered();
+    const auto sectionMapObject = createMapObject(sectionAttributeMapping, tags, additionalTags, isArea);
+    const auto mapObject = createMapObject(attributeMapping, tags, additionalTags, isArea);
+
+    MapStyleEvaluator referenceEvaluator(mapStyle, 1.0f);
+    referenceEvaluator.setProgramEnabled(false);
+    MapStyleEvaluator programEvaluator(mapStyle, 1.0f);
+
+    const MapStyleRulesetType rulesetTypes[] = {
+        MapStyleRulesetType::Point,
+        MapStyleRulesetType::Polyline,
+        MapStyleRulesetType::Polygon,
+        MapStyleRulesetType::Text,
+        MapStyleRulesetType::Order,
+    };
+    for (const auto rulesetType : rulesetTypes)
+    {
+        for (auto zoom = static_cast<int>(MinZoomLevel); zoom <= static_cast<int>(MaxZoomLevel); zoom++)
+        {
+            // Objects alternate, so that evaluator switches between resolved and ad hoc mappings
+            compareEvaluation(referenceEvaluator, programEvaluator, sectionMapObject, rulesetType, zoom);
+            if (QTest::currentTestFailed())
+                return;
+            compareEvaluation(referenceEvaluator, programEvaluator, mapObject, rulesetType, zoom);
+            if (QTest::currentTestFailed())
+                return;
+        }
+    }
+}
+
+void TestMapStyleProgram::attributes()
+{
+    MapStyleEvaluator referenceEvaluator(mapStyle, 1.0f);
+    referenceEvaluator.setProgramEnabled(false);
+    MapStyleEvaluator programEvaluator(mapStyle, 1.0f);
+
+    for (const auto& attribute : mapStyle->getAttributes())
+    {
+        for (auto zoom = static_cast<int>(MinZoomLevel); zoom <= static_cast<int>(MaxZoomLevel); zoom++)
+        {
+            for (const auto nightMode : { false, true })
+            {
+                for (auto evaluator : { &referenceEvaluator, &programEvaluator })
+                {
+                    evaluator->setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+                    evaluator->setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+                    evaluator->setBooleanValue(builtinValueDefs->id_INPUT_NIGHT_MODE, nightMode);
+                }
+
+                MapStyleEvaluationResult referenceResult(mapStyle->getValueDefinitionsCount());
+                const auto referenceSuccess = referenceEvaluator.evaluate(attribute, &referenceResult);
+                MapStyleEvaluationResult programResult(mapStyle->getValueDefinitionsCount());
+                const auto programSuccess = programEvaluator.evaluate(attribute, &programResult);
+
+                const auto context = QString("attribute '%1', zoom %2, night mode %3")
+                    .arg(mapStyle->getStringById(attribute->getNameId()))
+                    .arg(zoom)
+                    .arg(nightMode);
+                QVERIFY2(referenceSuccess == programSuccess, qPrintable(context));
+                QVERIFY2(referenceResult.getValues() == programResult.getValues(), qPrintable(context));
+            }
+        }
+    }
+}
+
+void TestMapStyleProgram::obfTiles()
+{
+    // Map data is not part of repository, so tiles are taken from OBF files in directory given by environment
+    const auto obfsPath = QString::fromLocal8Bit(qgetenv("OSMAND_TEST_OBFS_PATH"));
+    if (obfsPath.isEmpty())
+        QSKIP("OSMAND_TEST_OBFS_PATH is not set");
+
+    const std::shared_ptr<ObfsCollection> obfsCollection(new ObfsCollection());
+    obfsCollection->addDirectory(obfsPath);
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    QVERIFY(!dataInterface->obfReaders.isEmpty());
+
+    const std::shared_ptr<MapPresentationEnvironment> environment(new MapPresentationEnvironment(mapStyle));
+    MapStyleEvaluator referenceEvaluator(mapStyle, 1.0f);
+    referenceEvaluator.setProgramEnabled(false);
+    MapStyleEvaluator programEvaluator(mapStyle, 1.0f);
+
+    const MapStyleRulesetType rulesetTypes[] = {
+        MapStyleRulesetType::Point,
+        MapStyleRulesetType::Polyline,
+        MapStyleRulesetType::Polygon,
+        MapStyleRulesetType::Text,
+        MapStyleRulesetType::Order,
+    };
+
+    // Tile at center of each map section level, at few zooms within that level
+    auto evaluatedObjectsCount = 0;
+    for (const auto& obfReader : constOf(dataInterface->obfReaders))
+    {
+        const auto obfInfo = obfReader->obtainInfo();
+        if (!obfInfo)
+            continue;
+
+        for (const auto& mapSection : constOf(obfInfo->mapSections))
+        {
+            for (const auto& level : constOf(mapSection->levels))
+            {
+                const auto center31 = level->area31.center();
+                for (const auto zoom : { level->minZoom, level->maxZoom })
+                {
+                    const auto tileId = TileId::fromXY(
+                        center31.x >> (MaxZoomLevel - zoom),
+                        center31.y >> (MaxZoomLevel - zoom));
+                    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+
+                    QList< std::shared_ptr<const BinaryMapObject> > mapObjects;
+                    dataInterface->loadBinaryMapObjects(&mapObjects, nullptr, environment, zoom, &tileBBox31);
+                    for (const auto& mapObject : constOf(mapObjects))
+                    {
+                        for (auto attributeIdIndex = 0; attributeIdIndex < mapObject->attributeIds.size(); attributeIdIndex++)
+                        {
+                            for (const auto rulesetType : rulesetTypes)
+                            {
+                                compareEvaluation(
+                                    referenceEvaluator,
+                                    programEvaluator,
+                                    mapObject,
+                                    rulesetType,
+                                    zoom,
+                                    attributeIdIndex);
+                                if (QTest::currentTestFailed())
+                                    return;
+                            }
+                        }
+                        evaluatedObjectsCount++;
+                    }
+                }
+            }
+        }
+    }
+    QVERIFY(evaluatedObjectsCount > 0);
+}
+
+QTEST_MAIN(TestMapStyleProgram)
+#include "TestMapStyleProgram.moc"
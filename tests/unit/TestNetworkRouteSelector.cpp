@@ -0,0 +1,86 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/ObfDataInterface.h>
+#include <OsmAndCore/NetworkRouteSelector.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfInfo.h>
+#include <OsmAndCore/Data/ObfRoutingSectionInfo.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Map data is not part of repository, so routes are taken from OBF files in directory given by environment
+class TestNetworkRouteSelector : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::shared_ptr<ObfsCollection> obfsCollection;
+    QList<AreaI> areas31;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void getRoutes_data();
+    void getRoutes();
+};
+
+void TestNetworkRouteSelector::initTestCase()
+{
+    const auto obfsPath = QString::fromLocal8Bit(qgetenv("OSMAND_TEST_OBFS_PATH"));
+    if (obfsPath.isEmpty())
+        QSKIP("OSMAND_TEST_OBFS_PATH is not set");
+
+    obfsCollection.reset(new ObfsCollection());
+    obfsCollection->addDirectory(obfsPath);
+
+    // Area around center of each routing section
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    for (const auto& obfReader : constOf(dataInterface->obfReaders))
+    {
+        const auto obfInfo = obfReader->obtainInfo();
+        if (!obfInfo)
+            continue;
+
+        for (const auto& routingSection : constOf(obfInfo->routingSections))
+            areas31.push_back((AreaI)Utilities::boundingBox31FromAreaInMeters(5000.0, routingSection->area31.center()));
+    }
+    QVERIFY(!areas31.isEmpty());
+}
+
+void TestNetworkRouteSelector::cleanupTestCase()
+{
+    areas31.clear();
+    obfsCollection.reset();
+}
+
+void TestNetworkRouteSelector::getRoutes_data()
+{
+    QTest::addColumn<bool>("loadRoutes");
+
+    QTest::newRow("keys only") << false;
+    QTest::newRow("whole routes") << true;
+}
+
+void TestNetworkRouteSelector::getRoutes()
+{
+    QFETCH(bool, loadRoutes);
+
+    // Each iteration starts with no tiles loaded, as selecting routes on map does
+    QBENCHMARK
+    {
+        for (const auto& area31 : constOf(areas31))
+        {
+            NetworkRouteSelector selector(obfsCollection);
+            selector.getRoutes(area31, loadRoutes);
+        }
+    }
+}
+
+QTEST_MAIN(TestNetworkRouteSelector)
+#include "TestNetworkRouteSelector.moc"
@@ -0,0 +1,168 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Data/TransportRoute.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+#include "ObfTransportSectionIndex.h"
+
+using namespace OsmAnd;
+
+Q_DECLARE_METATYPE(AreaI)
+
+class TestObfTransportSectionIndex : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<PointI> generatePositions(const PointI& origin, const int span, const int count);
+private slots:
+    void stopsGrid_data();
+    void stopsGrid();
+    void routesCacheEvictsLeastRecentlyUsed();
+    void routesCacheKeepsFirstRoute();
+    void routesCacheBoundsUsageHistory();
+};
+
+QVector<PointI> TestObfTransportSectionIndex::generatePositions(const PointI& origin, const int span, const int count)
+{
+    // Some stops share position or lie on borders of grid cells
+    QVector<PointI> positions;
+    positions.reserve(count);
+    uint32_t seed = 0x9e3779b9u;
+    for (auto stopIdx = 0; stopIdx < count; stopIdx++)
+    {
+        if (stopIdx % 7 == 3)
+        {
+            positions.push_back(positions[stopIdx / 2]);
+            continue;
+        }
+        if (stopIdx % 7 == 5)
+        {
+            const auto cellSize = 1 << TransportStopsGrid::CellShift;
+            positions.push_back(PointI((origin.x / cellSize + stopIdx % 3) * cellSize, origin.y + stopIdx));
+            continue;
+        }
+
+        seed = seed * 1664525u + 1013904223u;
+        const auto x = origin.x + static_cast<int32_t>((seed >> 8) % static_cast<uint32_t>(span));
+        seed = seed * 1664525u + 1013904223u;
+        const auto y = origin.y + static_cast<int32_t>((seed >> 8) % static_cast<uint32_t>(span));
+        positions.push_back(PointI(x, y));
+    }
+    return positions;
+}
+
+void TestObfTransportSectionIndex::stopsGrid_data()
+{
+    // Stops are in TRANSPORT_STOP_ZOOM (24) tile coordinates, grid cell is 1024 of them
+    QTest::addColumn<int>("stopsCount");
+    QTest::addColumn<int>("span");
+    QTest::addColumn<bool>("hasBBox");
+    QTest::addColumn<AreaI>("bbox");
+
+    const PointI origin(8800000, 5400000);
+    QTest::newRow("no stops") << 0 << 1 << true << AreaI(origin, origin + PointI(5000, 5000));
+    QTest::newRow("no bbox") << 300 << 20000 << false << AreaI();
+    QTest::newRow("single stop") << 1 << 1 << true << AreaI(origin, origin);
+    QTest::newRow("few cells") << 500 << 20000 << true << AreaI(origin + PointI(3000, 2000), origin + PointI(6000, 4100));
+    QTest::newRow("cell borders") << 500 << 20000 << true << AreaI(origin + PointI(-1, -1), origin + PointI(1023, 1023));
+    QTest::newRow("area of one cell") << 1000 << 8192 << true << AreaI(origin + PointI(2048, 2048), origin + PointI(3071, 3071));
+    QTest::newRow("larger than stops") << 500 << 20000 << true << AreaI(PointI(0, 0), PointI(1 << 24, 1 << 24));
+    QTest::newRow("negative coordinates") << 200 << 4000 << true << AreaI(PointI(-100000, -100000), origin + PointI(2000, 2000));
+    QTest::newRow("outside of stops") << 200 << 4000 << true << AreaI(PointI(100, 100), PointI(5000, 5000));
+}
+
+void TestObfTransportSectionIndex::stopsGrid()
+{
+    QFETCH(int, stopsCount);
+    QFETCH(int, span);
+    QFETCH(bool, hasBBox);
+    QFETCH(AreaI, bbox);
+
+    const auto positions = generatePositions(PointI(8800000, 5400000), span, stopsCount);
+    TransportStopsGrid grid;
+    grid.build(positions);
+
+    QVector<uint32_t> expectedStopsIndices;
+    for (auto stopIdx = 0u; stopIdx < static_cast<uint32_t>(positions.size()); stopIdx++)
+    {
+        const auto& position = positions[stopIdx];
+        if (!hasBBox || (bbox.left() <= position.x && position.x <= bbox.right()
+            && bbox.top() <= position.y && position.y <= bbox.bottom()))
+        {
+            expectedStopsIndices.push_back(stopIdx);
+        }
+    }
+
+    // Found stops are appended after whatever was there
+    QVector<uint32_t> stopsIndices;
+    stopsIndices.push_back(12345);
+    grid.query(hasBBox ? &bbox : nullptr, stopsIndices);
+    QCOMPARE(stopsIndices.takeFirst(), 12345u);
+    QCOMPARE(stopsIndices, expectedStopsIndices);
+}
+
+void TestObfTransportSectionIndex::routesCacheEvictsLeastRecentlyUsed()
+{
+    TransportRoutesCache cache(3);
+    const auto route1 = std::make_shared<TransportRoute>();
+    const auto route2 = std::make_shared<TransportRoute>();
+    const auto route3 = std::make_shared<TransportRoute>();
+    const auto route4 = std::make_shared<TransportRoute>();
+
+    QVERIFY(!cache.get(100));
+    QCOMPARE(cache.put(100, route1), std::shared_ptr<const TransportRoute>(route1));
+    cache.put(200, route2);
+    cache.put(300, route3);
+    QCOMPARE(cache.size(), 3);
+
+    // Route at 200 is least recently used after route at 100 is taken again
+    QCOMPARE(cache.get(100), std::shared_ptr<const TransportRoute>(route1));
+    cache.put(400, route4);
+    QCOMPARE(cache.size(), 3);
+    QVERIFY(cache.contains(100));
+    QVERIFY(!cache.contains(200));
+    QVERIFY(cache.contains(300));
+    QVERIFY(cache.contains(400));
+    QVERIFY(!cache.get(200));
+
+    cache.put(200, route2);
+    QVERIFY(!cache.contains(300));
+    QCOMPARE(cache.get(400), std::shared_ptr<const TransportRoute>(route4));
+}
+
+void TestObfTransportSectionIndex::routesCacheKeepsFirstRoute()
+{
+    // Same route decoded twice concurrently is shared
+    TransportRoutesCache cache(3);
+    const auto route = std::make_shared<TransportRoute>();
+    const auto sameRoute = std::make_shared<TransportRoute>();
+
+    cache.put(100, route);
+    QCOMPARE(cache.put(100, sameRoute), std::shared_ptr<const TransportRoute>(route));
+    QCOMPARE(cache.get(100), std::shared_ptr<const TransportRoute>(route));
+    QCOMPARE(cache.size(), 1);
+}
+
+void TestObfTransportSectionIndex::routesCacheBoundsUsageHistory()
+{
+    const auto maxRoutesCount = 16;
+    TransportRoutesCache cache(maxRoutesCount);
+    for (auto routeIdx = 0u; routeIdx < 4u; routeIdx++)
+        cache.put(routeIdx, std::make_shared<TransportRoute>());
+
+    // Usage entries of routes that are taken over and over are compacted
+    for (auto accessIdx = 0u; accessIdx < 10000u; accessIdx++)
+    {
+        QVERIFY(cache.get(accessIdx % 4u));
+        QVERIFY(cache.lruSize() <= 2 * cache.size() + maxRoutesCount);
+    }
+    QCOMPARE(cache.size(), 4);
+}
+
+QTEST_MAIN(TestObfTransportSectionIndex)
+#include "TestObfTransportSectionIndex.moc"
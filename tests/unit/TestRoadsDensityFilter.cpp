@@ -0,0 +1,170 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include "RoadsDensityFilter.h"
+
+using namespace OsmAnd;
+
+class TestRoadsDensityFilter : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector< QVector<PointI> > generateRoads(
+        const int zoom,
+        const int roadsCount,
+        const int pointsPerRoad,
+        const bool withFarRoad);
+    static QVector< const QVector<PointI>* > pointersOf(const QVector< QVector<PointI> >& roads);
+private slots:
+    void rejectsRoadsOfCrowdedCells();
+    void gridMatchesHash_data();
+    void gridMatchesHash();
+    void densityCounters_data();
+    void densityCounters();
+};
+
+QVector< QVector<PointI> > TestRoadsDensityFilter::generateRoads(
+    const int zoom,
+    const int roadsCount,
+    const int pointsPerRoad,
+    const bool withFarRoad)
+{
+    // Random walks that start inside of a tile and may leave it a bit, as roads of tile do
+    const auto tileSize31 = 1 << (MaxZoomLevel - zoom);
+    const PointI tileOrigin31(4567 * tileSize31, 2345 * tileSize31);
+    const auto stepSize31 = tileSize31 / 16;
+
+    QVector< QVector<PointI> > roads;
+    roads.reserve(roadsCount + 1);
+    uint32_t seed = 0x9e3779b9u;
+    const auto nextRandom =
+        [&seed]
+        (const int limit) -> int
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<int>((seed >> 8) % static_cast<uint32_t>(limit));
+        };
+    for (auto roadIdx = 0; roadIdx < roadsCount; roadIdx++)
+    {
+        QVector<PointI> road;
+        road.reserve(pointsPerRoad);
+        PointI point31(
+            tileOrigin31.x + nextRandom(tileSize31),
+            tileOrigin31.y + nextRandom(tileSize31));
+        for (auto pointIdx = 0; pointIdx < pointsPerRoad; pointIdx++)
+        {
+            road.push_back(point31);
+            point31.x += nextRandom(2 * stepSize31) - stepSize31;
+            point31.y += nextRandom(2 * stepSize31) - stepSize31;
+        }
+        roads.push_back(road);
+    }
+
+    // Road that spans far beyond the tile, so that flat grid can't cover all cells
+    if (withFarRoad)
+    {
+        QVector<PointI> road;
+        road << tileOrigin31 << PointI(0, 0) << PointI(1 << 30, 1 << 30);
+        roads.insert(roadsCount / 2, road);
+    }
+
+    return roads;
+}
+
+QVector< const QVector<PointI>* > TestRoadsDensityFilter::pointersOf(const QVector< QVector<PointI> >& roads)
+{
+    QVector< const QVector<PointI>* > roadsPoints31;
+    roadsPoints31.reserve(roads.size());
+    for (const auto& road : roads)
+        roadsPoints31.push_back(&road);
+    return roadsPoints31;
+}
+
+void TestRoadsDensityFilter::rejectsRoadsOfCrowdedCells()
+{
+    // Three same roads within one cell, and one road that also passes through another cell
+    const auto cellSize31 = 1 << (MaxZoomLevel - 17);
+    const PointI origin31(1000 * cellSize31, 2000 * cellSize31);
+    QVector< QVector<PointI> > roads;
+    roads << (QVector<PointI>() << origin31 << origin31 + PointI(10, 10));
+    roads << (QVector<PointI>() << origin31 << origin31 + PointI(cellSize31, 0));
+    roads << (QVector<PointI>() << origin31 + PointI(5, 5) << origin31 + PointI(20, 20));
+    roads << (QVector<PointI>() << origin31 + PointI(1, 1) << origin31 + PointI(2, 2));
+    roads << QVector<PointI>();
+
+    for (const auto allowDensityGrid : { true, false })
+    {
+        const auto isRejected = RoadsDensityFilter::findRejectedRoads(pointersOf(roads), 17, 2, allowDensityGrid);
+
+        // Roads are taken from the end: last two roads fill the cell, road that reaches next cell is kept
+        // and the first one is rejected. Road without points never gets accepted
+        QCOMPARE(isRejected, QVector<bool>() << true << false << false << false << true);
+    }
+}
+
+void TestRoadsDensityFilter::gridMatchesHash_data()
+{
+    QTest::addColumn<int>("zoom");
+    QTest::addColumn<int>("densityZoomDelta");
+    QTest::addColumn<int>("densityLimit");
+    QTest::addColumn<int>("roadsCount");
+    QTest::addColumn<int>("pointsPerRoad");
+    QTest::addColumn<bool>("withFarRoad");
+
+    QTest::newRow("no roads") << 15 << 2 << 5 << 0 << 0 << false;
+    QTest::newRow("roads without points") << 15 << 2 << 5 << 10 << 0 << false;
+    QTest::newRow("single road") << 15 << 2 << 5 << 1 << 20 << false;
+    QTest::newRow("sparse roads") << 15 << 2 << 5 << 50 << 10 << false;
+    QTest::newRow("crowded tile") << 13 << 3 << 3 << 2000 << 30 << false;
+    QTest::newRow("limit of one road") << 13 << 3 << 1 << 500 << 15 << false;
+    QTest::newRow("fine density zoom") << 17 << 4 << 2 << 1000 << 40 << false;
+    QTest::newRow("road beyond grid") << 13 << 3 << 3 << 500 << 15 << true;
+}
+
+void TestRoadsDensityFilter::gridMatchesHash()
+{
+    QFETCH(int, zoom);
+    QFETCH(int, densityZoomDelta);
+    QFETCH(int, densityLimit);
+    QFETCH(int, roadsCount);
+    QFETCH(int, pointsPerRoad);
+    QFETCH(bool, withFarRoad);
+
+    const auto roads = generateRoads(zoom, roadsCount, pointsPerRoad, withFarRoad);
+    const auto roadsPoints31 = pointersOf(roads);
+
+    const auto isRejectedByGrid = RoadsDensityFilter::findRejectedRoads(
+        roadsPoints31, zoom + densityZoomDelta, densityLimit, true);
+    const auto isRejectedByHash = RoadsDensityFilter::findRejectedRoads(
+        roadsPoints31, zoom + densityZoomDelta, densityLimit, false);
+    QCOMPARE(isRejectedByGrid, isRejectedByHash);
+}
+
+void TestRoadsDensityFilter::densityCounters_data()
+{
+    QTest::addColumn<bool>("allowDensityGrid");
+
+    QTest::newRow("flat grid") << true;
+    QTest::newRow("hash") << false;
+}
+
+void TestRoadsDensityFilter::densityCounters()
+{
+    QFETCH(bool, allowDensityGrid);
+
+    // Roads of a dense city tile
+    const auto roads = generateRoads(14, 3000, 25, false);
+    const auto roadsPoints31 = pointersOf(roads);
+
+    QBENCHMARK
+    {
+        RoadsDensityFilter::findRejectedRoads(roadsPoints31, 14 + 2, 5, allowDensityGrid);
+    }
+}
+
+QTEST_MAIN(TestRoadsDensityFilter)
+#include "TestRoadsDensityFilter.moc"
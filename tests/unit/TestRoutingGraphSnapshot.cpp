@@ -0,0 +1,383 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Data/RoutingGraphSnapshot.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QDataStream>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+using namespace OsmAnd;
+
+typedef std::function<void (RoutingGraphSnapshot& graph)> GraphCorruption;
+Q_DECLARE_METATYPE(GraphCorruption)
+typedef std::function<void (QByteArray& data)> DataDamage;
+Q_DECLARE_METATYPE(DataDamage)
+
+class TestRoutingGraphSnapshot : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum : uint32_t {
+        HighwayResidential = 10,
+        HighwayPrimary = 11,
+        Oneway = 20,
+        Junction = 30,
+    };
+
+    static RoutingGraphSnapshot::RoadInfo createRoad(
+        const quint64 id,
+        const QVector<PointI>& points31,
+        const QVector<uint32_t>& attributeIds,
+        const uint8_t flags = 0);
+    static std::shared_ptr<const RoutingGraphSnapshot> buildGraph();
+    static QByteArray serialize(const RoutingGraphSnapshot& graph);
+    static std::shared_ptr<const RoutingGraphSnapshot> deserialize(const QByteArray& data);
+    static std::shared_ptr<RoutingGraphSnapshot> copyOf(const RoutingGraphSnapshot& graph);
+    static QList<unsigned int> targetsOf(const RoutingGraphSnapshot& graph, const PointI& point31);
+    static void compare(const RoutingGraphSnapshot& graph, const RoutingGraphSnapshot& referenceGraph);
+private slots:
+    void build();
+    void roundTrip();
+    void roundTripThroughFile();
+    void rejectCorrupted_data();
+    void rejectCorrupted();
+    void rejectDamaged_data();
+    void rejectDamaged();
+};
+
+RoutingGraphSnapshot::RoadInfo TestRoutingGraphSnapshot::createRoad(
+    const quint64 id,
+    const QVector<PointI>& points31,
+    const QVector<uint32_t>& attributeIds,
+    const uint8_t flags)
+{
+    RoutingGraphSnapshot::RoadInfo road;
+    road.id = id;
+    road.points31 = points31;
+    road.attributeIds = attributeIds;
+    road.flags = flags;
+    road.maxSpeed = 13.5f;
+    return road;
+}
+
+std::shared_ptr<const RoutingGraphSnapshot> TestRoutingGraphSnapshot::buildGraph()
+{
+    //  A(1000,1000) -- B(2000,1000) -- C(3000,1000)
+    //                                   |  one-way down
+    //                                  D(3000,2000) <- one-way reverse -- E(4000,2000)
+    //  Roundabout E -> F(4000,3000) -> E, and a road of single point which is ignored
+    QList<RoutingGraphSnapshot::RoadInfo> roads;
+    roads.push_back(createRoad(100,
+        { PointI(1000, 1000), PointI(2000, 1000), PointI(3000, 1000) },
+        { HighwayResidential }));
+    roads.push_back(createRoad(200,
+        { PointI(3000, 1000), PointI(3000, 2000) },
+        { HighwayPrimary, Oneway },
+        RoutingGraphSnapshot::OneWayForward));
+    roads.push_back(createRoad(300,
+        { PointI(3000, 2000), PointI(4000, 2000) },
+        { HighwayPrimary, Oneway },
+        RoutingGraphSnapshot::OneWayReverse));
+    roads.push_back(createRoad(400,
+        { PointI(4000, 2000), PointI(4000, 3000), PointI(4000, 2000) },
+        { HighwayResidential, Junction },
+        RoutingGraphSnapshot::Roundabout));
+    roads.push_back(createRoad(500,
+        { PointI(9000, 9000) },
+        { HighwayResidential }));
+
+    return RoutingGraphSnapshot::build(roads);
+}
+
+QByteArray TestRoutingGraphSnapshot::serialize(const RoutingGraphSnapshot& graph)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    const auto ok = graph.saveTo(buffer);
+    buffer.close();
+    return ok ? data : QByteArray();
+}
+
+std::shared_ptr<const RoutingGraphSnapshot> TestRoutingGraphSnapshot::deserialize(const QByteArray& data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    return RoutingGraphSnapshot::loadFrom(buffer);
+}
+
+std::shared_ptr<RoutingGraphSnapshot> TestRoutingGraphSnapshot::copyOf(const RoutingGraphSnapshot& graph)
+{
+    const std::shared_ptr<RoutingGraphSnapshot> copy(new RoutingGraphSnapshot());
+    copy->nodesCoordinates31 = graph.nodesCoordinates31;
+    copy->edgesOffsets = graph.edgesOffsets;
+    copy->edgesTargets = graph.edgesTargets;
+    copy->edgesLengths = graph.edgesLengths;
+    copy->edgesRoads = graph.edgesRoads;
+    copy->roadsIds = graph.roadsIds;
+    copy->roadsFlags = graph.roadsFlags;
+    copy->roadsMaxSpeeds = graph.roadsMaxSpeeds;
+    copy->roadsTypesOffsets = graph.roadsTypesOffsets;
+    copy->roadsTypes = graph.roadsTypes;
+    copy->types = graph.types;
+    return copy;
+}
+
+QList<unsigned int> TestRoutingGraphSnapshot::targetsOf(const RoutingGraphSnapshot& graph, const PointI& point31)
+{
+    QList<unsigned int> targets;
+    const auto nodeIndex = graph.findNode(point31);
+    if (nodeIndex < 0)
+        return targets;
+    for (auto edgeIndex = graph.edgesOffsets[nodeIndex]; edgeIndex < graph.edgesOffsets[nodeIndex + 1]; edgeIndex++)
+        targets.push_back(graph.edgesTargets[edgeIndex]);
+    std::sort(targets.begin(), targets.end());
+    return targets;
+}
+
+void TestRoutingGraphSnapshot::compare(const RoutingGraphSnapshot& graph, const RoutingGraphSnapshot& referenceGraph)
+{
+    QCOMPARE(graph.nodesCoordinates31, referenceGraph.nodesCoordinates31);
+    QCOMPARE(graph.edgesOffsets, referenceGraph.edgesOffsets);
+    QCOMPARE(graph.edgesTargets, referenceGraph.edgesTargets);
+    QCOMPARE(graph.edgesLengths, referenceGraph.edgesLengths);
+    QCOMPARE(graph.edgesRoads, referenceGraph.edgesRoads);
+    QCOMPARE(graph.roadsIds, referenceGraph.roadsIds);
+    QCOMPARE(graph.roadsFlags, referenceGraph.roadsFlags);
+    QCOMPARE(graph.roadsMaxSpeeds, referenceGraph.roadsMaxSpeeds);
+    QCOMPARE(graph.roadsTypesOffsets, referenceGraph.roadsTypesOffsets);
+    QCOMPARE(graph.roadsTypes, referenceGraph.roadsTypes);
+    QCOMPARE(graph.types, referenceGraph.types);
+}
+
+void TestRoutingGraphSnapshot::build()
+{
+    const auto graph = buildGraph();
+    QVERIFY(graph);
+
+    // Nodes are unique points of roads, sorted by x31 then by y31
+    QCOMPARE(graph->getNodesCount(), 6u);
+    for (auto nodeIndex = 1u; nodeIndex < graph->getNodesCount(); nodeIndex++)
+    {
+        const auto prev = graph->getNode(nodeIndex - 1);
+        const auto node = graph->getNode(nodeIndex);
+        QVERIFY(prev.x < node.x || (prev.x == node.x && prev.y < node.y));
+    }
+    QCOMPARE(graph->findNode(PointI(9000, 9000)), -1);
+    QCOMPARE(graph->findNode(PointI(2500, 1000)), -1);
+
+    const auto a = static_cast<unsigned int>(graph->findNode(PointI(1000, 1000)));
+    const auto b = static_cast<unsigned int>(graph->findNode(PointI(2000, 1000)));
+    const auto c = static_cast<unsigned int>(graph->findNode(PointI(3000, 1000)));
+    const auto d = static_cast<unsigned int>(graph->findNode(PointI(3000, 2000)));
+    const auto e = static_cast<unsigned int>(graph->findNode(PointI(4000, 2000)));
+    const auto f = static_cast<unsigned int>(graph->findNode(PointI(4000, 3000)));
+    QVERIFY(graph->getNode(c) == PointI(3000, 1000));
+
+    // Two-way road goes both ways, one-way roads only along (or against) points order,
+    // roundabout without explicit direction is one-way along points order
+    QCOMPARE(targetsOf(*graph, PointI(1000, 1000)), QList<unsigned int>({ b }));
+    QCOMPARE(targetsOf(*graph, PointI(2000, 1000)), (QList<unsigned int>{ a, c }));
+    QCOMPARE(targetsOf(*graph, PointI(3000, 1000)), (QList<unsigned int>{ b, d }));
+    QCOMPARE(targetsOf(*graph, PointI(3000, 2000)), QList<unsigned int>());
+    QCOMPARE(targetsOf(*graph, PointI(4000, 2000)), (QList<unsigned int>{ d, f }));
+    QCOMPARE(targetsOf(*graph, PointI(4000, 3000)), QList<unsigned int>({ e }));
+    QCOMPARE(graph->getEdgesCount(), 8u);
+
+    for (auto nodeIndex = 0u; nodeIndex < graph->getNodesCount(); nodeIndex++)
+    {
+        for (auto edgeIndex = graph->edgesOffsets[nodeIndex]; edgeIndex < graph->edgesOffsets[nodeIndex + 1]; edgeIndex++)
+        {
+            const auto expectedLength = static_cast<float>(Utilities::distance31(
+                graph->getNode(nodeIndex),
+                graph->getNode(graph->edgesTargets[edgeIndex])));
+            QCOMPARE(graph->edgesLengths[edgeIndex], expectedLength);
+        }
+    }
+
+    // Road of single point is skipped, types are interned in order of appearance
+    QCOMPARE(graph->roadsIds, (QVector<quint64>{ 100, 200, 300, 400 }));
+    QCOMPARE(graph->types, (QVector<uint32_t>{ HighwayResidential, HighwayPrimary, Oneway, Junction }));
+    QCOMPARE(graph->roadsFlags[3],
+        static_cast<uint8_t>(RoutingGraphSnapshot::Roundabout | RoutingGraphSnapshot::OneWayForward));
+    QCOMPARE(graph->roadsMaxSpeeds[0], 13.5f);
+    QVERIFY(graph->roadHasType(1, Oneway));
+    QVERIFY(graph->roadHasType(3, Junction));
+    QVERIFY(!graph->roadHasType(0, Oneway));
+    QVERIFY(!graph->roadHasType(2, HighwayResidential));
+}
+
+void TestRoutingGraphSnapshot::roundTrip()
+{
+    const auto graph = buildGraph();
+    QVERIFY(graph);
+
+    const auto data = serialize(*graph);
+    QVERIFY(!data.isEmpty());
+    const auto loadedGraph = deserialize(data);
+    QVERIFY(loadedGraph);
+    compare(*loadedGraph, *graph);
+
+    const auto emptyGraph = RoutingGraphSnapshot::build(QList<RoutingGraphSnapshot::RoadInfo>());
+    const auto loadedEmptyGraph = deserialize(serialize(*emptyGraph));
+    QVERIFY(loadedEmptyGraph);
+    compare(*loadedEmptyGraph, *emptyGraph);
+}
+
+void TestRoutingGraphSnapshot::roundTripThroughFile()
+{
+    const auto graph = buildGraph();
+    QVERIFY(graph);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const auto fileName = tempDir.filePath(QLatin1String("block.graph"));
+    QVERIFY(graph->saveTo(fileName));
+
+    const auto loadedGraph = RoutingGraphSnapshot::loadFrom(fileName);
+    QVERIFY(loadedGraph);
+    compare(*loadedGraph, *graph);
+
+    QVERIFY(!RoutingGraphSnapshot::loadFrom(tempDir.filePath(QLatin1String("missing.graph"))));
+}
+
+void TestRoutingGraphSnapshot::rejectCorrupted_data()
+{
+    QTest::addColumn<GraphCorruption>("corruption");
+
+    QTest::newRow("edge target out of range") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.edgesTargets[0] = graph.getNodesCount();
+        });
+    QTest::newRow("edge road out of range") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.edgesRoads.last() = graph.getRoadsCount();
+        });
+    QTest::newRow("road type out of range") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.roadsTypes[1] = static_cast<uint16_t>(graph.types.size());
+        });
+    QTest::newRow("edges offsets decrease") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.edgesOffsets[1] = graph.getEdgesCount();
+        });
+    QTest::newRow("edges offsets miss node") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.edgesOffsets.removeLast();
+        });
+    QTest::newRow("edges lengths miss edge") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.edgesLengths.removeLast();
+        });
+    QTest::newRow("road flags miss road") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.roadsFlags.removeLast();
+        });
+    QTest::newRow("road types offsets past types") << GraphCorruption(
+        []
+        (RoutingGraphSnapshot& graph)
+        {
+            graph.roadsTypesOffsets.last()++;
+        });
+}
+
+void TestRoutingGraphSnapshot::rejectCorrupted()
+{
+    QFETCH(GraphCorruption, corruption);
+
+    const auto graph = buildGraph();
+    QVERIFY(graph);
+    const auto corruptedGraph = copyOf(*graph);
+    corruption(*corruptedGraph);
+
+    const auto data = serialize(*corruptedGraph);
+    QVERIFY(!data.isEmpty());
+    QVERIFY(!deserialize(data));
+}
+
+void TestRoutingGraphSnapshot::rejectDamaged_data()
+{
+    QTest::addColumn<DataDamage>("damage");
+
+    // Header is magic and version, both little-endian 32-bit
+    QTest::newRow("empty") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data.clear();
+        });
+    QTest::newRow("wrong magic") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data[0] = static_cast<char>(data[0] ^ 0x5A);
+        });
+    QTest::newRow("stale version") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data[4] = static_cast<char>(data[4] - 1);
+        });
+    QTest::newRow("newer version") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data[4] = static_cast<char>(data[4] + 1);
+        });
+    QTest::newRow("header only") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data.truncate(8);
+        });
+    QTest::newRow("truncated in the middle") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data.truncate(data.size() / 2);
+        });
+    QTest::newRow("last byte missing") << DataDamage(
+        []
+        (QByteArray& data)
+        {
+            data.chop(1);
+        });
+}
+
+void TestRoutingGraphSnapshot::rejectDamaged()
+{
+    QFETCH(DataDamage, damage);
+
+    const auto graph = buildGraph();
+    QVERIFY(graph);
+
+    auto data = serialize(*graph);
+    QVERIFY(deserialize(data));
+    damage(data);
+    QVERIFY(!deserialize(data));
+}
+
+QTEST_MAIN(TestRoutingGraphSnapshot)
+#include "TestRoutingGraphSnapshot.moc"
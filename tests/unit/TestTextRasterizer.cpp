@@ -0,0 +1,234 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/TextRasterizer.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <SkBitmap.h>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+class TestTextRasterizer : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QStringList captions();
+    static QStringList tileCaptions();
+    static TextRasterizer::Style captionStyle();
+    static bool equalPixels(const SkBitmap& bitmap, const SkBitmap& referenceBitmap);
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void shapingCacheHit();
+    void shapingBenchmark();
+    void cachedMatchesUncached_data();
+    void cachedMatchesUncached();
+};
+
+QStringList TestTextRasterizer::captions()
+{
+    return QStringList()
+        << QLatin1String("Main Street")
+        << QLatin1String("Avenue des Champs-Élysées")
+        << QString::fromUtf8("Невский проспект")
+        << QString::fromUtf8("שדרות רוטשילד")
+        << QString::fromUtf8("شارع الملك فهد")
+        << QString::fromUtf8("銀座中央通り")
+        << QLatin1String("A1")
+        << QLatin1String("Central Park");
+}
+
+QStringList TestTextRasterizer::tileCaptions()
+{
+    // Labels of single city tile: streets of several kinds, road refs, house numbers and POI names
+    QStringList result;
+    const QStringList streetNames = QStringList()
+        << QLatin1String("Main") << QLatin1String("Oak") << QLatin1String("Church")
+        << QLatin1String("Mill") << QLatin1String("Station") << QLatin1String("Park")
+        << QLatin1String("Victoria") << QLatin1String("King") << QLatin1String("Garden")
+        << QLatin1String("Bridge") << QLatin1String("Market") << QLatin1String("School");
+    const QStringList streetKinds = QStringList()
+        << QLatin1String("Street") << QLatin1String("Avenue") << QLatin1String("Lane")
+        << QLatin1String("Road") << QLatin1String("Close");
+    for (const auto& streetName : streetNames)
+    {
+        for (const auto& streetKind : streetKinds)
+            result << streetName + QLatin1Char(' ') + streetKind;
+    }
+    for (auto ref = 1; ref <= 20; ref++)
+        result << QString(QLatin1String("A%1")).arg(ref) << QString(QLatin1String("B%1")).arg(ref * 7);
+    for (auto houseNumber = 1; houseNumber <= 60; houseNumber++)
+        result << QString::number(houseNumber);
+    result << QString::fromUtf8("Café de la Paix") << QLatin1String("St. Mary's Church")
+        << QLatin1String("Central Station") << QLatin1String("City Hall") << QLatin1String("Public Library")
+        << QString::fromUtf8("Невский проспект") << QString::fromUtf8("улица Ленина")
+        << QString::fromUtf8("שדרות רוטשילד") << QString::fromUtf8("شارع الملك فهد")
+        << QString::fromUtf8("銀座中央通り") << QString::fromUtf8("Ελευθερίου Βενιζέλου");
+    return result;
+}
+
+TextRasterizer::Style TestTextRasterizer::captionStyle()
+{
+    return TextRasterizer::Style()
+        .setSize(14.0f)
+        .setColor(ColorARGB(0xFF, 0x33, 0x33, 0x33))
+        .setHaloRadius(2)
+        .setHaloColor(ColorARGB(0xFF, 0xFF, 0xFF, 0xFF));
+}
+
+bool TestTextRasterizer::equalPixels(const SkBitmap& bitmap, const SkBitmap& referenceBitmap)
+{
+    return bitmap.width() == referenceBitmap.width() &&
+        bitmap.height() == referenceBitmap.height() &&
+        bitmap.computeByteSize() == referenceBitmap.computeByteSize() &&
+        memcmp(bitmap.getPixels(), referenceBitmap.getPixels(), referenceBitmap.computeByteSize()) == 0;
+}
+
+void TestTextRasterizer::initTestCase()
+{
+    OsmAnd::InitializeCore(CoreResourcesEmbeddedBundle::loadFromSharedResourcesBundle());
+    QVERIFY(TextRasterizer::getDefault());
+}
+
+void TestTextRasterizer::cleanupTestCase()
+{
+    OsmAnd::ReleaseCore();
+}
+
+void TestTextRasterizer::shapingCacheHit()
+{
+    const auto textRasterizer = TextRasterizer::getDefault();
+    const auto style = captionStyle();
+
+    for (const auto& caption : captions())
+    {
+        unsigned int initialHits = 0;
+        unsigned int initialMisses = 0;
+        textRasterizer->getShapingCacheStatistics(initialHits, initialMisses);
+
+        // Caption that was never shaped before can't be taken from cache
+        SkBitmap firstBitmap;
+        QVERIFY(textRasterizer->rasterize(firstBitmap, caption, style));
+        unsigned int firstHits = 0;
+        unsigned int firstMisses = 0;
+        textRasterizer->getShapingCacheStatistics(firstHits, firstMisses);
+        QVERIFY(firstMisses > initialMisses);
+
+        // Same caption again is shaped from cache only, part by part, and looks exactly the same
+        SkBitmap secondBitmap;
+        QVERIFY(textRasterizer->rasterize(secondBitmap, caption, style));
+        unsigned int hits = 0;
+        unsigned int misses = 0;
+        textRasterizer->getShapingCacheStatistics(hits, misses);
+        QCOMPARE(misses, firstMisses);
+        QCOMPARE(hits - firstHits, (firstHits - initialHits) + (firstMisses - initialMisses));
+
+        QVERIFY(equalPixels(secondBitmap, firstBitmap));
+    }
+}
+
+void TestTextRasterizer::shapingBenchmark()
+{
+    const auto textRasterizer = TextRasterizer::getDefault();
+    const auto style = captionStyle();
+    const auto captionsList = tileCaptions();
+    QVERIFY(captionsList.size() > 150);
+
+    // First pass shapes every part of every label
+    unsigned int initialHits = 0;
+    unsigned int initialMisses = 0;
+    textRasterizer->getShapingCacheStatistics(initialHits, initialMisses);
+    for (const auto& caption : captionsList)
+    {
+        SkBitmap bitmap;
+        QVERIFY(textRasterizer->rasterize(bitmap, caption, style));
+    }
+    unsigned int warmHits = 0;
+    unsigned int warmMisses = 0;
+    textRasterizer->getShapingCacheStatistics(warmHits, warmMisses);
+    QVERIFY(warmMisses > initialMisses);
+
+    // Map screen shows same labels over and over while panning, that's what is measured
+    auto iterationsCount = 0u;
+    QBENCHMARK
+    {
+        for (const auto& caption : captionsList)
+        {
+            SkBitmap bitmap;
+            textRasterizer->rasterize(bitmap, caption, style);
+        }
+        iterationsCount++;
+    }
+
+    // Whole tile fits into cache, so each iteration takes every part from it
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    textRasterizer->getShapingCacheStatistics(hits, misses);
+    QCOMPARE(misses, warmMisses);
+    QCOMPARE(hits - warmHits, iterationsCount * ((warmHits - initialHits) + (warmMisses - initialMisses)));
+}
+
+void TestTextRasterizer::cachedMatchesUncached_data()
+{
+    QTest::addColumn<float>("size");
+    QTest::addColumn<bool>("bold");
+    QTest::addColumn<int>("haloRadius");
+
+    QTest::newRow("regular") << 14.0f << false << 0;
+    QTest::newRow("regular with halo") << 14.0f << false << 2;
+    QTest::newRow("bold with halo") << 14.0f << true << 3;
+    QTest::newRow("small") << 9.5f << false << 1;
+    QTest::newRow("large bold") << 31.0f << true << 0;
+}
+
+void TestTextRasterizer::cachedMatchesUncached()
+{
+    QFETCH(float, size);
+    QFETCH(bool, bold);
+    QFETCH(int, haloRadius);
+
+    const auto style = captionStyle()
+        .setSize(size)
+        .setBold(bold)
+        .setHaloRadius(haloRadius);
+
+    // Shared rasterizer has font faces and shaped texts of these captions cached after first pass
+    const auto cachedTextRasterizer = TextRasterizer::getDefault();
+    for (const auto& caption : captions())
+    {
+        SkBitmap bitmap;
+        QVERIFY(cachedTextRasterizer->rasterize(bitmap, caption, style));
+    }
+
+    // Fresh rasterizer for each caption has nothing cached, so every font face is set up and every part is shaped
+    for (const auto& caption : captions())
+    {
+        unsigned int initialHits = 0;
+        unsigned int initialMisses = 0;
+        cachedTextRasterizer->getShapingCacheStatistics(initialHits, initialMisses);
+        SkBitmap cachedBitmap;
+        QVERIFY(cachedTextRasterizer->rasterize(cachedBitmap, caption, style));
+        unsigned int hits = 0;
+        unsigned int misses = 0;
+        cachedTextRasterizer->getShapingCacheStatistics(hits, misses);
+        QCOMPARE(misses, initialMisses);
+        QVERIFY(hits > initialHits);
+
+        const std::shared_ptr<const TextRasterizer> uncachedTextRasterizer(
+            new TextRasterizer(cachedTextRasterizer->typefaceFinder));
+        SkBitmap uncachedBitmap;
+        QVERIFY(uncachedTextRasterizer->rasterize(uncachedBitmap, caption, style));
+        uncachedTextRasterizer->getShapingCacheStatistics(hits, misses);
+        QCOMPARE(hits, 0u);
+        QVERIFY(misses > 0u);
+
+        QVERIFY2(equalPixels(cachedBitmap, uncachedBitmap), qPrintable(caption));
+    }
+}
+
+QTEST_MAIN(TestTextRasterizer)
+#include "TestTextRasterizer.moc"
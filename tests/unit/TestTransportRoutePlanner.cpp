@@ -0,0 +1,197 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/ObfDataInterface.h>
+#include <OsmAndCore/TransportRoutePlanner.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfInfo.h>
+#include <OsmAndCore/Data/ObfTransportSectionInfo.h>
+#include <OsmAndCore/Data/ObfTransportSectionReader.h>
+#include <OsmAndCore/Data/TransportStop.h>
+#include <OsmAndCore/Data/TransportRoute.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Map data is not part of repository, so stops and routes are taken from OBF files in directory given by environment
+class TestTransportRoutePlanner : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Journeys between first and last stop of routes, which are far enough to need a ride
+    struct Query
+    {
+        PointI origin31;
+        PointI destination31;
+        uint64_t routeId;
+    };
+
+    QString obfsPath;
+    std::shared_ptr<ObfsCollection> obfsCollection;
+    QList<Query> queries;
+
+    static QStringList describeJourneys(const QList<TransportRoutePlanner::Journey>& journeys);
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void planJourneys();
+    void sameJourneysAfterReload();
+};
+
+QStringList TestTransportRoutePlanner::describeJourneys(const QList<TransportRoutePlanner::Journey>& journeys)
+{
+    QStringList descriptions;
+    for (const auto& journey : constOf(journeys))
+    {
+        auto description = QString("%1s, %2 rides:").arg(journey.arrivalTime).arg(journey.ridesCount);
+        for (const auto& leg : constOf(journey.legs))
+        {
+            description += QString(" [%1 %2-%3 %4-%5s]")
+                .arg(leg.route ? QString::number(leg.route->id.id) : QString("walk"))
+                .arg(leg.fromStop ? QString::number(leg.fromStop->id.id) : QString("origin"))
+                .arg(leg.toStop ? QString::number(leg.toStop->id.id) : QString("destination"))
+                .arg(leg.departureTime)
+                .arg(leg.arrivalTime);
+        }
+        descriptions.push_back(description);
+    }
+    return descriptions;
+}
+
+void TestTransportRoutePlanner::initTestCase()
+{
+    obfsPath = QString::fromLocal8Bit(qgetenv("OSMAND_TEST_OBFS_PATH"));
+    if (obfsPath.isEmpty())
+        QSKIP("OSMAND_TEST_OBFS_PATH is not set");
+
+    obfsCollection.reset(new ObfsCollection());
+    obfsCollection->addDirectory(obfsPath);
+
+    // Few routes of each transport section, routes are found through references of stops as map does
+    const auto minDistance = 3.0 * TransportRoutePlanner::Settings().maxAccessDistance;
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    for (const auto& obfReader : constOf(dataInterface->obfReaders))
+    {
+        const auto obfInfo = obfReader->obtainInfo();
+        if (!obfInfo)
+            continue;
+
+        for (const auto& transportSection : constOf(obfInfo->transportSections))
+        {
+            if (transportSection->stopsLength == 0)
+                continue;
+
+            QList< std::shared_ptr<const TransportStop> > stops;
+            ObfTransportSectionReader::searchTransportStops(obfReader, transportSection.shared_ptr(), &stops);
+
+            auto sectionQueriesCount = 0;
+            for (const auto& stop : constOf(stops))
+            {
+                QList< std::shared_ptr<const TransportRoute> > routes;
+                dataInterface->getTransportRoutes(stop, &routes);
+                for (const auto& route : constOf(routes))
+                {
+                    if (!route || route->forwardStops.size() < 2)
+                        continue;
+
+                    const auto origin31 = Utilities::convertLatLonTo31(route->forwardStops.first()->location);
+                    const auto destination31 = Utilities::convertLatLonTo31(route->forwardStops.last()->location);
+                    if (Utilities::distance31(origin31, destination31) < minDistance)
+                        continue;
+
+                    queries.push_back({ origin31, destination31, route->id.id });
+                    sectionQueriesCount++;
+                    break;
+                }
+                if (sectionQueriesCount >= 3)
+                    break;
+            }
+        }
+    }
+    QVERIFY(!queries.isEmpty());
+}
+
+void TestTransportRoutePlanner::cleanupTestCase()
+{
+    queries.clear();
+    obfsCollection.reset();
+}
+
+void TestTransportRoutePlanner::planJourneys()
+{
+    const TransportRoutePlanner planner(obfsCollection);
+
+    for (const auto& query : constOf(queries))
+    {
+        const auto journeys = planner.planJourneys(query.origin31, query.destination31);
+        const auto context = QString("route %1").arg(query.routeId);
+
+        // Riding the route itself is possible, so there has to be a journey with rides
+        QVERIFY2(!journeys.isEmpty(), qPrintable(context));
+        QVERIFY2(journeys.last().ridesCount > 0, qPrintable(context));
+
+        for (auto journeyIdx = 0; journeyIdx < journeys.size(); journeyIdx++)
+        {
+            const auto& journey = journeys[journeyIdx];
+
+            // Each next journey has more rides and arrives earlier
+            if (journeyIdx > 0)
+            {
+                QVERIFY2(journey.ridesCount > journeys[journeyIdx - 1].ridesCount, qPrintable(context));
+                QVERIFY2(journey.arrivalTime < journeys[journeyIdx - 1].arrivalTime, qPrintable(context));
+            }
+
+            // Legs go one after another from origin to destination
+            QVERIFY2(!journey.legs.isEmpty(), qPrintable(context));
+            QVERIFY2(journey.legs.first().start31 == query.origin31, qPrintable(context));
+            QVERIFY2(journey.legs.last().end31 == query.destination31, qPrintable(context));
+            QVERIFY2(qFuzzyCompare(journey.legs.last().arrivalTime, journey.arrivalTime), qPrintable(context));
+            auto ridesCount = 0u;
+            for (auto legIdx = 0; legIdx < journey.legs.size(); legIdx++)
+            {
+                const auto& leg = journey.legs[legIdx];
+                QVERIFY2(leg.departureTime <= leg.arrivalTime, qPrintable(context));
+                if (legIdx > 0)
+                {
+                    const auto& previousLeg = journey.legs[legIdx - 1];
+                    QVERIFY2(leg.start31 == previousLeg.end31, qPrintable(context));
+                    QVERIFY2(leg.departureTime >= previousLeg.arrivalTime, qPrintable(context));
+                }
+                if (leg.route)
+                {
+                    QVERIFY2(leg.fromStop && leg.toStop, qPrintable(context));
+                    ridesCount++;
+                }
+            }
+            QCOMPARE(ridesCount, journey.ridesCount);
+        }
+    }
+}
+
+void TestTransportRoutePlanner::sameJourneysAfterReload()
+{
+    const TransportRoutePlanner planner(obfsCollection);
+
+    // Same OBFs loaded again give other section objects, but same sections
+    const std::shared_ptr<ObfsCollection> reloadedObfsCollection(new ObfsCollection());
+    reloadedObfsCollection->addDirectory(obfsPath);
+    const TransportRoutePlanner reloadedPlanner(reloadedObfsCollection);
+
+    for (const auto& query : constOf(queries))
+    {
+        const auto journeys = describeJourneys(planner.planJourneys(query.origin31, query.destination31));
+
+        // Network of these sections is cached now
+        QCOMPARE(describeJourneys(planner.planJourneys(query.origin31, query.destination31)), journeys);
+        QCOMPARE(describeJourneys(reloadedPlanner.planJourneys(query.origin31, query.destination31)), journeys);
+    }
+}
+
+QTEST_MAIN(TestTransportRoutePlanner)
+#include "TestTransportRoutePlanner.moc"
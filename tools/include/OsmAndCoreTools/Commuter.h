@@ -0,0 +1,66 @@
+#ifndef _OSMAND_CORE_TOOLS_COMMUTER_H_
+#define _OSMAND_CORE_TOOLS_COMMUTER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/IObfsCollection.h>
+
+#include <OsmAndCoreTools.h>
+
+namespace OsmAndTools
+{
+    // Plans public transport journeys and measures how long planning takes
+    class OSMAND_CORE_TOOLS_API Commuter Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(Commuter);
+
+    public:
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            std::shared_ptr<OsmAnd::IObfsCollection> obfsCollection;
+            OsmAnd::PointI origin31;
+            OsmAnd::PointI destination31;
+            unsigned int maxTransfers;
+            unsigned int iterations;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+#if defined(_UNICODE) || defined(UNICODE)
+        bool plan(std::wostream& output);
+#else
+        bool plan(std::ostream& output);
+#endif
+    protected:
+    public:
+        Commuter(const Configuration& configuration);
+        ~Commuter();
+
+        const Configuration configuration;
+
+        bool plan(QString *pLog = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_COMMUTER_H_)
@@ -0,0 +1,86 @@
+#ifndef _OSMAND_CORE_TOOLS_ENGRAVER_H_
+#define _OSMAND_CORE_TOOLS_ENGRAVER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDir>
+#include <QFile>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/IObfsCollection.h>
+#include <OsmAndCore/Map/IMapStylesCollection.h>
+
+#include <OsmAndCoreTools.h>
+
+namespace OsmAndTools
+{
+    // Renders tiles of area and zoom range with software rasterizer, without any GPU context, and reports
+    // how long each stage took
+    class OSMAND_CORE_TOOLS_API Engraver Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(Engraver);
+
+    public:
+        enum class ImageFormat
+        {
+            PNG,
+            WebP
+        };
+
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            std::shared_ptr<OsmAnd::IObfsCollection> obfsCollection;
+            std::shared_ptr<OsmAnd::IMapStylesCollection> stylesCollection;
+            QString styleName;
+            QHash< QString, QString > styleSettings;
+            OsmAnd::AreaI bbox31;
+            OsmAnd::ZoomLevel minZoom;
+            OsmAnd::ZoomLevel maxZoom;
+            unsigned int tileSize;
+            unsigned int metatileSize;
+            float displayDensityFactor;
+            float mapScale;
+            float symbolsScale;
+            QString locale;
+            unsigned int threadsCount;
+            QString outputPath;
+            ImageFormat outputImageFormat;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+#if defined(_UNICODE) || defined(UNICODE)
+        bool render(std::wostream& output);
+#else
+        bool render(std::ostream& output);
+#endif
+    protected:
+    public:
+        Engraver(const Configuration& configuration);
+        ~Engraver();
+
+        const Configuration configuration;
+
+        bool render(QString *pLog = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_ENGRAVER_H_)
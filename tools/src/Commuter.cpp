@@ -0,0 +1,269 @@
+#include "Commuter.h"
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iomanip>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/Stopwatch.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/TransportRoutePlanner.h>
+#include <OsmAndCore/Data/TransportStop.h>
+#include <OsmAndCore/Data/TransportRoute.h>
+
+#include "Utilities.h"
+
+OsmAndTools::Commuter::Commuter(const Configuration& configuration_)
+    : configuration(configuration_)
+{
+}
+
+OsmAndTools::Commuter::~Commuter()
+{
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::Commuter::plan(std::wostream& output)
+#else
+bool OsmAndTools::Commuter::plan(std::ostream& output)
+#endif
+{
+    OsmAnd::TransportRoutePlanner::Settings settings;
+    settings.maxTransfers = configuration.maxTransfers;
+    const OsmAnd::TransportRoutePlanner planner(configuration.obfsCollection, settings);
+
+    // First query includes building of transport network, so it's reported separately
+    OsmAnd::Stopwatch firstQueryStopwatch(true);
+    const auto journeys = planner.planJourneys(configuration.origin31, configuration.destination31);
+    const auto firstQueryTime = firstQueryStopwatch.elapsed();
+
+    auto minQueryTime = std::numeric_limits<float>::max();
+    auto maxQueryTime = 0.0f;
+    auto totalQueryTime = 0.0f;
+    for (auto iteration = 0u; iteration < configuration.iterations; iteration++)
+    {
+        OsmAnd::Stopwatch queryStopwatch(true);
+        planner.planJourneys(configuration.origin31, configuration.destination31);
+        const auto queryTime = queryStopwatch.elapsed();
+
+        minQueryTime = qMin(minQueryTime, queryTime);
+        maxQueryTime = qMax(maxQueryTime, queryTime);
+        totalQueryTime += queryTime;
+    }
+
+    output << xT("Found ") << journeys.size() << xT(" journey(s)") << std::endl;
+    for (const auto& journey : constOf(journeys))
+    {
+        output << xT("Arrival in ") << std::fixed << std::setprecision(0) << journey.arrivalTime
+            << xT("s using ") << journey.ridesCount << xT(" ride(s)") << std::endl;
+        if (!configuration.verbose)
+            continue;
+
+        for (const auto& leg : constOf(journey.legs))
+        {
+            const auto fromName = leg.fromStop ? leg.fromStop->getName(QString(), false) : QLatin1String("origin");
+            const auto toName = leg.toStop ? leg.toStop->getName(QString(), false) : QLatin1String("destination");
+            output << xT("\t[") << leg.departureTime << xT("s - ") << leg.arrivalTime << xT("s] ");
+            if (leg.route)
+            {
+                output << QStringToStlString(leg.route->type) << xT(" ") << QStringToStlString(leg.route->ref)
+                    << xT(" from '") << QStringToStlString(fromName) << xT("' to '") << QStringToStlString(toName) << xT("'");
+            }
+            else
+            {
+                output << xT("walk from '") << QStringToStlString(fromName) << xT("' to '") << QStringToStlString(toName) << xT("'");
+            }
+            output << std::endl;
+        }
+    }
+
+    output << std::setprecision(3);
+    output << xT("First query (with network build) took ") << firstQueryTime << xT("s") << std::endl;
+    if (configuration.iterations > 0)
+    {
+        output << xT("Queries over ") << configuration.iterations << xT(" iteration(s): min ")
+            << minQueryTime * 1000.0f << xT("ms, avg ")
+            << totalQueryTime * 1000.0f / configuration.iterations << xT("ms, max ")
+            << maxQueryTime * 1000.0f << xT("ms") << std::endl;
+    }
+
+    return !journeys.isEmpty();
+}
+
+bool OsmAndTools::Commuter::plan(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = plan(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = plan(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return plan(std::wcout);
+#else
+        return plan(std::cout);
+#endif
+    }
+}
+
+OsmAndTools::Commuter::Configuration::Configuration()
+    : maxTransfers(4)
+    , iterations(100)
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::Commuter::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const std::shared_ptr<OsmAnd::ObfsCollection> obfsCollection(new OsmAnd::ObfsCollection());
+    outConfiguration.obfsCollection = obfsCollection;
+
+    const auto parseLatLon =
+        [&outError]
+        (const QString& value, OsmAnd::PointI& outPoint31) -> bool
+        {
+            const auto latLonValues = value.split(QLatin1Char(':'));
+            if (latLonValues.size() != 2)
+            {
+                outError = QString("'%1' can not be parsed as latitude and longitude").arg(value);
+                return false;
+            }
+
+            OsmAnd::LatLon latLon;
+            bool ok = false;
+            latLon.latitude = latLonValues[0].toDouble(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as latitude").arg(latLonValues[0]);
+                return false;
+            }
+
+            ok = false;
+            latLon.longitude = latLonValues[1].toDouble(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as longitude").arg(latLonValues[1]);
+                return false;
+            }
+
+            outPoint31 = OsmAnd::Utilities::convertLatLonTo31(latLon);
+            return true;
+        };
+
+    bool wasOriginSpecified = false;
+    bool wasDestinationSpecified = false;
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-obfsPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, false);
+        }
+        else if (arg.startsWith(QLatin1String("-obfsRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, true);
+        }
+        else if (arg.startsWith(QLatin1String("-obfFile=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfFile=")));
+            if (!QFile(value).exists())
+            {
+                outError = QString("'%1' file does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addFile(value);
+        }
+        else if (arg.startsWith(QLatin1String("-origin=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-origin=")));
+            if (!parseLatLon(value, outConfiguration.origin31))
+                return false;
+            wasOriginSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-destination=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-destination=")));
+            if (!parseLatLon(value, outConfiguration.destination31))
+                return false;
+            wasDestinationSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-maxTransfers=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-maxTransfers=")));
+
+            bool ok = false;
+            outConfiguration.maxTransfers = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as maximal number of transfers").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-iterations=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-iterations=")));
+
+            bool ok = false;
+            outConfiguration.iterations = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as number of iterations").arg(value);
+                return false;
+            }
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (!wasOriginSpecified)
+    {
+        outError = QLatin1String("'origin' should be specified");
+        return false;
+    }
+    if (!wasDestinationSpecified)
+    {
+        outError = QLatin1String("'destination' should be specified");
+        return false;
+    }
+
+    return true;
+}
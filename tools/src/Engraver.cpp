@@ -0,0 +1,614 @@
+#include "Engraver.h"
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iomanip>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QMutex>
+#include <QThreadPool>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/Stopwatch.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/QRunnableFunctor.h>
+#include <OsmAndCore/SimpleQueryController.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/MapPrimitiviser_Metrics.h>
+#include <OsmAndCore/Map/MapRasterizer_Metrics.h>
+#include <OsmAndCore/Map/ObfMapObjectsProvider.h>
+#include <OsmAndCore/Map/ObfMapObjectsProvider_Metrics.h>
+#include <OsmAndCore/Map/MapPrimitivesProvider.h>
+#include <OsmAndCore/Map/MapRasterLayerProvider_Software.h>
+#include <OsmAndCore/Map/MapRasterLayerProvider_Metrics.h>
+
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <SkImage.h>
+#include <SkData.h>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCoreTools.h>
+#include <OsmAndCoreTools/Utilities.h>
+
+OsmAndTools::Engraver::Engraver(const Configuration& configuration_)
+    : configuration(configuration_)
+{
+}
+
+OsmAndTools::Engraver::~Engraver()
+{
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::Engraver::render(std::wostream& output)
+#else
+bool OsmAndTools::Engraver::render(std::ostream& output)
+#endif
+{
+    // Find style
+    if (configuration.verbose)
+        output << xT("Resolving style '") << QStringToStlString(configuration.styleName) << xT("'...") << std::endl;
+    const auto mapStyle = configuration.stylesCollection->getResolvedStyleByName(configuration.styleName);
+    if (!mapStyle)
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(configuration.styleName) << xT("'") << std::endl;
+        return false;
+    }
+
+    // Prepare all resources for rasterization
+    const std::shared_ptr<OsmAnd::MapPresentationEnvironment> mapPresentationEnvironment(new OsmAnd::MapPresentationEnvironment(
+        mapStyle,
+        configuration.displayDensityFactor,
+        configuration.mapScale,
+        configuration.symbolsScale));
+    mapPresentationEnvironment->setLocaleLanguageId(configuration.locale);
+    mapPresentationEnvironment->setSettings(configuration.styleSettings);
+
+    const std::shared_ptr<OsmAnd::MapPrimitiviser> primitiviser(new OsmAnd::MapPrimitiviser(
+        mapPresentationEnvironment));
+    const std::shared_ptr<OsmAnd::ObfMapObjectsProvider> mapObjectsProvider(new OsmAnd::ObfMapObjectsProvider(
+        configuration.obfsCollection));
+    const std::shared_ptr<OsmAnd::MapPrimitivesProvider> mapPrimitivesProvider(new OsmAnd::MapPrimitivesProvider(
+        mapObjectsProvider,
+        primitiviser,
+        configuration.tileSize));
+    const std::shared_ptr<OsmAnd::MapRasterLayerProvider_Software> rasterLayerProvider(new OsmAnd::MapRasterLayerProvider_Software(
+        mapPrimitivesProvider,
+        true,
+        false,
+        false,
+        configuration.metatileSize));
+
+    const auto fileExtension = configuration.outputImageFormat == ImageFormat::WebP
+        ? QLatin1String("webp")
+        : QLatin1String("png");
+    const auto encodedImageFormat = configuration.outputImageFormat == ImageFormat::WebP
+        ? SkEncodedImageFormat::kWEBP
+        : SkEncodedImageFormat::kPNG;
+
+    // Time of each stage is summed over all tiles, so it's thread time rather than wall time
+    struct Statistics
+    {
+        Statistics()
+            : renderedTiles(0)
+            , emptyTiles(0)
+            , failedTiles(0)
+            , elapsedTimeForMapObjects(0.0f)
+            , elapsedTimeForPrimitivisation(0.0f)
+            , elapsedTimeForCoastlines(0.0f)
+            , elapsedTimeForRasterization(0.0f)
+            , elapsedTimeForEncoding(0.0f)
+            , elapsedTimeForWriting(0.0f)
+        {
+        }
+
+        unsigned int renderedTiles;
+        unsigned int emptyTiles;
+        unsigned int failedTiles;
+        float elapsedTimeForMapObjects;
+        float elapsedTimeForPrimitivisation;
+        float elapsedTimeForCoastlines;
+        float elapsedTimeForRasterization;
+        float elapsedTimeForEncoding;
+        float elapsedTimeForWriting;
+    };
+    QMutex statisticsMutex;
+    Statistics totalStatistics;
+
+    const std::shared_ptr<OsmAnd::SimpleQueryController> queryController(new OsmAnd::SimpleQueryController());
+    QThreadPool threadPool;
+    if (configuration.threadsCount > 0)
+        threadPool.setMaxThreadCount(configuration.threadsCount);
+
+    output << std::fixed << std::setprecision(3);
+    const OsmAnd::Stopwatch totalStopwatch(true);
+    for (auto zoom = configuration.minZoom; zoom <= configuration.maxZoom; zoom = static_cast<OsmAnd::ZoomLevel>(zoom + 1))
+    {
+        const auto zoomShift = OsmAnd::ZoomLevel31 - zoom;
+        const auto topLeftTileId = OsmAnd::TileId::fromXY(
+            configuration.bbox31.left() >> zoomShift,
+            configuration.bbox31.top() >> zoomShift);
+        const auto bottomRightTileId = OsmAnd::TileId::fromXY(
+            configuration.bbox31.right() >> zoomShift,
+            configuration.bbox31.bottom() >> zoomShift);
+
+        Statistics zoomStatistics;
+        const OsmAnd::Stopwatch zoomStopwatch(true);
+        for (auto y = topLeftTileId.y; y <= bottomRightTileId.y; y++)
+        {
+            for (auto x = topLeftTileId.x; x <= bottomRightTileId.x; x++)
+            {
+                const auto tileId = OsmAnd::TileId::fromXY(x, y);
+                threadPool.start(new OsmAnd::QRunnableFunctor(
+                    [this, tileId, zoom, rasterLayerProvider, queryController, fileExtension, encodedImageFormat,
+                        &statisticsMutex, &zoomStatistics]
+                    (const OsmAnd::QRunnableFunctor* const runnable)
+                    {
+                        Statistics tileStatistics;
+
+                        OsmAnd::MapRasterLayerProvider::Request request;
+                        request.tileId = tileId;
+                        request.zoom = zoom;
+                        request.queryController = queryController;
+
+                        OsmAnd::MapRasterLayerProvider_Metrics::Metric_obtainData metric;
+                        std::shared_ptr<OsmAnd::MapRasterLayerProvider::Data> tile;
+                        const auto success = rasterLayerProvider->obtainRasterizedTile(request, tile, &metric);
+
+                        if (const auto mapObjectsMetric =
+                            metric.findSubmetricOfType<OsmAnd::ObfMapObjectsProvider_Metrics::Metric_obtainData>(true))
+                        {
+                            tileStatistics.elapsedTimeForMapObjects += mapObjectsMetric->elapsedTime;
+                        }
+                        if (const auto primitiviseMetric =
+                            metric.findSubmetricOfType<OsmAnd::MapPrimitiviser_Metrics::Metric_primitivise>(true))
+                        {
+                            tileStatistics.elapsedTimeForPrimitivisation += primitiviseMetric->elapsedTime;
+                        }
+                        if (const auto primitiviseWithSurfaceMetric =
+                            metric.findSubmetricOfType<OsmAnd::MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>(true))
+                        {
+                            tileStatistics.elapsedTimeForCoastlines +=
+                                primitiviseWithSurfaceMetric->elapsedTimeForPolygonizingCoastlines;
+                        }
+                        if (const auto rasterizeMetric =
+                            metric.findSubmetricOfType<OsmAnd::MapRasterizer_Metrics::Metric_rasterize>(true))
+                        {
+                            tileStatistics.elapsedTimeForRasterization += rasterizeMetric->elapsedTime;
+                        }
+
+                        if (!success)
+                            tileStatistics.failedTiles++;
+                        else if (!tile || !tile->image)
+                            tileStatistics.emptyTiles++;
+                        else
+                        {
+                            const OsmAnd::Stopwatch encodingStopwatch(true);
+                            const auto imageData = tile->image->encodeToData(encodedImageFormat, 100);
+                            tileStatistics.elapsedTimeForEncoding += encodingStopwatch.elapsed();
+
+                            const OsmAnd::Stopwatch writingStopwatch(true);
+                            const auto tilePath = QString(QLatin1String("%1/%2/%3"))
+                                .arg(configuration.outputPath)
+                                .arg(zoom)
+                                .arg(tileId.x);
+                            QFile imageFile(QString(QLatin1String("%1/%2.%3")).arg(tilePath).arg(tileId.y).arg(fileExtension));
+                            if (imageData && QDir().mkpath(tilePath) && imageFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                            {
+                                const auto written = imageFile.write(reinterpret_cast<const char*>(imageData->bytes()),
+                                    imageData->size());
+                                imageFile.close();
+
+                                if (written == static_cast<qint64>(imageData->size()))
+                                    tileStatistics.renderedTiles++;
+                                else
+                                    tileStatistics.failedTiles++;
+                            }
+                            else
+                                tileStatistics.failedTiles++;
+                            tileStatistics.elapsedTimeForWriting += writingStopwatch.elapsed();
+                        }
+
+                        QMutexLocker scopedLocker(&statisticsMutex);
+                        zoomStatistics.renderedTiles += tileStatistics.renderedTiles;
+                        zoomStatistics.emptyTiles += tileStatistics.emptyTiles;
+                        zoomStatistics.failedTiles += tileStatistics.failedTiles;
+                        zoomStatistics.elapsedTimeForMapObjects += tileStatistics.elapsedTimeForMapObjects;
+                        zoomStatistics.elapsedTimeForPrimitivisation += tileStatistics.elapsedTimeForPrimitivisation;
+                        zoomStatistics.elapsedTimeForCoastlines += tileStatistics.elapsedTimeForCoastlines;
+                        zoomStatistics.elapsedTimeForRasterization += tileStatistics.elapsedTimeForRasterization;
+                        zoomStatistics.elapsedTimeForEncoding += tileStatistics.elapsedTimeForEncoding;
+                        zoomStatistics.elapsedTimeForWriting += tileStatistics.elapsedTimeForWriting;
+                    }));
+            }
+        }
+        threadPool.waitForDone();
+        const auto zoomTime = zoomStopwatch.elapsed();
+
+        const auto zoomTiles = zoomStatistics.renderedTiles + zoomStatistics.emptyTiles + zoomStatistics.failedTiles;
+        output << xT("Zoom ") << zoom << xT(": ")
+            << zoomStatistics.renderedTiles << xT(" rendered, ")
+            << zoomStatistics.emptyTiles << xT(" empty, ")
+            << zoomStatistics.failedTiles << xT(" failed tile(s) in ")
+            << zoomTime << xT("s (")
+            << (zoomTime > 0.0f ? zoomTiles / zoomTime : 0.0f) << xT(" tiles/s)") << std::endl;
+        if (configuration.verbose)
+        {
+            output << xT("\tmap objects ") << zoomStatistics.elapsedTimeForMapObjects
+                << xT("s, primitivisation ") << zoomStatistics.elapsedTimeForPrimitivisation
+                << xT("s (coastlines ") << zoomStatistics.elapsedTimeForCoastlines
+                << xT("s), rasterization ") << zoomStatistics.elapsedTimeForRasterization
+                << xT("s, encoding ") << zoomStatistics.elapsedTimeForEncoding
+                << xT("s, writing ") << zoomStatistics.elapsedTimeForWriting << xT("s") << std::endl;
+        }
+
+        totalStatistics.renderedTiles += zoomStatistics.renderedTiles;
+        totalStatistics.emptyTiles += zoomStatistics.emptyTiles;
+        totalStatistics.failedTiles += zoomStatistics.failedTiles;
+        totalStatistics.elapsedTimeForMapObjects += zoomStatistics.elapsedTimeForMapObjects;
+        totalStatistics.elapsedTimeForPrimitivisation += zoomStatistics.elapsedTimeForPrimitivisation;
+        totalStatistics.elapsedTimeForCoastlines += zoomStatistics.elapsedTimeForCoastlines;
+        totalStatistics.elapsedTimeForRasterization += zoomStatistics.elapsedTimeForRasterization;
+        totalStatistics.elapsedTimeForEncoding += zoomStatistics.elapsedTimeForEncoding;
+        totalStatistics.elapsedTimeForWriting += zoomStatistics.elapsedTimeForWriting;
+    }
+    const auto totalTime = totalStopwatch.elapsed();
+
+    const auto totalTiles = totalStatistics.renderedTiles + totalStatistics.emptyTiles + totalStatistics.failedTiles;
+    output << xT("Total: ")
+        << totalStatistics.renderedTiles << xT(" rendered, ")
+        << totalStatistics.emptyTiles << xT(" empty, ")
+        << totalStatistics.failedTiles << xT(" failed tile(s) in ")
+        << totalTime << xT("s (")
+        << (totalTime > 0.0f ? totalTiles / totalTime : 0.0f) << xT(" tiles/s)") << std::endl;
+    output << xT("Thread time: map objects ") << totalStatistics.elapsedTimeForMapObjects
+        << xT("s, primitivisation ") << totalStatistics.elapsedTimeForPrimitivisation
+        << xT("s (coastlines ") << totalStatistics.elapsedTimeForCoastlines
+        << xT("s), rasterization ") << totalStatistics.elapsedTimeForRasterization
+        << xT("s, encoding ") << totalStatistics.elapsedTimeForEncoding
+        << xT("s, writing ") << totalStatistics.elapsedTimeForWriting << xT("s") << std::endl;
+
+    return totalStatistics.failedTiles == 0;
+}
+
+bool OsmAndTools::Engraver::render(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = render(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = render(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return render(std::wcout);
+#else
+        return render(std::cout);
+#endif
+    }
+}
+
+OsmAndTools::Engraver::Configuration::Configuration()
+    : styleName(QLatin1String("default"))
+    , minZoom(OsmAnd::ZoomLevel12)
+    , maxZoom(OsmAnd::ZoomLevel17)
+    , tileSize(256)
+    , metatileSize(1)
+    , displayDensityFactor(1.0f)
+    , mapScale(1.0f)
+    , symbolsScale(1.0f)
+    , locale(QLatin1String("en"))
+    , threadsCount(0)
+    , outputImageFormat(ImageFormat::PNG)
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::Engraver::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const std::shared_ptr<OsmAnd::ObfsCollection> obfsCollection(new OsmAnd::ObfsCollection());
+    outConfiguration.obfsCollection = obfsCollection;
+
+    const std::shared_ptr<OsmAnd::MapStylesCollection> stylesCollection(new OsmAnd::MapStylesCollection());
+    outConfiguration.stylesCollection = stylesCollection;
+
+    const auto parseLatLon =
+        [&outError]
+        (const QString& value, OsmAnd::PointI& outPoint31) -> bool
+        {
+            const auto latLonValues = value.split(QLatin1Char(':'));
+            if (latLonValues.size() != 2)
+            {
+                outError = QString("'%1' can not be parsed as latitude and longitude").arg(value);
+                return false;
+            }
+
+            OsmAnd::LatLon latLon;
+            bool ok = false;
+            latLon.latitude = latLonValues[0].toDouble(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as latitude").arg(latLonValues[0]);
+                return false;
+            }
+
+            ok = false;
+            latLon.longitude = latLonValues[1].toDouble(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as longitude").arg(latLonValues[1]);
+                return false;
+            }
+
+            outPoint31 = OsmAnd::Utilities::convertLatLonTo31(latLon);
+            return true;
+        };
+
+    const auto parseZoom =
+        [&outError]
+        (const QString& value, OsmAnd::ZoomLevel& outZoom) -> bool
+        {
+            bool ok = false;
+            const auto zoom = value.toUInt(&ok);
+            if (!ok || zoom < OsmAnd::MinZoomLevel || zoom > OsmAnd::MaxZoomLevel)
+            {
+                outError = QString("'%1' can not be parsed as zoom").arg(value);
+                return false;
+            }
+
+            outZoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+            return true;
+        };
+
+    bool wasTopLeftSpecified = false;
+    bool wasBottomRightSpecified = false;
+    OsmAnd::PointI topLeft31;
+    OsmAnd::PointI bottomRight31;
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-obfsPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, false);
+        }
+        else if (arg.startsWith(QLatin1String("-obfsRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, true);
+        }
+        else if (arg.startsWith(QLatin1String("-obfFile=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfFile=")));
+            if (!QFile(value).exists())
+            {
+                outError = QString("'%1' file does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addFile(value);
+        }
+        else if (arg.startsWith(QLatin1String("-stylesPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-stylesPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            QFileInfoList styleFilesList;
+            OsmAnd::Utilities::findFiles(QDir(value), QStringList() << QLatin1String("*.render.xml"), styleFilesList, false);
+            for (const auto& styleFile : styleFilesList)
+                stylesCollection->addStyleFromFile(styleFile.absoluteFilePath());
+        }
+        else if (arg.startsWith(QLatin1String("-styleName=")))
+        {
+            outConfiguration.styleName = Utilities::purifyArgumentValue(arg.mid(strlen("-styleName=")));
+        }
+        else if (arg.startsWith(QLatin1String("-styleSetting:")))
+        {
+            const auto settingValue = arg.mid(strlen("-styleSetting:"));
+            const auto settingKeyValue = settingValue.split(QLatin1Char('='));
+            if (settingKeyValue.size() != 2)
+            {
+                outError = QString("'%1' can not be parsed as style settings key and value").arg(settingValue);
+                return false;
+            }
+
+            outConfiguration.styleSettings[settingKeyValue[0]] = Utilities::purifyArgumentValue(settingKeyValue[1]);
+        }
+        else if (arg.startsWith(QLatin1String("-topLeft=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-topLeft=")));
+            if (!parseLatLon(value, topLeft31))
+                return false;
+            wasTopLeftSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-bottomRight=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-bottomRight=")));
+            if (!parseLatLon(value, bottomRight31))
+                return false;
+            wasBottomRightSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-minZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-minZoom=")));
+            if (!parseZoom(value, outConfiguration.minZoom))
+                return false;
+        }
+        else if (arg.startsWith(QLatin1String("-maxZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-maxZoom=")));
+            if (!parseZoom(value, outConfiguration.maxZoom))
+                return false;
+        }
+        else if (arg.startsWith(QLatin1String("-tileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-tileSize=")));
+
+            bool ok = false;
+            outConfiguration.tileSize = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as tile size in pixels").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-metatileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-metatileSize=")));
+
+            bool ok = false;
+            outConfiguration.metatileSize = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as metatile size in tiles").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-displayDensityFactor=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-displayDensityFactor=")));
+
+            bool ok = false;
+            outConfiguration.displayDensityFactor = value.toFloat(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as display density factor").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-mapScale=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-mapScale=")));
+
+            bool ok = false;
+            outConfiguration.mapScale = value.toFloat(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as map scale factor").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-symbolsScale=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-symbolsScale=")));
+
+            bool ok = false;
+            outConfiguration.symbolsScale = value.toFloat(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as symbols scale factor").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-locale=")))
+        {
+            outConfiguration.locale = Utilities::purifyArgumentValue(arg.mid(strlen("-locale=")));
+        }
+        else if (arg.startsWith(QLatin1String("-threads=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-threads=")));
+
+            bool ok = false;
+            outConfiguration.threadsCount = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as number of threads").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-outputPath=")))
+        {
+            outConfiguration.outputPath = Utilities::resolvePath(arg.mid(strlen("-outputPath=")));
+        }
+        else if (arg.startsWith(QLatin1String("-outputImageFormat=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-outputImageFormat=")));
+            if (value.compare(QLatin1String("png"), Qt::CaseInsensitive) == 0)
+                outConfiguration.outputImageFormat = ImageFormat::PNG;
+            else if (value.compare(QLatin1String("webp"), Qt::CaseInsensitive) == 0)
+                outConfiguration.outputImageFormat = ImageFormat::WebP;
+            else
+            {
+                outError = QString("'%1' can not be parsed as output image format").arg(value);
+                return false;
+            }
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (!wasTopLeftSpecified || !wasBottomRightSpecified)
+    {
+        outError = QLatin1String("'topLeft' and 'bottomRight' should be specified");
+        return false;
+    }
+    outConfiguration.bbox31.top() = qMin(topLeft31.y, bottomRight31.y);
+    outConfiguration.bbox31.left() = qMin(topLeft31.x, bottomRight31.x);
+    outConfiguration.bbox31.bottom() = qMax(topLeft31.y, bottomRight31.y);
+    outConfiguration.bbox31.right() = qMax(topLeft31.x, bottomRight31.x);
+    if (outConfiguration.minZoom > outConfiguration.maxZoom)
+    {
+        outError = QLatin1String("'minZoom' can not be greater than 'maxZoom'");
+        return false;
+    }
+    if (outConfiguration.styleName.isEmpty())
+    {
+        outError = QLatin1String("'styleName' can not be empty");
+        return false;
+    }
+    if (outConfiguration.tileSize == 0)
+    {
+        outError = QLatin1String("'tileSize' can not be 0");
+        return false;
+    }
+    if (outConfiguration.outputPath.isEmpty())
+    {
+        outError = QLatin1String("'outputPath' should be specified");
+        return false;
+    }
+
+    return true;
+}